@@ -0,0 +1,574 @@
+#include "common/game_state.h"
+#include "common/packet.h"
+#include "common/random.h"
+#include "common/serialization.h"
+#include "common/state_sync.h"
+#include "common/string_table.h"
+#include "server/connection_manager.h"
+#include "server/message_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Microbenchmarks for the hot paths, one row per operation.
+//
+// Usage: bench [--filter TEXT] [--min-ms N] [--csv]
+//
+// Each case runs its operation in a loop, doubling the count until a run
+// takes --min-ms (default 100), and keeps the fastest of three such runs.
+// Global operator new is counted, so every row also reports heap
+// allocations and bytes requested per operation; a change that adds one to
+// a steady-state path shows up as a non-zero column. --filter runs only
+// cases whose name contains TEXT; --csv prints machine-readable rows for
+// diffing between builds.
+//
+// Groups: packet framing, every serializer/extractor pair in
+// serialization.cpp (plus the server's encode* writers), MessageQueue
+// handoff on one thread and under four producers, ConnectionManager lookups
+// in a table of 10,000 connections, and GameState vote and full-round
+// cycles for a six-player room.
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> allocatedBytes{0};
+
+} // namespace
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  if (void *pointer = std::malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+
+using namespace net;
+
+namespace {
+
+volatile size_t sink;
+
+struct Case {
+  std::string name;
+  // Runs the operation `iterations` times.
+  std::function<void(size_t)> run;
+};
+
+struct Result {
+  size_t iterations;
+  double nsPerOp;
+  double allocsPerOp;
+  double bytesPerOp;
+};
+
+Result measure(const Case &benchmark, std::chrono::nanoseconds minTime) {
+  // Warm-up fills per-thread pools and caches.
+  benchmark.run(64);
+
+  size_t iterations = 1;
+  Result best{0, 0.0, 0.0, 0.0};
+  int kept = 0;
+  while (kept < 3) {
+    size_t allocsBefore = allocations.load();
+    size_t bytesBefore = allocatedBytes.load();
+    auto start = std::chrono::steady_clock::now();
+    benchmark.run(iterations);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    size_t allocs = allocations.load() - allocsBefore;
+    size_t bytes = allocatedBytes.load() - bytesBefore;
+
+    if (elapsed < minTime) {
+      iterations *= 2;
+      continue;
+    }
+    double ops = static_cast<double>(iterations);
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+    if (kept == 0 || ns < best.nsPerOp)
+      best = {iterations, ns, allocs / ops, bytes / ops};
+    ++kept;
+  }
+  return best;
+}
+
+// Calls fn(i) for i in [0, iterations).
+template <typename Fn> std::function<void(size_t)> loop(Fn fn) {
+  return [fn](size_t iterations) mutable {
+    for (size_t i = 0; i < iterations; ++i)
+      fn(i);
+  };
+}
+
+// Shared inputs: a six-player room with interned names, the messages a
+// round sends, and a client dictionary that knows every id they use.
+struct Fixture {
+  std::string chatText = std::string(96, 'c');
+  std::vector<uint8_t> stateBytes = std::vector<uint8_t>(1024, 's');
+  Packet chatPacket{MessageType::CHAT_MESSAGE, chatText};
+  Packet statePacket{MessageType::GAME_STATE_UPDATE, stateBytes};
+  std::vector<uint8_t> chatFrame = chatPacket.serialize();
+  std::vector<uint8_t> stateFrame = statePacket.serialize();
+
+  std::vector<PlayerState> players;
+  StateUpdate room;
+  ChatMessage chat;
+  RoleAssignment role;
+  VoteCommand vote{1040, 1041};
+  VoteResult result;
+  std::vector<StringDefinition> definitions;
+  StringDictionary strings;
+
+  Fixture() {
+    for (uint32_t i = 0; i < 6; ++i)
+      players.emplace_back(1040 + i, "player_" + std::to_string(i),
+                           PlayerRole::GUESSER, static_cast<int>(i));
+    SnapshotHistory history;
+    history.capture(players);
+    room = history.diff(0);
+
+    chat = ChatMessage(1040, players[0].username, "is it something you eat?");
+    role = RoleAssignment(1041, PlayerRole::GUESSER, InternedString("Animals"),
+                          InternedString("Giraffe"));
+    for (const auto &player : players)
+      result.tally[player.id] = player.id == 1041 ? 5 : 0;
+    result.winnerId = 1041;
+    result.liarCaught = true;
+
+    for (const auto &player : players)
+      definitions.push_back({player.username.id(), player.username.str()});
+    definitions.push_back({role.topic.id(), role.topic.str()});
+    definitions.push_back({role.secretWord.id(), role.secretWord.str()});
+    for (const auto &definition : definitions)
+      strings.define(definition.id, definition.text);
+  }
+};
+
+void addPacketCases(std::vector<Case> &cases, const Fixture &f) {
+  cases.push_back({"packet/serialize chat 96B", loop([&f](size_t) {
+                     sink = sink + f.chatPacket.serialize().size();
+                   })});
+  cases.push_back({"packet/serialize state 1KiB", loop([&f](size_t) {
+                     sink = sink + f.statePacket.serialize().size();
+                   })});
+  cases.push_back({"packet/deserialize chat 96B", loop([&f](size_t) {
+                     sink = sink + Packet::deserialize(f.chatFrame)
+                                       .getTotalSize();
+                   })});
+  cases.push_back({"packet/deserialize state 1KiB", loop([&f](size_t) {
+                     sink = sink + Packet::deserialize(f.stateFrame)
+                                       .getTotalSize();
+                   })});
+  cases.push_back({"packet/isCompletePacket", loop([&f](size_t i) {
+                     // Alternate a whole frame with one short by a byte.
+                     sink = sink + Packet::isCompletePacket(
+                                       f.chatFrame.data(),
+                                       f.chatFrame.size() - (i & 1));
+                   })});
+  cases.push_back({"packet/toWire chat 96B", loop([&f](size_t) {
+                     sink = sink + f.chatPacket.toWire()->size();
+                   })});
+}
+
+// serializeX/deserializeX work on bare payloads, createXPacket/extractX on
+// packets, encodeX builds the server's send buffer in place.
+void addSerializationCases(std::vector<Case> &cases, const Fixture &f) {
+  const PlayerState &player = f.players[0];
+  std::vector<uint8_t> playerBytes = serializePlayerState(player);
+  Packet playerPacket =
+      createPlayerStatePacket(MessageType::PLAYER_JOINED, player);
+  Packet roomPacket = createGameStateUpdatePacket(f.room);
+  Packet ackPacket = createStateAckPacket(42);
+  std::vector<uint8_t> chatBytes = serializeChatMessage(f.chat);
+  Packet chatPacket = createChatMessagePacket(f.chat);
+  std::vector<uint8_t> roleBytes = serializeRoleAssignment(f.role);
+  Packet rolePacket = createRoleAssignmentPacket(f.role);
+  Packet definePacket = createStringDefinePacket(f.definitions);
+  std::vector<uint8_t> voteBytes = serializeVoteCommand(f.vote);
+  Packet votePacket = createVoteCommandPacket(f.vote);
+  std::vector<uint8_t> resultBytes = serializeVoteResult(f.result);
+  Packet resultPacket = createVoteResultPacket(f.result);
+
+  cases.push_back({"serialization/PlayerState serialize",
+                   loop([&f](size_t) {
+                     sink = sink + serializePlayerState(f.players[0]).size();
+                   })});
+  cases.push_back({"serialization/PlayerState deserialize",
+                   loop([playerBytes](size_t) {
+                     sink = sink + deserializePlayerState(playerBytes.data(),
+                                                          playerBytes.size())
+                                       .id;
+                   })});
+  cases.push_back({"serialization/PlayerState create", loop([&f](size_t) {
+                     sink = sink + createPlayerStatePacket(
+                                       MessageType::PLAYER_JOINED,
+                                       f.players[0])
+                                       .getTotalSize();
+                   })});
+  cases.push_back({"serialization/PlayerState extract",
+                   loop([&f, playerPacket](size_t) {
+                     sink = sink +
+                            extractPlayerState(playerPacket, f.strings).id;
+                   })});
+  cases.push_back({"serialization/PlayerState encode", loop([&f](size_t) {
+                     sink = sink + encodePlayerState(MessageType::PLAYER_JOINED,
+                                                     f.players[0])
+                                       ->size();
+                   })});
+
+  cases.push_back({"serialization/StateUpdate x6 create", loop([&f](size_t) {
+                     sink = sink +
+                            createGameStateUpdatePacket(f.room).getTotalSize();
+                   })});
+  cases.push_back({"serialization/StateUpdate x6 extract",
+                   loop([&f, roomPacket](size_t) {
+                     sink = sink + extractGameStateUpdate(roomPacket, f.strings)
+                                       .players.size();
+                   })});
+  cases.push_back({"serialization/StateUpdate x6 encode", loop([&f](size_t) {
+                     sink = sink + encodeGameStateUpdate(f.room)->size();
+                   })});
+
+  cases.push_back({"serialization/StateAck create", loop([](size_t i) {
+                     sink = sink + createStateAckPacket(static_cast<uint32_t>(i))
+                                       .getTotalSize();
+                   })});
+  cases.push_back({"serialization/StateAck extract",
+                   loop([ackPacket](size_t) {
+                     sink = sink + extractStateAck(ackPacket);
+                   })});
+
+  cases.push_back({"serialization/ChatMessage serialize", loop([&f](size_t) {
+                     sink = sink + serializeChatMessage(f.chat).size();
+                   })});
+  cases.push_back({"serialization/ChatMessage deserialize",
+                   loop([chatBytes](size_t) {
+                     sink = sink + deserializeChatMessage(chatBytes.data(),
+                                                          chatBytes.size())
+                                       .senderMessage.size();
+                   })});
+  cases.push_back({"serialization/ChatMessage create", loop([&f](size_t) {
+                     sink = sink +
+                            createChatMessagePacket(f.chat).getTotalSize();
+                   })});
+  cases.push_back({"serialization/ChatMessage extract",
+                   loop([&f, chatPacket](size_t) {
+                     sink = sink + extractChatMessage(chatPacket, f.strings)
+                                       .senderMessage.size();
+                   })});
+  cases.push_back({"serialization/ChatMessage encode", loop([&f](size_t) {
+                     sink = sink + encodeChatMessage(f.chat)->size();
+                   })});
+
+  cases.push_back({"serialization/RoleAssignment serialize",
+                   loop([&f](size_t) {
+                     sink = sink + serializeRoleAssignment(f.role).size();
+                   })});
+  cases.push_back({"serialization/RoleAssignment deserialize",
+                   loop([roleBytes](size_t) {
+                     sink = sink + deserializeRoleAssignment(roleBytes.data(),
+                                                             roleBytes.size())
+                                       .playerId;
+                   })});
+  cases.push_back({"serialization/RoleAssignment create", loop([&f](size_t) {
+                     sink = sink +
+                            createRoleAssignmentPacket(f.role).getTotalSize();
+                   })});
+  cases.push_back({"serialization/RoleAssignment extract",
+                   loop([&f, rolePacket](size_t) {
+                     sink = sink + extractRoleAssignment(rolePacket, f.strings)
+                                       .playerId;
+                   })});
+  cases.push_back({"serialization/RoleAssignment encode", loop([&f](size_t) {
+                     sink = sink + encodeRoleAssignment(f.role)->size();
+                   })});
+
+  cases.push_back({"serialization/StringDefine x8 create", loop([&f](size_t) {
+                     sink = sink + createStringDefinePacket(f.definitions)
+                                       .getTotalSize();
+                   })});
+  cases.push_back({"serialization/StringDefine x8 extract",
+                   loop([definePacket](size_t) {
+                     sink = sink +
+                            extractStringDefinitions(definePacket).size();
+                   })});
+  cases.push_back({"serialization/StringDefine x8 encode", loop([&f](size_t) {
+                     sink = sink + encodeStringDefinitions(f.definitions)->size();
+                   })});
+
+  cases.push_back({"serialization/VoteCommand serialize", loop([&f](size_t) {
+                     sink = sink + serializeVoteCommand(f.vote).size();
+                   })});
+  cases.push_back({"serialization/VoteCommand deserialize",
+                   loop([voteBytes](size_t) {
+                     sink = sink + deserializeVoteCommand(voteBytes.data(),
+                                                          voteBytes.size())
+                                       .targetId;
+                   })});
+  cases.push_back({"serialization/VoteCommand create", loop([&f](size_t) {
+                     sink = sink +
+                            createVoteCommandPacket(f.vote).getTotalSize();
+                   })});
+  cases.push_back({"serialization/VoteCommand extract",
+                   loop([votePacket](size_t) {
+                     sink = sink + extractVoteCommand(votePacket).targetId;
+                   })});
+
+  cases.push_back({"serialization/VoteResult x6 serialize", loop([&f](size_t) {
+                     sink = sink + serializeVoteResult(f.result).size();
+                   })});
+  cases.push_back({"serialization/VoteResult x6 deserialize",
+                   loop([resultBytes](size_t) {
+                     sink = sink + deserializeVoteResult(resultBytes.data(),
+                                                         resultBytes.size())
+                                       .tally.size();
+                   })});
+  cases.push_back({"serialization/VoteResult x6 create", loop([&f](size_t) {
+                     sink = sink +
+                            createVoteResultPacket(f.result).getTotalSize();
+                   })});
+  cases.push_back({"serialization/VoteResult x6 extract",
+                   loop([resultPacket](size_t) {
+                     sink = sink + extractVoteResult(resultPacket).tally.size();
+                   })});
+  cases.push_back({"serialization/VoteResult x6 encode", loop([&f](size_t) {
+                     sink = sink + encodeVoteResult(f.result)->size();
+                   })});
+}
+
+void addMessageQueueCases(std::vector<Case> &cases) {
+  constexpr size_t PRODUCERS = 4;
+  constexpr size_t BATCH = 32;
+
+  cases.push_back({"message_queue/push+pop 1 thread", [](size_t iterations) {
+                     static MessageQueue queue;
+                     const std::string payload(16, 'p');
+                     Packet packet;
+                     for (size_t i = 0; i < iterations; ++i) {
+                       queue.push(Packet(MessageType::CHAT, payload));
+                       queue.tryPop(packet);
+                     }
+                     sink = sink + packet.getTotalSize();
+                   }});
+
+  // One op is one packet through the queue: PRODUCERS threads push
+  // iterations packets between them while this thread drains in batches.
+  cases.push_back(
+      {"message_queue/push+pop 4 producers", [](size_t iterations) {
+         MessageQueue queue(MessageQueue::DEFAULT_CAPACITY,
+                            OverflowPolicy::BLOCK);
+         const std::string payload(16, 'p');
+         std::vector<std::thread> producers;
+         for (size_t p = 0; p < PRODUCERS; ++p) {
+           size_t count = iterations / PRODUCERS +
+                          (p < iterations % PRODUCERS ? 1 : 0);
+           producers.emplace_back([&queue, &payload, count]() {
+             for (size_t i = 0; i < count; ++i)
+               queue.push(Packet(MessageType::CHAT, payload));
+           });
+         }
+         Packet batch[BATCH];
+         size_t received = 0;
+         while (received < iterations)
+           received += queue.waitPopN(batch, BATCH,
+                                      std::chrono::milliseconds(1));
+         for (auto &producer : producers)
+           producer.join();
+         sink = sink + received;
+       }});
+}
+
+void addConnectionManagerCases(std::vector<Case> &cases) {
+  constexpr uint32_t CONNECTIONS = 10000;
+  constexpr size_t PROBES = 4096;
+
+  // Shared by the cases below; built once, on first use.
+  struct Table {
+    ConnectionManager manager;
+    std::vector<uint32_t> hits;
+    std::vector<std::string> names;
+
+    Table() {
+      sockaddr_in address{};
+      for (uint32_t id = 1; id <= CONNECTIONS; ++id) {
+        manager.addConnection(id, INVALID_SOCKET, address);
+        manager.setStatus(id, ConnectionStatus::ACTIVE);
+        manager.setUsername(id, "user" + std::to_string(id));
+      }
+      Random random(7);
+      for (size_t i = 0; i < PROBES; ++i) {
+        uint32_t id = 1 + random.below(CONNECTIONS);
+        hits.push_back(id);
+        names.push_back("user" + std::to_string(id));
+      }
+    }
+
+    static Table &instance() {
+      static Table table;
+      return table;
+    }
+  };
+
+  cases.push_back(
+      {"connection_manager/withConnection hit", loop([](size_t i) {
+         Table &t = Table::instance();
+         t.manager.withConnection(t.hits[i % PROBES],
+                                  [](ConnectionInfo &info) { sink = info.id; });
+       })});
+  cases.push_back({"connection_manager/getConnection hit", loop([](size_t i) {
+                     Table &t = Table::instance();
+                     sink = sink + t.manager.getConnection(t.hits[i % PROBES])
+                                       ->id;
+                   })});
+  cases.push_back({"connection_manager/hasConnection miss", loop([](size_t i) {
+                     Table &t = Table::instance();
+                     sink = sink + t.manager.hasConnection(
+                                       CONNECTIONS + t.hits[i % PROBES]);
+                   })});
+  cases.push_back(
+      {"connection_manager/findConnectionByUsername", loop([](size_t i) {
+         Table &t = Table::instance();
+         sink = sink +
+                t.manager.findConnectionByUsername(t.names[i % PROBES])->id;
+       })});
+  cases.push_back({"connection_manager/forEachActive 10k", loop([](size_t) {
+                     size_t count = 0;
+                     Table::instance().manager.forEachActive(
+                         [&count](ConnectionInfo &) { ++count; });
+                     sink = sink + count;
+                   })});
+}
+
+void addGameStateCases(std::vector<Case> &cases) {
+  constexpr uint32_t PLAYERS = 6;
+
+  struct Room {
+    GameState state{false, Random(1)};
+    std::vector<std::string> names;
+
+    Room() {
+      for (uint32_t id = 1; id <= PLAYERS; ++id) {
+        names.push_back("player_" + std::to_string(id));
+        state.addPlayer(id, names.back());
+      }
+      state.startNewRound();
+    }
+
+    // Every player votes by name, all but one for the same target, then
+    // the standing is read and scores applied, as GameRoom does.
+    void voteRound(size_t round) {
+      std::string_view target = names[round % PLAYERS];
+      for (uint32_t voter = 0; voter < PLAYERS; ++voter) {
+        uint32_t targetId = state.findPlayerByUsername(
+            voter == 0 ? names[(round + 1) % PLAYERS] : target);
+        state.submitVote(voter + 1, targetId);
+      }
+      VoteStanding standing = state.getVoteStanding();
+      bool hasMajority = standing.leaderVotes > standing.playerCount / 2;
+      bool liarCaught = standing.leaderId == state.getCurrentLiarId();
+      state.calculateAndApplyScores(liarCaught, standing.leaderId, hasMajority);
+    }
+  };
+
+  cases.push_back({"game_state/vote cycle x6", [](size_t iterations) {
+                     static Room room;
+                     for (size_t i = 0; i < iterations; ++i) {
+                       room.voteRound(i);
+                       room.state.clearVotes();
+                     }
+                   }});
+  // What a room does per round: deal, vote, snapshot for the state update,
+  // clear.
+  cases.push_back({"game_state/full round x6", [](size_t iterations) {
+                     static Room room;
+                     for (size_t i = 0; i < iterations; ++i) {
+                       room.state.startNewRound();
+                       room.voteRound(i);
+                       sink = sink + room.state.getAllPlayerStates().size();
+                       room.state.clearRound();
+                     }
+                   }});
+}
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program << " [--filter TEXT] [--min-ms N] [--csv]"
+            << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string filter;
+  long minMs = 100;
+  bool csv = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--filter" && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "--min-ms" && i + 1 < argc) {
+      minMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--csv") {
+      csv = true;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (minMs <= 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  // GameState logs each round to stdout; keep it for the results.
+  std::streambuf *console = std::cout.rdbuf();
+  std::ostream out(console);
+  std::cout.rdbuf(nullptr);
+
+  Fixture fixture;
+  std::vector<Case> cases;
+  addPacketCases(cases, fixture);
+  addSerializationCases(cases, fixture);
+  addMessageQueueCases(cases);
+  addConnectionManagerCases(cases);
+  addGameStateCases(cases);
+
+  if (csv)
+    out << "name,iterations,ns_per_op,allocs_per_op,bytes_per_op\n";
+  else
+    out << std::left << std::setw(44) << "case" << std::right
+        << std::setw(12) << "iterations" << std::setw(12) << "ns/op"
+        << std::setw(12) << "allocs/op" << std::setw(12) << "bytes/op"
+        << std::endl;
+
+  for (const Case &benchmark : cases) {
+    if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+      continue;
+    Result result = measure(benchmark, std::chrono::milliseconds(minMs));
+    if (csv) {
+      out << benchmark.name << ',' << result.iterations << ',' << std::fixed
+          << std::setprecision(2) << result.nsPerOp << ',' << result.allocsPerOp
+          << ',' << result.bytesPerOp << '\n';
+    } else {
+      out << std::left << std::setw(44) << benchmark.name << std::right
+          << std::setw(12) << result.iterations << std::fixed
+          << std::setprecision(1) << std::setw(12) << result.nsPerOp
+          << std::setprecision(2) << std::setw(12) << result.allocsPerOp
+          << std::setprecision(1) << std::setw(12) << result.bytesPerOp
+          << std::endl;
+    }
+  }
+  out.flush();
+  std::cout.rdbuf(console);
+  return 0;
+}
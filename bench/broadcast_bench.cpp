@@ -0,0 +1,185 @@
+#include "common/packet.h"
+#include "server/server.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Fan-out cost of one packet to many recipients.
+//
+// Usage: broadcast_bench [recipients] [broadcasts] [payload bytes]
+//
+// Connects raw sockets to a Server, then sends each packet to all of them
+// either through a per-recipient sendPacket() loop (one lookup and one
+// serialize() per client) or through broadcast() (one shared WireBuffer).
+// "call" is time spent inside the server API; "delivered" runs until every
+// recipient has read every byte.
+
+using namespace net;
+
+namespace {
+
+constexpr uint16_t BASE_PORT = 18100;
+
+struct Result {
+  double callSeconds;
+  double deliveredSeconds;
+};
+
+std::vector<int> connectClients(uint16_t port, size_t count) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+  std::vector<int> sockets;
+  for (size_t i = 0; i < count; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1 || connect(fd, (sockaddr *)&address, sizeof(address)) == -1) {
+      std::cerr << "connect failed after " << i << " clients: " << errno
+                << std::endl;
+      if (fd != -1)
+        close(fd);
+      break;
+    }
+    sockets.push_back(fd);
+  }
+  return sockets;
+}
+
+// Reads from every socket until `expected` bytes have arrived in total.
+void drain(const std::vector<int> &sockets, size_t expected) {
+  int epollFd = epoll_create1(0);
+  for (int fd : sockets) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+  }
+
+  std::vector<uint8_t> buffer(64 * 1024);
+  std::vector<epoll_event> events(256);
+  size_t received = 0;
+  while (received < expected) {
+    int count = epoll_wait(epollFd, events.data(),
+                           static_cast<int>(events.size()), 1000);
+    if (count <= 0)
+      break;
+    for (int i = 0; i < count; ++i) {
+      ssize_t bytes = recv(events[i].data.fd, buffer.data(), buffer.size(),
+                           MSG_DONTWAIT);
+      if (bytes > 0)
+        received += static_cast<size_t>(bytes);
+    }
+  }
+  close(epollFd);
+}
+
+template <typename Fanout>
+Result run(const ServerConfig &config, uint16_t port, size_t recipients,
+           size_t broadcasts, const Packet &packet, Fanout fanout) {
+  Server server(port, config);
+  std::thread serverThread([&server] { server.start(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::vector<int> sockets = connectClients(port, recipients);
+  while (server.getConnectionCount() < sockets.size())
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::vector<uint32_t> ids = server.getConnectionManager().getActiveConnections();
+  size_t expected = ids.size() * broadcasts * packet.getTotalSize();
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread reader([&] { drain(sockets, expected); });
+
+  for (size_t i = 0; i < broadcasts; ++i)
+    fanout(server, ids, packet);
+  auto called = std::chrono::steady_clock::now();
+
+  reader.join();
+  auto delivered = std::chrono::steady_clock::now();
+
+  for (int fd : sockets)
+    close(fd);
+  server.stop();
+  serverThread.join();
+
+  return {std::chrono::duration<double>(called - start).count(),
+          std::chrono::duration<double>(delivered - start).count()};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t recipients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  size_t broadcasts = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+  size_t payloadSize = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256;
+
+  // Client and server sockets share this process.
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  Packet packet(MessageType::CHAT_MESSAGE, std::string(payloadSize, 'x'));
+
+  auto perRecipient = [](Server &server, const std::vector<uint32_t> &ids,
+                         const Packet &p) {
+    for (uint32_t id : ids)
+      server.sendPacket(id, p);
+  };
+  auto shared = [](Server &server, const std::vector<uint32_t> &,
+                   const Packet &p) { server.broadcast(p); };
+
+  struct Variant {
+    const char *name;
+    ServerBackend backend;
+    bool useBroadcast;
+  };
+  std::vector<Variant> variants = {
+      {"epoll sendPacket loop", ServerBackend::EPOLL, false},
+      {"epoll broadcast", ServerBackend::EPOLL, true},
+      {"io_uring sendPacket loop", ServerBackend::IO_URING, false},
+      {"io_uring broadcast", ServerBackend::IO_URING, true},
+  };
+
+  std::streambuf *coutBuffer = std::cout.rdbuf();
+
+  std::vector<std::pair<const char *, Result>> results;
+  uint16_t port = BASE_PORT;
+  for (const auto &variant : variants) {
+    ServerConfig config;
+    config.backend = variant.backend;
+
+    std::cout.rdbuf(nullptr);
+    Result result =
+        variant.useBroadcast
+            ? run(config, port++, recipients, broadcasts, packet, shared)
+            : run(config, port++, recipients, broadcasts, packet, perRecipient);
+    std::cout.rdbuf(coutBuffer);
+    results.emplace_back(variant.name, result);
+  }
+
+  std::cout << recipients << " recipients x " << broadcasts << " packets, "
+            << payloadSize << "-byte payload" << std::endl;
+  std::cout << std::left << std::setw(28) << "path" << std::right
+            << std::setw(18) << "call ns/recip" << std::setw(20)
+            << "delivered ns/recip" << std::endl;
+  double sends = static_cast<double>(recipients * broadcasts);
+  for (const auto &[name, result] : results) {
+    std::cout << std::left << std::setw(28) << name << std::right
+              << std::setw(18) << std::fixed << std::setprecision(0)
+              << result.callSeconds * 1e9 / sends << std::setw(20)
+              << result.deliveredSeconds * 1e9 / sends << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,205 @@
+#include "server/connection_manager.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Connection table read throughput under connect/disconnect churn.
+//
+// Usage: connection_manager_bench [readers] [connections] [milliseconds]
+//
+// One writer thread keeps a sliding window of live ids: it adds the next id
+// and removes the oldest as fast as it can. Reader threads look up random
+// ids from the window or scan the active set. The "mutex map" rows are the
+// previous single-mutex unordered_map design for comparison.
+
+using namespace net;
+
+namespace {
+
+// The pre-sharding ConnectionManager: one mutex, shared_ptr copies out.
+class MutexTable {
+public:
+  void add(uint32_t id) {
+    sockaddr_in address{};
+    auto info = std::make_shared<ConnectionInfo>(id, INVALID_SOCKET, address);
+    info->status = ConnectionStatus::ACTIVE;
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_[id] = std::move(info);
+  }
+
+  void remove(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.erase(id);
+  }
+
+  std::shared_ptr<ConnectionInfo> get(uint32_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(id);
+    return it != connections_.end() ? it->second : nullptr;
+  }
+
+  std::vector<uint32_t> active() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<uint32_t> ids;
+    for (const auto &[id, info] : connections_) {
+      if (info->status == ConnectionStatus::ACTIVE)
+        ids.push_back(id);
+    }
+    return ids;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<uint32_t, std::shared_ptr<ConnectionInfo>> connections_;
+};
+
+class ManagerTable {
+public:
+  explicit ManagerTable(size_t shards) : manager_(shards) {}
+
+  void add(uint32_t id) {
+    sockaddr_in address{};
+    manager_.addConnection(id, INVALID_SOCKET, address);
+    manager_.setStatus(id, ConnectionStatus::ACTIVE);
+  }
+
+  void remove(uint32_t id) { manager_.removeConnection(id); }
+
+  ConnectionManager &manager() { return manager_; }
+
+private:
+  ConnectionManager manager_;
+};
+
+struct Result {
+  double readsPerSecond;
+  double churnPerSecond;
+};
+
+template <typename Table, typename Read>
+Result run(Table &table, size_t readers, size_t connections,
+           std::chrono::milliseconds duration, Read read) {
+  std::atomic<uint32_t> oldest{1};
+  for (uint32_t id = 1; id <= connections; ++id)
+    table.add(id);
+
+  std::atomic<bool> running{true};
+  std::atomic<size_t> reads{0};
+  // Keeps the reads observable so the lookups are not optimized away.
+  std::atomic<size_t> checksum{0};
+  size_t churn = 0;
+
+  std::thread writer([&] {
+    uint32_t next = static_cast<uint32_t>(connections) + 1;
+    while (running.load(std::memory_order_relaxed)) {
+      table.add(next++);
+      table.remove(oldest.load(std::memory_order_relaxed));
+      oldest.fetch_add(1, std::memory_order_relaxed);
+      ++churn;
+    }
+  });
+
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < readers; ++r) {
+    threads.emplace_back([&, r] {
+      std::mt19937 rng(static_cast<uint32_t>(r + 1));
+      size_t local = 0;
+      size_t sink = 0;
+      while (running.load(std::memory_order_relaxed)) {
+        uint32_t id = oldest.load(std::memory_order_relaxed) +
+                      static_cast<uint32_t>(rng() % connections);
+        sink += read(table, id);
+        ++local;
+      }
+      reads.fetch_add(local, std::memory_order_relaxed);
+      checksum.fetch_add(sink, std::memory_order_relaxed);
+    });
+  }
+
+  std::this_thread::sleep_for(duration);
+  running = false;
+  writer.join();
+  for (auto &thread : threads)
+    thread.join();
+
+  double seconds = std::chrono::duration<double>(duration).count();
+  return {reads / seconds, churn / seconds};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t readers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+  size_t connections = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+  auto duration = std::chrono::milliseconds(
+      argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 500);
+
+  std::vector<std::pair<const char *, Result>> results;
+
+  {
+    MutexTable table;
+    results.emplace_back(
+        "mutex map lookup",
+        run(table, readers, connections, duration,
+            [](MutexTable &t, uint32_t id) { return t.get(id) ? 1 : 0; }));
+  }
+  {
+    ManagerTable table(4);
+    results.emplace_back(
+        "getConnection", run(table, readers, connections, duration,
+                             [](ManagerTable &t, uint32_t id) {
+                               return t.manager().getConnection(id) ? 1 : 0;
+                             }));
+  }
+  {
+    ManagerTable table(4);
+    results.emplace_back(
+        "withConnection",
+        run(table, readers, connections, duration,
+            [](ManagerTable &t, uint32_t id) {
+              return t.manager().withConnection(id, [](ConnectionInfo &) {})
+                         ? 1
+                         : 0;
+            }));
+  }
+  {
+    MutexTable table;
+    results.emplace_back("mutex map scan",
+                         run(table, readers, connections, duration,
+                             [](MutexTable &t, uint32_t) {
+                               return static_cast<int>(t.active().size());
+                             }));
+  }
+  {
+    ManagerTable table(4);
+    results.emplace_back(
+        "forEachActive", run(table, readers, connections, duration,
+                             [](ManagerTable &t, uint32_t) {
+                               int count = 0;
+                               t.manager().forEachActive(
+                                   [&count](ConnectionInfo &) { count++; });
+                               return count;
+                             }));
+  }
+
+  std::cout << readers << " readers, " << connections
+            << " live connections, 1 churn thread, " << duration.count()
+            << " ms per row" << std::endl;
+  std::cout << std::left << std::setw(20) << "operation" << std::right
+            << std::setw(16) << "reads/s" << std::setw(16) << "churn/s"
+            << std::endl;
+  for (const auto &[name, result] : results) {
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(16) << std::fixed << std::setprecision(0)
+              << result.readsPerSecond << std::setw(16)
+              << result.churnPerSecond << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,387 @@
+#include "common/game_state.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GameState storage: flat player columns versus the previous hash maps.
+//
+// Usage: game_state_bench [rounds]
+//
+// Simulates `rounds` rounds per room size, on an unsynchronized state as the
+// game loop and room manager use it. A "vote" round is what a room does once
+// roles are out: every player's target resolved by name and voted, the
+// standing read, scores applied, the snapshot taken for the state update,
+// and the votes cleared. A "full" round adds startNewRound and clearRound
+// (a tenth as many). "legacy" is GameState as it was before the flat layout
+// and the per-room Random, kept below; it seeds a std::mt19937 from
+// std::random_device twice per round. Global operator new is counted for
+// allocations per round. Last, each startNewRound of a six-player room is
+// timed on its own for its latency distribution.
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+} // namespace
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *pointer = std::malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+
+using namespace net;
+
+namespace legacy {
+
+// The previous GameState, trimmed to the calls a round makes.
+class GameState {
+public:
+  explicit GameState(bool synchronized = true)
+      : synchronized_(synchronized) {}
+
+  bool addPlayer(uint32_t id, const std::string &username = "") {
+    auto lock = acquire();
+    if (players_.find(id) != players_.end())
+      return false;
+    PlayerState &player = players_[id] = PlayerState(id, username);
+    if (!player.username.empty())
+      byUsername_.emplace(player.username.view(), id);
+    return true;
+  }
+
+  uint32_t findPlayerByUsername(std::string_view username) const {
+    auto lock = acquire();
+    auto it = byUsername_.find(username);
+    return it != byUsername_.end() ? it->second : 0;
+  }
+
+  std::vector<PlayerState> getAllPlayerStates() const {
+    auto lock = acquire();
+    std::vector<PlayerState> states;
+    states.reserve(players_.size());
+    for (const auto &pair : players_)
+      states.push_back(pair.second);
+    return states;
+  }
+
+  void startNewRound() {
+    auto lock = acquire();
+    std::cout << "[GameState] startNewRound() called, player count: "
+              << players_.size() << std::endl;
+    if (players_.size() < 3 || players_.size() > 6)
+      return;
+    std::cout << "[GameState] Clearing previous round..." << std::endl;
+    resetRound();
+
+    std::cout << "[GameState] Picking random topic and word..." << std::endl;
+    auto [topic, word] = pickRandomTopicAndWord();
+    currentTopic_ = topic;
+    currentWord_ = word;
+    std::cout << "[GameState] Selected topic: " << topic << ", word: " << word
+              << std::endl;
+
+    std::vector<uint32_t> playerIds;
+    playerIds.reserve(players_.size());
+    for (const auto &pair : players_)
+      playerIds.push_back(pair.first);
+
+    std::cout << "[GameState] Selecting random liar from " << playerIds.size()
+              << " players..." << std::endl;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<size_t> dis(0, playerIds.size() - 1);
+    currentLiarId_ = playerIds[dis(gen)];
+    std::cout << "[GameState] Selected liar: Player [" << currentLiarId_ << "]"
+              << std::endl;
+
+    for (auto &pair : players_) {
+      pair.second.role = pair.first == currentLiarId_ ? PlayerRole::LIAR
+                                                      : PlayerRole::GUESSER;
+    }
+
+    roundActive_ = true;
+    std::cout << "[GameState] Round is now active" << std::endl;
+    std::cout << "[GameState] startNewRound() completed successfully"
+              << std::endl;
+  }
+
+  void clearRound() {
+    auto lock = acquire();
+    resetRound();
+  }
+
+  uint32_t getCurrentLiarId() const {
+    auto lock = acquire();
+    return currentLiarId_;
+  }
+
+  VoteStatus submitVote(uint32_t voterId, uint32_t targetId) {
+    auto lock = acquire();
+    if (!roundActive_)
+      return VoteStatus::NO_ROUND;
+    if (votes_.find(voterId) != votes_.end())
+      return VoteStatus::REJECTED;
+    if (players_.find(voterId) == players_.end() ||
+        players_.find(targetId) == players_.end())
+      return VoteStatus::REJECTED;
+
+    votes_[voterId] = targetId;
+    uint32_t votes = ++tally_[targetId];
+    if (votes > leaderVotes_) {
+      leaderId_ = targetId;
+      leaderVotes_ = votes;
+    }
+    return votes_.size() >= players_.size() ? VoteStatus::ROUND_COMPLETE
+                                            : VoteStatus::COUNTED;
+  }
+
+  std::unordered_map<uint32_t, uint32_t> getVoteTally() const {
+    auto lock = acquire();
+    return tally_;
+  }
+
+  VoteStanding getVoteStanding() const {
+    auto lock = acquire();
+    VoteStanding standing;
+    standing.leaderId = leaderId_;
+    standing.leaderVotes = leaderVotes_;
+    standing.votesCast = votes_.size();
+    standing.playerCount = players_.size();
+    return standing;
+  }
+
+  void clearVotes() {
+    auto lock = acquire();
+    resetVotes();
+  }
+
+  void calculateAndApplyScores(bool liarCaught, uint32_t votedOutId,
+                               bool hasMajority) {
+    auto lock = acquire();
+    if (!roundActive_ || currentLiarId_ == 0)
+      return;
+    if (liarCaught && votedOutId == currentLiarId_ && hasMajority) {
+      for (auto &pair : players_) {
+        if (pair.second.role == PlayerRole::GUESSER &&
+            votes_.find(pair.first) != votes_.end() &&
+            votes_[pair.first] == currentLiarId_)
+          pair.second.score += 1;
+      }
+    } else if (!liarCaught && hasMajority && votedOutId != currentLiarId_) {
+      if (players_.find(currentLiarId_) != players_.end())
+        players_[currentLiarId_].score += 2;
+    }
+  }
+
+private:
+  bool synchronized_;
+  mutable std::mutex mutex_;
+  std::unordered_map<uint32_t, PlayerState> players_;
+  std::unordered_multimap<std::string_view, uint32_t> byUsername_;
+
+  bool roundActive_ = false;
+  InternedString currentTopic_;
+  InternedString currentWord_;
+  uint32_t currentLiarId_ = 0;
+
+  std::unordered_map<uint32_t, uint32_t> votes_;
+  std::unordered_map<uint32_t, uint32_t> tally_;
+  uint32_t leaderId_ = 0;
+  uint32_t leaderVotes_ = 0;
+
+  std::unique_lock<std::mutex> acquire() const {
+    if (!synchronized_)
+      return std::unique_lock<std::mutex>();
+    return std::unique_lock<std::mutex>(mutex_);
+  }
+
+  void resetRound() {
+    roundActive_ = false;
+    currentTopic_ = InternedString();
+    currentWord_ = InternedString();
+    currentLiarId_ = 0;
+    resetVotes();
+    for (auto &pair : players_)
+      pair.second.role = PlayerRole::NONE;
+  }
+
+  void resetVotes() {
+    votes_.clear();
+    tally_.clear();
+    leaderId_ = 0;
+    leaderVotes_ = 0;
+  }
+
+  std::pair<InternedString, InternedString> pickRandomTopicAndWord() const {
+    static const std::vector<
+        std::pair<InternedString, std::vector<InternedString>>>
+        topics = {{"Fruit", {"Apple", "Banana", "Orange", "Grape"}},
+                  {"City", {"Paris", "Tokyo", "London", "Berlin"}},
+                  {"Animal", {"Dog", "Cat", "Elephant", "Lion"}}};
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<size_t> topicDis(0, topics.size() - 1);
+    const auto &topic = topics[topicDis(gen)];
+    std::uniform_int_distribution<size_t> wordDis(0, topic.second.size() - 1);
+    return {topic.first, topic.second[wordDis(gen)]};
+  }
+};
+
+} // namespace legacy
+
+namespace {
+
+struct Result {
+  double nsPerRound;
+  double allocsPerRound;
+};
+
+volatile size_t sink;
+
+template <typename State>
+void voteRound(State &state, const std::vector<std::string> &names,
+               size_t round) {
+  size_t players = names.size();
+  // Everyone but the first voter piles onto one target, so the round ends
+  // with a majority and scores move.
+  std::string_view target = names[round % players];
+  for (size_t voter = 0; voter < players; ++voter) {
+    uint32_t targetId = state.findPlayerByUsername(
+        voter == 0 ? names[(round + 1) % players] : target);
+    state.submitVote(static_cast<uint32_t>(voter + 1), targetId);
+  }
+  VoteStanding standing = state.getVoteStanding();
+  bool hasMajority = standing.leaderVotes > standing.playerCount / 2;
+  bool liarCaught = standing.leaderId == state.getCurrentLiarId();
+  state.calculateAndApplyScores(liarCaught, standing.leaderId, hasMajority);
+  sink = state.getVoteTally().size() + state.getAllPlayerStates().size();
+  state.clearVotes();
+}
+
+template <typename State>
+Result simulate(size_t players, size_t rounds, bool fullRounds) {
+  State state(false);
+  std::vector<std::string> names;
+  for (uint32_t id = 1; id <= players; ++id) {
+    names.push_back("player_" + std::to_string(id));
+    state.addPlayer(id, names.back());
+  }
+  state.startNewRound();
+
+  auto run = [&](size_t round) {
+    if (fullRounds)
+      state.startNewRound();
+    voteRound(state, names, round);
+    if (fullRounds)
+      state.clearRound();
+  };
+  for (size_t round = 0; round < 64; ++round)
+    run(round);
+
+  size_t before = allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < rounds; ++round)
+    run(round);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  size_t count = allocations.load() - before;
+
+  return {std::chrono::duration<double, std::nano>(elapsed).count() / rounds,
+          static_cast<double>(count) / rounds};
+}
+
+// Sorted latencies of `rounds` single startNewRound calls.
+template <typename State> std::vector<double> roundStarts(size_t rounds) {
+  State state(false);
+  for (uint32_t id = 1; id <= GameState::INLINE_PLAYERS; ++id)
+    state.addPlayer(id, "player_" + std::to_string(id));
+
+  std::vector<double> samples;
+  samples.reserve(rounds);
+  for (size_t round = 0; round < rounds; ++round) {
+    auto start = std::chrono::steady_clock::now();
+    state.startNewRound();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    samples.push_back(
+        std::chrono::duration<double, std::nano>(elapsed).count());
+    state.clearRound();
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples;
+}
+
+void printRoundStarts(size_t rounds) {
+  std::streambuf *out = std::cout.rdbuf();
+  std::cout.rdbuf(nullptr);
+  std::vector<double> before = roundStarts<legacy::GameState>(rounds);
+  std::vector<double> after = roundStarts<GameState>(rounds);
+  std::cout.rdbuf(out);
+  std::cout.clear();
+
+  auto at = [](const std::vector<double> &samples, double quantile) {
+    return samples[static_cast<size_t>(quantile * (samples.size() - 1))];
+  };
+  std::cout << "startNewRound, 6 players, " << rounds << " rounds, ns"
+            << std::endl;
+  std::cout << std::left << std::setw(10) << "" << std::right << std::setw(12)
+            << "p50" << std::setw(12) << "p99" << std::setw(12) << "p99.9"
+            << std::endl;
+  for (const auto &[name, samples] :
+       {std::make_pair("legacy", &before), std::make_pair("random", &after)}) {
+    std::cout << std::left << std::setw(10) << name << std::right
+              << std::setw(12) << at(*samples, 0.5) << std::setw(12)
+              << at(*samples, 0.99) << std::setw(12) << at(*samples, 0.999)
+              << std::endl;
+  }
+}
+
+void printTable(const char *title, size_t rounds, bool fullRounds) {
+  std::streambuf *out = std::cout.rdbuf();
+  std::cout << title << ", " << rounds << " rounds per row" << std::endl;
+  std::cout << std::left << std::setw(10) << "players" << std::right
+            << std::setw(14) << "legacy ns" << std::setw(14) << "allocs"
+            << std::setw(14) << "flat ns" << std::setw(14) << "allocs"
+            << std::endl;
+
+  for (size_t players = 3; players <= GameState::INLINE_PLAYERS; ++players) {
+    // startNewRound logs every round; keep that out of the timings.
+    std::cout.rdbuf(nullptr);
+    Result before = simulate<legacy::GameState>(players, rounds, fullRounds);
+    Result after = simulate<GameState>(players, rounds, fullRounds);
+    std::cout.rdbuf(out);
+    std::cout.clear();
+
+    std::cout << std::left << std::setw(10) << players << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14)
+              << before.nsPerRound << std::setw(14) << before.allocsPerRound
+              << std::setw(14) << after.nsPerRound << std::setw(14)
+              << after.allocsPerRound << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+
+  std::cout << "sizeof(GameState): legacy " << sizeof(legacy::GameState)
+            << ", flat " << sizeof(GameState) << " bytes" << std::endl;
+  printTable("vote rounds", rounds, false);
+  std::cout << std::endl;
+  printTable("full rounds", std::max<size_t>(rounds / 10, 1), true);
+  std::cout << std::endl;
+  printRoundStarts(std::max<size_t>(rounds / 10, 1));
+  return 0;
+}
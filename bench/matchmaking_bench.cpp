@@ -0,0 +1,166 @@
+#include "server/matchmaker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Matchmaker cost at scale and the wait-time vs fill-ratio tradeoff.
+//
+// Usage: matchmaking_bench [queued] [arrivals per second]
+//
+// The first table queues `queued` players without matching, cancels every
+// tenth, then drains the rest into rooms, timing each step per player.
+// The second replays ten simulated minutes of Poisson arrivals at the given
+// rate against several configurations, driving poll() with a simulated
+// clock every millisecond. A room's round starts as soon as its group is
+// seated, so the queue wait is the time to round start minus one game
+// tick of dispatch.
+
+using namespace net;
+using Clock = Matchmaker::Clock;
+
+namespace {
+
+double nanosPerOp(Clock::time_point start, size_t ops) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         static_cast<double>(ops);
+}
+
+void runScale(size_t queued) {
+  MatchmakingConfig config;
+  config.targetPlayers = 6;
+  config.maxWait = std::chrono::hours(1);
+
+  // Without start() groups only form when poll() is called.
+  size_t seated = 0;
+  Matchmaker matchmaker(config, [&](const std::vector<Matchmaker::Ticket> &g) {
+    seated += g.size();
+    return true;
+  });
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < queued; ++i)
+    matchmaker.enqueue(static_cast<uint32_t>(i), "player" + std::to_string(i));
+  double enqueueNs = nanosPerOp(start, queued);
+
+  size_t cancels = queued / 10;
+  start = Clock::now();
+  for (size_t i = 0; i < cancels; ++i)
+    matchmaker.cancel(static_cast<uint32_t>(i * 10 + 7));
+  double cancelNs = nanosPerOp(start, std::max<size_t>(cancels, 1));
+
+  size_t remaining = matchmaker.getQueuedCount();
+  start = Clock::now();
+  matchmaker.poll();
+  double drainNs = nanosPerOp(start, std::max<size_t>(remaining, 1));
+
+  std::cout << queued << " players queued" << std::endl;
+  std::cout << std::left << std::setw(28) << "operation" << std::right
+            << std::setw(14) << "ns/player" << std::endl;
+  std::cout << std::fixed << std::setprecision(0);
+  std::cout << std::left << std::setw(28) << "enqueue" << std::right
+            << std::setw(14) << enqueueNs << std::endl;
+  std::cout << std::left << std::setw(28) << "cancel (every 10th)"
+            << std::right << std::setw(14) << cancelNs << std::endl;
+  std::cout << std::left << std::setw(28) << "form rooms (drain)" << std::right
+            << std::setw(14) << drainNs << std::endl;
+  std::cout << "  " << matchmaker.getRoomsFormed() << " rooms, "
+            << matchmaker.getQueuedCount() << " left over, " << seated
+            << " seated" << std::endl;
+}
+
+struct Outcome {
+  double meanRoomSize;
+  double p50Ms;
+  double p99Ms;
+  double maxMs;
+};
+
+Outcome simulate(size_t target, std::chrono::milliseconds maxWait,
+                 double arrivalsPerSecond) {
+  MatchmakingConfig config;
+  config.targetPlayers = target;
+  config.maxWait = maxWait;
+
+  Clock::time_point now{};
+  std::vector<double> waits;
+  uint64_t rooms = 0;
+  Matchmaker matchmaker(config, [&](const std::vector<Matchmaker::Ticket> &g) {
+    for (const auto &ticket : g)
+      waits.push_back(
+          std::chrono::duration<double, std::milli>(now - ticket.enqueued)
+              .count());
+    rooms++;
+    return true;
+  });
+
+  std::mt19937_64 random(42);
+  std::exponential_distribution<double> gap(arrivalsPerSecond / 1000.0);
+  const auto duration = std::chrono::minutes(10);
+  double nextArrivalMs = gap(random);
+  uint32_t nextId = 0;
+
+  for (auto tick = std::chrono::milliseconds(0); tick < duration;
+       tick += std::chrono::milliseconds(1)) {
+    now = Clock::time_point(tick);
+    while (nextArrivalMs < static_cast<double>(tick.count())) {
+      matchmaker.enqueue(nextId++, "p", now);
+      nextArrivalMs += gap(random);
+    }
+    matchmaker.poll(now);
+  }
+
+  Outcome outcome{0, 0, 0, 0};
+  if (waits.empty())
+    return outcome;
+  std::sort(waits.begin(), waits.end());
+  outcome.meanRoomSize = static_cast<double>(waits.size()) / rooms;
+  outcome.p50Ms = waits[waits.size() / 2];
+  outcome.p99Ms = waits[waits.size() * 99 / 100];
+  outcome.maxMs = waits.back();
+  return outcome;
+}
+
+void runTradeoff(double arrivalsPerSecond) {
+  struct Setting {
+    size_t target;
+    long waitMs;
+  };
+  const Setting settings[] = {{3, 0},    {6, 0},    {6, 250},
+                              {6, 1000}, {6, 4000}, {6, 60000}};
+
+  std::cout << std::endl
+            << arrivalsPerSecond << " arrivals/s over 10 simulated minutes"
+            << std::endl;
+  std::cout << std::left << std::setw(8) << "target" << std::right
+            << std::setw(10) << "wait ms" << std::setw(12) << "room size"
+            << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms"
+            << std::setw(12) << "max ms" << std::endl;
+  for (const Setting &setting : settings) {
+    Outcome outcome =
+        simulate(setting.target, std::chrono::milliseconds(setting.waitMs),
+                 arrivalsPerSecond);
+    std::cout << std::left << std::setw(8) << setting.target << std::right
+              << std::setw(10) << setting.waitMs << std::setw(12)
+              << std::setprecision(2) << outcome.meanRoomSize
+              << std::setprecision(0) << std::setw(12) << outcome.p50Ms
+              << std::setw(12) << outcome.p99Ms << std::setw(12)
+              << outcome.maxMs << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t queued = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+  double rate = argc > 2 ? std::strtod(argv[2], nullptr) : 20.0;
+
+  runScale(queued);
+  runTradeoff(rate);
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include "server/message_queue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+// MessageQueue throughput under producer/consumer contention.
+//
+// Usage: message_queue_bench [producers] [consumers] [packets] [capacity]
+//
+// Every producer pushes `packets` small packets; consumers drain until all
+// have arrived. The "mutex queue" row is the previous std::queue + mutex +
+// condition variable MessageQueue for comparison. Ring rows use the BLOCK
+// policy so nothing is dropped.
+
+using namespace net;
+
+namespace {
+
+// The pre-ring MessageQueue, unbounded.
+class MutexQueue {
+public:
+  void push(Packet &&packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push(std::move(packet));
+    condition_.notify_one();
+  }
+
+  bool tryPop(Packet &packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty())
+      return false;
+    packet = std::move(queue_.front());
+    queue_.pop();
+    return true;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::queue<Packet> queue_;
+};
+
+constexpr size_t BATCH = 32;
+
+enum class Drain { SINGLE, BATCH, BLOCKING };
+
+template <typename Push, typename Pop>
+double run(size_t producers, size_t consumers, size_t packets, Push &&push,
+           Pop &&pop) {
+  const std::string payload(16, 'p');
+  const size_t total = producers * packets;
+  std::atomic<size_t> received{0};
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&] {
+      Packet batch[BATCH];
+      while (received.load(std::memory_order_relaxed) < total) {
+        size_t count = pop(batch);
+        if (count > 0)
+          received.fetch_add(count, std::memory_order_relaxed);
+        else
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < packets; ++i)
+        push(Packet(MessageType::CHAT, payload));
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return total / seconds;
+}
+
+double runRing(size_t producers, size_t consumers, size_t packets,
+               size_t capacity, Drain drain) {
+  MessageQueue queue(capacity, OverflowPolicy::BLOCK);
+  return run(
+      producers, consumers, packets,
+      [&](Packet &&packet) { queue.push(std::move(packet)); },
+      [&](Packet *batch) -> size_t {
+        switch (drain) {
+        case Drain::SINGLE:
+          return queue.tryPop(batch[0]) ? 1 : 0;
+        case Drain::BATCH:
+          return queue.tryPopN(batch, BATCH);
+        case Drain::BLOCKING:
+          return queue.waitPopN(batch, BATCH, std::chrono::milliseconds(1));
+        }
+        return 0;
+      });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t producers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+  size_t consumers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+  size_t packets = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 250000;
+  size_t capacity = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 4096;
+
+  std::vector<std::pair<const char *, double>> results;
+
+  {
+    MutexQueue queue;
+    results.emplace_back(
+        "mutex queue",
+        run(
+            producers, consumers, packets,
+            [&](Packet &&packet) { queue.push(std::move(packet)); },
+            [&](Packet *batch) -> size_t {
+              return queue.tryPop(batch[0]) ? 1 : 0;
+            }));
+  }
+  results.emplace_back(
+      "ring tryPop", runRing(producers, consumers, packets, capacity,
+                             Drain::SINGLE));
+  results.emplace_back(
+      "ring tryPopN", runRing(producers, consumers, packets, capacity,
+                              Drain::BATCH));
+  results.emplace_back(
+      "ring waitPopN", runRing(producers, consumers, packets, capacity,
+                               Drain::BLOCKING));
+
+  std::cout << producers << " producers, " << consumers << " consumers, "
+            << packets << " packets each, ring capacity " << capacity
+            << std::endl;
+  std::cout << std::left << std::setw(16) << "queue" << std::right
+            << std::setw(16) << "packets/s" << std::endl;
+  for (const auto &[name, rate] : results) {
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(16) << std::fixed << std::setprecision(0) << rate
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include "common/packet.h"
+#include "common/serialization.h"
+#include "server/message_queue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Heap allocations per packet on the hot packet paths.
+//
+// Usage: packet_alloc_bench [iterations]
+//
+// Global operator new is counted, so every row reports exactly how many
+// allocations one operation costs in steady state. "chat" is a 96-byte
+// payload (under the inline limit), "state" a 1 KiB one. "room update"
+// encodes a full six-player GAME_STATE_UPDATE ready to send, through a Packet
+// and toWire() or straight into a PacketWriter.
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+} // namespace
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *pointer = std::malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+
+using namespace net;
+
+namespace {
+
+struct Result {
+  double allocsPerOp;
+  double nsPerOp;
+};
+
+template <typename Fn> Result measure(size_t iterations, Fn &&fn) {
+  // Warm-up fills any per-thread caches.
+  for (size_t i = 0; i < 64; ++i)
+    fn();
+
+  size_t before = allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    fn();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  size_t count = allocations.load() - before;
+
+  return {static_cast<double>(count) / iterations,
+          std::chrono::duration<double, std::nano>(elapsed).count() /
+              iterations};
+}
+
+std::vector<uint8_t> framed(const Packet &packet) { return packet.serialize(); }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  const std::string chat(96, 'c');
+  const std::vector<uint8_t> state(1024, 's');
+  const Packet chatPacket(MessageType::CHAT_MESSAGE, chat);
+  const Packet statePacket(MessageType::GAME_STATE_UPDATE, state);
+  const std::vector<uint8_t> chatFrame = framed(chatPacket);
+  const std::vector<uint8_t> stateFrame = framed(statePacket);
+
+  std::vector<PlayerState> players;
+  for (uint32_t i = 0; i < 6; ++i)
+    players.emplace_back(1040 + i, "player_" + std::to_string(i),
+                         PlayerRole::GUESSER, static_cast<int>(i));
+  SnapshotHistory history;
+  history.capture(players);
+  const StateUpdate room = history.diff(0);
+
+  MessageQueue queue;
+  volatile size_t sink = 0;
+
+  std::vector<std::pair<const char *, Result>> results;
+
+  results.emplace_back("chat construct", measure(iterations, [&] {
+                         Packet packet(MessageType::CHAT_MESSAGE, chat);
+                         sink = sink + packet.getTotalSize();
+                       }));
+  results.emplace_back("state construct", measure(iterations, [&] {
+                         Packet packet(MessageType::GAME_STATE_UPDATE, state);
+                         sink = sink + packet.getTotalSize();
+                       }));
+  results.emplace_back("chat copy", measure(iterations, [&] {
+                         Packet packet(chatPacket);
+                         sink = sink + packet.getTotalSize();
+                       }));
+  results.emplace_back("state move", measure(iterations, [&] {
+                         Packet packet(statePacket);
+                         Packet moved(std::move(packet));
+                         sink = sink + moved.getTotalSize();
+                       }));
+  results.emplace_back("chat view->queue", measure(iterations, [&] {
+                         PacketView view;
+                         PacketView::frame(chatFrame.data(), chatFrame.size(),
+                                           view);
+                         queue.push(view.toPacket());
+                         Packet packet;
+                         queue.tryPop(packet);
+                         sink = sink + packet.getTotalSize();
+                       }));
+  results.emplace_back("state view->queue", measure(iterations, [&] {
+                         PacketView view;
+                         PacketView::frame(stateFrame.data(),
+                                           stateFrame.size(), view);
+                         queue.push(view.toPacket());
+                         Packet packet;
+                         queue.tryPop(packet);
+                         sink = sink + packet.getTotalSize();
+                       }));
+  results.emplace_back("chat toWire", measure(iterations, [&] {
+                         WireBuffer wire = chatPacket.toWire();
+                         sink = sink + wire->size();
+                       }));
+  results.emplace_back("state toWire", measure(iterations, [&] {
+                         WireBuffer wire = statePacket.toWire();
+                         sink = sink + wire->size();
+                       }));
+  results.emplace_back("room update Packet", measure(iterations, [&] {
+                         WireBuffer wire =
+                             createGameStateUpdatePacket(room).toWire();
+                         sink = sink + wire->size();
+                       }));
+  results.emplace_back("room update writer", measure(iterations, [&] {
+                         WireBuffer wire = encodeGameStateUpdate(room);
+                         sink = sink + wire->size();
+                       }));
+
+  std::cout << iterations << " iterations per row" << std::endl;
+  std::cout << std::left << std::setw(20) << "operation" << std::right
+            << std::setw(14) << "allocs/op" << std::setw(12) << "ns/op"
+            << std::endl;
+  for (const auto &[name, result] : results) {
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(2)
+              << result.allocsPerOp << std::setw(12) << std::setprecision(1)
+              << result.nsPerOp << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,323 @@
+#include "common/packet.h"
+#include "common/receive_buffer.h"
+#include "server/game_room.h"
+#include "server/matchmaker.h"
+#include "server/room_manager.h"
+#include "server/server.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Fills thousands of rooms in one game server process.
+//
+// Usage: room_load_bench [rooms] [players per room] [workers] [match wait ms]
+//
+// Forks a game server process (Server + RoomManager), connects rooms *
+// players raw client sockets to it, sends PLAYER_JOIN from each, and waits
+// until every client has its ROLE_ASSIGNMENT (every room's round started).
+// Then every client votes and the bench waits for every VOTE_RESULT. The
+// server runs in its own process so each side gets the full descriptor
+// limit and the memory figure covers the server alone. Passing a match
+// wait routes joins through a Matchmaker targeting full rooms; either way
+// the p50/p99 time from PLAYER_JOIN to ROLE_ASSIGNMENT is reported.
+
+using namespace net;
+
+namespace {
+
+constexpr uint16_t PORT = 18200;
+
+size_t rolesSeen = 0;
+size_t resultsSeen = 0;
+
+struct Bot {
+  int fd = -1;
+  ReceiveBuffer buffer;
+  bool hasRole = false;
+  bool hasResult = false;
+  std::chrono::steady_clock::time_point joined;
+  double roleMs = 0;
+};
+
+std::vector<Bot> connectBots(size_t count) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(PORT);
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+  std::vector<Bot> bots(count);
+  for (size_t i = 0; i < count; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1 || connect(fd, (sockaddr *)&address, sizeof(address)) == -1) {
+      std::cerr << "connect failed after " << i << " clients: " << errno
+                << std::endl;
+      if (fd != -1)
+        close(fd);
+      bots.resize(i);
+      break;
+    }
+    bots[i].fd = fd;
+  }
+  return bots;
+}
+
+bool sendAll(int fd, const std::vector<uint8_t> &bytes) {
+  size_t sent = 0;
+  while (sent < bytes.size()) {
+    ssize_t n = send(fd, bytes.data() + sent, bytes.size() - sent, 0);
+    if (n <= 0)
+      return false;
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Reads every bot's socket until `done` says the phase is complete or
+// nothing arrives for a few seconds.
+template <typename Done>
+bool pump(int epollFd, std::vector<Bot> &bots, Done &&done) {
+  std::vector<epoll_event> events(512);
+  while (!done()) {
+    int count = epoll_wait(epollFd, events.data(),
+                           static_cast<int>(events.size()), 5000);
+    if (count <= 0)
+      return false;
+    for (int i = 0; i < count; ++i) {
+      Bot &bot = bots[events[i].data.u32];
+      for (;;) {
+        uint8_t *tail = bot.buffer.prepare(4096);
+        ssize_t bytes = recv(bot.fd, tail, bot.buffer.writable(), MSG_DONTWAIT);
+        if (bytes <= 0)
+          break;
+        bot.buffer.commit(static_cast<size_t>(bytes));
+      }
+
+      PacketView view;
+      while (PacketView::frame(bot.buffer.data(), bot.buffer.size(), view) ==
+             FrameResult::COMPLETE) {
+        if (view.getType() == MessageType::ROLE_ASSIGNMENT && !bot.hasRole) {
+          bot.hasRole = true;
+          bot.roleMs = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - bot.joined)
+                           .count();
+          ++rolesSeen;
+        } else if (view.getType() == MessageType::VOTE_RESULT &&
+                   !bot.hasResult) {
+          bot.hasResult = true;
+          ++resultsSeen;
+        }
+        bot.buffer.consume(view.getTotalSize());
+      }
+    }
+  }
+  return true;
+}
+
+size_t residentKilobytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0)
+      return std::strtoul(line.c_str() + 6, nullptr, 10);
+  }
+  return 0;
+}
+
+struct ServerStats {
+  size_t rooms;
+  size_t seated;
+  size_t residentKilobytes;
+};
+
+// Runs the game server until the control pipe closes. Each byte read from
+// it is answered with a ServerStats snapshot on the report pipe.
+void runServer(int controlFd, int reportFd, size_t maxRooms, size_t roomSize,
+               size_t workers, long matchWaitMs) {
+  // The game logs every join and round; keep it off the measurement.
+  std::cout.rdbuf(nullptr);
+  std::cerr.rdbuf(nullptr);
+
+  Server server(PORT);
+  RoomManager rooms(server, workers, std::chrono::milliseconds(50), roomSize,
+                    maxRooms);
+  MatchmakingConfig config;
+  config.maxPlayers = roomSize;
+  config.targetPlayers = roomSize;
+  config.maxWait = std::chrono::milliseconds(std::max(matchWaitMs, 0L));
+  Matchmaker matchmaker(config,
+                        [&rooms](const std::vector<Matchmaker::Ticket> &group) {
+                          return rooms.seatGroup(group);
+                        });
+  if (matchWaitMs >= 0) {
+    rooms.setMatchmaker(&matchmaker);
+    matchmaker.start();
+  }
+  server.setPacketViewCallback([&](const PacketView &packet, uint32_t id) {
+    GameCommand command;
+    if (GameCommand::decode(packet, id, command))
+      rooms.submit(std::move(command));
+  });
+  rooms.start();
+  std::thread serverThread([&server] { server.start(); });
+  while (!server.isRunning())
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  ServerStats stats{0, 0, residentKilobytes()};
+  char request;
+  while (write(reportFd, &stats, sizeof(stats)) == sizeof(stats) &&
+         read(controlFd, &request, 1) == 1) {
+    stats = {rooms.getRoomCount(), rooms.getSeatedCount(),
+             residentKilobytes()};
+  }
+
+  server.stop();
+  serverThread.join();
+  matchmaker.stop();
+  rooms.stop();
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t roomTarget = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+  size_t roomSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+  size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+  long matchWaitMs = argc > 4 ? std::strtol(argv[4], nullptr, 10) : -1;
+  size_t botCount = roomTarget * roomSize;
+
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  int control[2];
+  int report[2];
+  if (pipe(control) != 0 || pipe(report) != 0) {
+    std::cerr << "pipe failed" << std::endl;
+    return 1;
+  }
+
+  pid_t child = fork();
+  if (child == -1) {
+    std::cerr << "fork failed" << std::endl;
+    return 1;
+  }
+  if (child == 0) {
+    close(control[1]);
+    close(report[0]);
+    runServer(control[0], report[1], roomTarget, roomSize, workers,
+              matchWaitMs);
+    _exit(0);
+  }
+  close(control[0]);
+  close(report[1]);
+
+  auto query = [&](bool ask) {
+    ServerStats stats{};
+    char request = 's';
+    if (ask && write(control[1], &request, 1) != 1)
+      return stats;
+    if (read(report[0], &stats, sizeof(stats)) != sizeof(stats))
+      std::cerr << "server process did not report" << std::endl;
+    return stats;
+  };
+
+  ServerStats idle = query(false);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Bot> bots = connectBots(botCount);
+  double connectSeconds = secondsSince(start);
+
+  int epollFd = epoll_create1(0);
+  for (size_t i = 0; i < bots.size(); ++i) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u32 = static_cast<uint32_t>(i);
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, bots[i].fd, &event);
+  }
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < bots.size(); ++i) {
+    bots[i].joined = std::chrono::steady_clock::now();
+    sendAll(bots[i].fd,
+            Packet(MessageType::PLAYER_JOIN, "bot" + std::to_string(i))
+                .serialize());
+  }
+  bool joined =
+      pump(epollFd, bots, [&] { return rolesSeen == bots.size(); });
+  double joinSeconds = secondsSince(start);
+  ServerStats full = query(true);
+
+  // Everyone votes for themselves: no majority, but every room completes.
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < bots.size(); ++i)
+    sendAll(bots[i].fd,
+            Packet(MessageType::CHAT_MESSAGE, "/vote bot" + std::to_string(i))
+                .serialize());
+  bool voted =
+      pump(epollFd, bots, [&] { return resultsSeen == bots.size(); });
+  double voteSeconds = secondsSince(start);
+
+  close(epollFd);
+  for (Bot &bot : bots)
+    close(bot.fd);
+  close(control[1]);
+  waitpid(child, nullptr, 0);
+
+  std::vector<double> roleMs;
+  for (const Bot &bot : bots) {
+    if (bot.hasRole)
+      roleMs.push_back(bot.roleMs);
+  }
+  std::sort(roleMs.begin(), roleMs.end());
+
+  std::cout << full.rooms << " rooms x " << roomSize << " players ("
+            << full.seated << " seated of " << bots.size() << " clients)";
+  if (matchWaitMs >= 0)
+    std::cout << ", matchmaking wait " << matchWaitMs << " ms";
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(24) << "phase" << std::right
+            << std::setw(12) << "seconds" << std::setw(16) << "complete"
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::left << std::setw(24) << "connect" << std::right
+            << std::setw(12) << connectSeconds << std::setw(16) << bots.size()
+            << std::endl;
+  std::cout << std::left << std::setw(24) << "join -> all rounds live"
+            << std::right << std::setw(12) << joinSeconds << std::setw(16)
+            << rolesSeen << (joined ? "" : " (timed out)") << std::endl;
+  std::cout << std::left << std::setw(24) << "vote -> all results"
+            << std::right << std::setw(12) << voteSeconds << std::setw(16)
+            << resultsSeen << (voted ? "" : " (timed out)") << std::endl;
+  if (!roleMs.empty()) {
+    std::cout << std::setprecision(1) << "join -> round start: p50 "
+              << roleMs[roleMs.size() / 2] << " ms, p99 "
+              << roleMs[roleMs.size() * 99 / 100] << " ms" << std::endl;
+  }
+  if (full.rooms > 0 && full.residentKilobytes > idle.residentKilobytes) {
+    size_t grown = full.residentKilobytes - idle.residentKilobytes;
+    std::cout << "server resident memory: +" << grown / 1024 << " MiB, "
+              << grown * 1024 / full.rooms
+              << " bytes per room including its connections" << std::endl;
+  }
+  return joined && voted ? 0 : 1;
+}
@@ -0,0 +1,742 @@
+#include "common/serialization.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compact tagged encoding versus the previous fixed-width serializers.
+//
+// Usage: serialization_bench [iterations]
+//
+// For each game message, builds a packet from a representative value
+// (create*Packet) and extracts it again (extract*) `iterations` times, with
+// the previous functions (kept below as they were before the wire codec)
+// and the current ones. Prints payload bytes and ns per encode / decode.
+// GAME_STATE_UPDATE and VoteResult carry a full room of six; the current
+// GAME_STATE_UPDATE is a full snapshot applied to a SnapshotTracker.
+//
+// A second table compares a full GAME_STATE_UPDATE with the delta a client
+// holding the previous snapshot receives, for common room changes and for
+// one score change in rooms of growing size. A third shows the chat bytes
+// one client receives with usernames sent once and referenced by id.
+// Decoding resolves interned strings through a StringDictionary, as the
+// game client does.
+
+using namespace net;
+
+namespace legacy {
+
+std::vector<uint8_t> serializePlayerState(const PlayerState &state) {
+  std::vector<uint8_t> data;
+
+  size_t usernameSize = state.username.size();
+  data.reserve(sizeof(uint32_t) * 4 + usernameSize);
+
+  uint32_t idBE = htonl(state.id);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&idBE),
+              reinterpret_cast<const uint8_t *>(&idBE) + sizeof(uint32_t));
+
+  uint32_t roleBE = htonl(static_cast<uint32_t>(state.role));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&roleBE),
+              reinterpret_cast<const uint8_t *>(&roleBE) + sizeof(uint32_t));
+
+  uint32_t scoreBE = htonl(static_cast<uint32_t>(state.score));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&scoreBE),
+              reinterpret_cast<const uint8_t *>(&scoreBE) + sizeof(uint32_t));
+
+  uint32_t usernameLenBE = htonl(static_cast<uint32_t>(usernameSize));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&usernameLenBE),
+              reinterpret_cast<const uint8_t *>(&usernameLenBE) +
+                  sizeof(uint32_t));
+
+  if (usernameSize > 0)
+    data.insert(data.end(), state.username.str().begin(), state.username.str().end());
+
+  return data;
+}
+
+PlayerState deserializePlayerState(const uint8_t *data, size_t size) {
+  PlayerState state;
+
+  if (size < sizeof(uint32_t) * 4)
+    return state;
+
+  size_t offset = 0;
+
+  uint32_t idBE;
+  std::memcpy(&idBE, data + offset, sizeof(uint32_t));
+  state.id = ntohl(idBE);
+  offset += sizeof(uint32_t);
+
+  uint32_t roleBE;
+  std::memcpy(&roleBE, data + offset, sizeof(uint32_t));
+  state.role = static_cast<PlayerRole>(ntohl(roleBE));
+  offset += sizeof(uint32_t);
+
+  uint32_t scoreBE;
+  std::memcpy(&scoreBE, data + offset, sizeof(uint32_t));
+  state.score = static_cast<int>(ntohl(scoreBE));
+  offset += sizeof(uint32_t);
+
+  if (size < offset + sizeof(uint32_t))
+    return state;
+
+  uint32_t usernameLenBE;
+  std::memcpy(&usernameLenBE, data + offset, sizeof(uint32_t));
+  size_t usernameLen = ntohl(usernameLenBE);
+  offset += sizeof(uint32_t);
+
+  if (size >= offset + usernameLen && usernameLen > 0)
+    state.username =
+        std::string(reinterpret_cast<const char *>(data + offset), usernameLen);
+
+  return state;
+}
+
+Packet createPlayerStatePacket(uint16_t type, const PlayerState &state) {
+  auto data = legacy::serializePlayerState(state);
+  return Packet(type, data);
+}
+
+Packet createGameStateUpdatePacket(const std::vector<PlayerState> &states) {
+  std::vector<uint8_t> data;
+
+  uint32_t count = static_cast<uint32_t>(states.size());
+  uint32_t countBE = htonl(count);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&countBE),
+              reinterpret_cast<const uint8_t *>(&countBE) + sizeof(uint32_t));
+
+  for (const auto &state : states) {
+    auto stateData = legacy::serializePlayerState(state);
+    data.insert(data.end(), stateData.begin(), stateData.end());
+  }
+
+  return Packet(MessageType::GAME_STATE_UPDATE, data);
+}
+
+PlayerState extractPlayerState(const Packet &packet) {
+  return legacy::deserializePlayerState(packet.getData().data(),
+                                packet.getData().size());
+}
+
+std::vector<PlayerState> extractGameStateUpdate(const Packet &packet) {
+  std::vector<PlayerState> states;
+  const auto &data = packet.getData();
+
+  if (data.size() < sizeof(uint32_t))
+    return states;
+
+  uint32_t countBE;
+  std::memcpy(&countBE, data.data(), sizeof(uint32_t));
+  uint32_t count = ntohl(countBE);
+  size_t offset = sizeof(uint32_t);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    if (data.size() < offset + sizeof(uint32_t) * 4)
+      break;
+
+    uint32_t usernameLenBE;
+    if (data.size() < offset + sizeof(uint32_t) * 4)
+      break;
+    std::memcpy(&usernameLenBE, data.data() + offset + sizeof(uint32_t) * 3,
+                sizeof(uint32_t));
+    uint32_t usernameLen = ntohl(usernameLenBE);
+
+    size_t playerSize = sizeof(uint32_t) * 4 + usernameLen;
+    if (data.size() < offset + playerSize)
+      break;
+
+    PlayerState state =
+        deserializePlayerState(data.data() + offset, playerSize);
+    states.push_back(state);
+    offset += playerSize;
+  }
+
+  return states;
+}
+
+std::vector<uint8_t> serializeChatMessage(const ChatMessage &message) {
+  std::vector<uint8_t> data;
+
+  size_t usernameSize = message.senderUsername.size();
+  size_t messageSize = message.senderMessage.size();
+  data.reserve(sizeof(uint32_t) * 3 + usernameSize + messageSize);
+
+  uint32_t senderIdBE = htonl(message.senderId);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&senderIdBE),
+              reinterpret_cast<const uint8_t *>(&senderIdBE) +
+                  sizeof(uint32_t));
+
+  uint32_t usernameLenBE = htonl(static_cast<uint32_t>(usernameSize));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&usernameLenBE),
+              reinterpret_cast<const uint8_t *>(&usernameLenBE) +
+                  sizeof(uint32_t));
+
+  if (usernameSize > 0)
+    data.insert(data.end(), message.senderUsername.str().begin(),
+                message.senderUsername.str().end());
+
+  uint32_t messageLenBE = htonl(static_cast<uint32_t>(messageSize));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&messageLenBE),
+              reinterpret_cast<const uint8_t *>(&messageLenBE) +
+                  sizeof(uint32_t));
+
+  if (messageSize > 0)
+    data.insert(data.end(), message.senderMessage.begin(),
+                message.senderMessage.end());
+
+  return data;
+}
+
+ChatMessage deserializeChatMessage(const uint8_t *data, size_t size) {
+  ChatMessage message;
+
+  if (size < sizeof(uint32_t) * 3)
+    return message;
+
+  size_t offset = 0;
+
+  uint32_t senderIdBE;
+  std::memcpy(&senderIdBE, data + offset, sizeof(uint32_t));
+  message.senderId = ntohl(senderIdBE);
+  offset += sizeof(uint32_t);
+
+  uint32_t usernameLenBE;
+  std::memcpy(&usernameLenBE, data + offset, sizeof(uint32_t));
+  size_t usernameLen = ntohl(usernameLenBE);
+  offset += sizeof(uint32_t);
+
+  if (usernameLen > 0 && offset + usernameLen <= size) {
+    message.senderUsername =
+        std::string(reinterpret_cast<const char *>(data + offset), usernameLen);
+    offset += usernameLen;
+  }
+
+  if (offset + sizeof(uint32_t) > size)
+    return message;
+  uint32_t messageLenBE;
+  std::memcpy(&messageLenBE, data + offset, sizeof(uint32_t));
+  size_t messageLen = ntohl(messageLenBE);
+  offset += sizeof(uint32_t);
+
+  if (messageLen > 0 && offset + messageLen <= size)
+    message.senderMessage.assign(reinterpret_cast<const char *>(data + offset),
+                                 messageLen);
+
+  return message;
+}
+
+Packet createChatMessagePacket(const ChatMessage &message) {
+  auto data = legacy::serializeChatMessage(message);
+  return Packet(MessageType::CHAT_BROADCAST, data);
+}
+
+ChatMessage extractChatMessage(const Packet &packet) {
+  return legacy::deserializeChatMessage(packet.getData().data(),
+                                packet.getData().size());
+}
+
+std::vector<uint8_t> serializeRoleAssignment(const RoleAssignment &assignment) {
+  std::vector<uint8_t> data;
+
+  size_t topicSize = assignment.topic.size();
+  size_t wordSize = assignment.secretWord.size();
+  data.reserve(sizeof(uint32_t) * 5 + topicSize + wordSize);
+
+  uint32_t playerIdBE = htonl(assignment.playerId);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&playerIdBE),
+              reinterpret_cast<const uint8_t *>(&playerIdBE) +
+                  sizeof(uint32_t));
+
+  uint32_t roleBE = htonl(static_cast<uint32_t>(assignment.role));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&roleBE),
+              reinterpret_cast<const uint8_t *>(&roleBE) + sizeof(uint32_t));
+
+  uint32_t topicLenBE = htonl(static_cast<uint32_t>(topicSize));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&topicLenBE),
+              reinterpret_cast<const uint8_t *>(&topicLenBE) +
+                  sizeof(uint32_t));
+
+  if (topicSize > 0)
+    data.insert(data.end(), assignment.topic.str().begin(), assignment.topic.str().end());
+
+  uint32_t wordLenBE = htonl(static_cast<uint32_t>(wordSize));
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&wordLenBE),
+              reinterpret_cast<const uint8_t *>(&wordLenBE) + sizeof(uint32_t));
+
+  if (wordSize > 0)
+    data.insert(data.end(), assignment.secretWord.str().begin(),
+                assignment.secretWord.str().end());
+
+  return data;
+}
+
+RoleAssignment deserializeRoleAssignment(const uint8_t *data, size_t size) {
+  RoleAssignment assignment;
+
+  if (size < sizeof(uint32_t) * 3)
+    return assignment;
+
+  size_t offset = 0;
+
+  uint32_t playerIdBE;
+  std::memcpy(&playerIdBE, data + offset, sizeof(uint32_t));
+  assignment.playerId = ntohl(playerIdBE);
+  offset += sizeof(uint32_t);
+
+  uint32_t roleBE;
+  std::memcpy(&roleBE, data + offset, sizeof(uint32_t));
+  assignment.role = static_cast<PlayerRole>(ntohl(roleBE));
+  offset += sizeof(uint32_t);
+
+  if (size < offset + sizeof(uint32_t))
+    return assignment;
+
+  uint32_t topicLenBE;
+  std::memcpy(&topicLenBE, data + offset, sizeof(uint32_t));
+  size_t topicLen = ntohl(topicLenBE);
+  offset += sizeof(uint32_t);
+
+  if (topicLen > 0 && offset + topicLen <= size) {
+    assignment.topic =
+        std::string(reinterpret_cast<const char *>(data + offset), topicLen);
+    offset += topicLen;
+  }
+
+  if (offset + sizeof(uint32_t) > size)
+    return assignment;
+
+  uint32_t wordLenBE;
+  std::memcpy(&wordLenBE, data + offset, sizeof(uint32_t));
+  size_t wordLen = ntohl(wordLenBE);
+  offset += sizeof(uint32_t);
+
+  if (wordLen > 0 && offset + wordLen <= size) {
+    assignment.secretWord =
+        std::string(reinterpret_cast<const char *>(data + offset), wordLen);
+  }
+
+  return assignment;
+}
+
+Packet createRoleAssignmentPacket(const RoleAssignment &assignment) {
+  auto data = legacy::serializeRoleAssignment(assignment);
+  return Packet(MessageType::ROLE_ASSIGNMENT, data);
+}
+
+RoleAssignment extractRoleAssignment(const Packet &packet) {
+  return legacy::deserializeRoleAssignment(packet.getData().data(),
+                                   packet.getData().size());
+}
+
+std::vector<uint8_t> serializeVoteCommand(const VoteCommand &vote) {
+  std::vector<uint8_t> data;
+  data.reserve(sizeof(uint32_t) * 2);
+
+  uint32_t voterBE = htonl(vote.voterId);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&voterBE),
+              reinterpret_cast<const uint8_t *>(&voterBE) + sizeof(uint32_t));
+
+  uint32_t targetBE = htonl(vote.targetId);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&targetBE),
+              reinterpret_cast<const uint8_t *>(&targetBE) + sizeof(uint32_t));
+
+  return data;
+}
+
+VoteCommand deserializeVoteCommand(const uint8_t *data, size_t size) {
+  VoteCommand vote;
+
+  if (size < sizeof(uint32_t) * 2)
+    return vote;
+
+  uint32_t voterBE;
+  std::memcpy(&voterBE, data, sizeof(uint32_t));
+  vote.voterId = ntohl(voterBE);
+
+  uint32_t targetBE;
+  std::memcpy(&targetBE, data + sizeof(uint32_t), sizeof(uint32_t));
+  vote.targetId = ntohl(targetBE);
+
+  return vote;
+}
+
+Packet createVoteCommandPacket(const VoteCommand &vote) {
+  auto data = legacy::serializeVoteCommand(vote);
+  return Packet(MessageType::VOTE_COMMAND, data);
+}
+
+VoteCommand extractVoteCommand(const Packet &packet) {
+  return legacy::deserializeVoteCommand(packet.getData().data(),
+                                packet.getData().size());
+}
+
+std::vector<uint8_t> serializeVoteResult(const VoteResult &result) {
+  std::vector<uint8_t> data;
+
+  uint32_t count = static_cast<uint32_t>(result.tally.size());
+  data.reserve(sizeof(uint32_t) * (3 + count * 2));
+
+  uint32_t countBE = htonl(count);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&countBE),
+              reinterpret_cast<const uint8_t *>(&countBE) + sizeof(uint32_t));
+
+  for (const auto &[targetId, voteCount] : result.tally) {
+    uint32_t targetBE = htonl(targetId);
+    data.insert(data.end(), reinterpret_cast<const uint8_t *>(&targetBE),
+                reinterpret_cast<const uint8_t *>(&targetBE) +
+                    sizeof(uint32_t));
+
+    uint32_t votesBE = htonl(voteCount);
+    data.insert(data.end(), reinterpret_cast<const uint8_t *>(&votesBE),
+                reinterpret_cast<const uint8_t *>(&votesBE) + sizeof(uint32_t));
+  }
+
+  uint32_t winnerBE = htonl(result.winnerId);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&winnerBE),
+              reinterpret_cast<const uint8_t *>(&winnerBE) + sizeof(uint32_t));
+
+  uint32_t caughtBE = htonl(result.liarCaught ? 1 : 0);
+  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&caughtBE),
+              reinterpret_cast<const uint8_t *>(&caughtBE) + sizeof(uint32_t));
+
+  return data;
+}
+
+VoteResult deserializeVoteResult(const uint8_t *data, size_t size) {
+  VoteResult result;
+
+  if (size < sizeof(uint32_t) * 3)
+    return result;
+
+  size_t offset = 0;
+
+  uint32_t countBE;
+  std::memcpy(&countBE, data + offset, sizeof(uint32_t));
+  uint32_t count = ntohl(countBE);
+  offset += sizeof(uint32_t);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    if (size < offset + sizeof(uint32_t) * 2)
+      break;
+
+    uint32_t targetBE;
+    std::memcpy(&targetBE, data + offset, sizeof(uint32_t));
+    uint32_t targetId = ntohl(targetBE);
+    offset += sizeof(uint32_t);
+
+    uint32_t votesBE;
+    std::memcpy(&votesBE, data + offset, sizeof(uint32_t));
+    uint32_t voteCount = ntohl(votesBE);
+    offset += sizeof(uint32_t);
+
+    result.tally[targetId] = voteCount;
+  }
+
+  if (size < offset + sizeof(uint32_t) * 2)
+    return result;
+
+  uint32_t winnerBE;
+  std::memcpy(&winnerBE, data + offset, sizeof(uint32_t));
+  result.winnerId = ntohl(winnerBE);
+  offset += sizeof(uint32_t);
+
+  uint32_t caughtBE;
+  std::memcpy(&caughtBE, data + offset, sizeof(uint32_t));
+  result.liarCaught = (ntohl(caughtBE) != 0);
+
+  return result;
+}
+
+Packet createVoteResultPacket(const VoteResult &result) {
+  auto data = legacy::serializeVoteResult(result);
+  return Packet(MessageType::VOTE_RESULT, data);
+}
+
+VoteResult extractVoteResult(const Packet &packet) {
+  return legacy::deserializeVoteResult(packet.getData().data(),
+                               packet.getData().size());
+}
+
+} // namespace legacy
+
+namespace {
+
+volatile size_t sink;
+
+// Folds a decoded message into the sink so decoding cannot be elided.
+size_t weigh(const PlayerState &state) {
+  return state.id + state.username.size() + static_cast<size_t>(state.role);
+}
+size_t weigh(const std::vector<PlayerState> &states) {
+  size_t weight = states.size();
+  for (const auto &state : states)
+    weight += weigh(state);
+  return weight;
+}
+size_t weigh(const ChatMessage &message) {
+  return message.senderId + message.senderMessage.size();
+}
+size_t weigh(const RoleAssignment &assignment) {
+  return assignment.playerId + assignment.topic.size() +
+         assignment.secretWord.size();
+}
+size_t weigh(const VoteCommand &vote) { return vote.voterId + vote.targetId; }
+size_t weigh(const VoteResult &result) {
+  return result.tally.size() + result.winnerId;
+}
+
+template <typename F> double nanosPerOp(size_t iterations, F &&body) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    body();
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         static_cast<double>(iterations);
+}
+
+struct Row {
+  const char *name;
+  size_t legacyBytes;
+  size_t compactBytes;
+  double legacyEncode;
+  double compactEncode;
+  double legacyDecode;
+  double compactDecode;
+};
+
+// Times the packet-level functions the game uses: build the packet from a
+// value, and extract the value from a received packet. Calls go through
+// volatile pointers so the legacy copy in this file is not inlined and
+// hoisted out of the loop while the real one sits in another object file.
+template <typename T, typename Result>
+Row measure(const char *name, size_t iterations, const T &value,
+            Packet (*legacyCreate)(const T &),
+            Packet (*compactCreate)(const T &),
+            Result (*legacyExtract)(const Packet &),
+            Result (*compactExtract)(const Packet &)) {
+  Packet (*volatile create[2])(const T &) = {legacyCreate, compactCreate};
+  Result (*volatile extract[2])(const Packet &) = {legacyExtract,
+                                                   compactExtract};
+  Packet packets[2] = {create[0](value), create[1](value)};
+
+  double encode[2];
+  double decode[2];
+  for (size_t i = 0; i < 2; ++i) {
+    encode[i] = nanosPerOp(
+        iterations, [&] { sink = create[i](value).getData().size(); });
+    decode[i] = nanosPerOp(iterations,
+                           [&] { sink = weigh(extract[i](packets[i])); });
+  }
+  return Row{name,      packets[0].getData().size(),
+             packets[1].getData().size(),
+             encode[0], encode[1],
+             decode[0], decode[1]};
+}
+
+Packet legacyPlayerJoined(const PlayerState &state) {
+  return legacy::createPlayerStatePacket(MessageType::PLAYER_JOINED, state);
+}
+
+Packet playerJoined(const PlayerState &state) {
+  return createPlayerStatePacket(MessageType::PLAYER_JOINED, state);
+}
+
+// What a client has been sent by STRING_DEFINE: every string the sample
+// messages use, so decoding resolves names as the game client does.
+StringDictionary dictionary;
+
+void define(const InternedString &text) {
+  if (!text.empty())
+    dictionary.define(text.id(), text.str());
+}
+
+PlayerState extractPlayer(const Packet &packet) {
+  return extractPlayerState(packet, dictionary);
+}
+
+ChatMessage extractChat(const Packet &packet) {
+  return extractChatMessage(packet, dictionary);
+}
+
+RoleAssignment extractRole(const Packet &packet) {
+  return extractRoleAssignment(packet, dictionary);
+}
+
+Packet fullStateUpdate(const std::vector<PlayerState> &states) {
+  SnapshotHistory history;
+  history.capture(states);
+  return createGameStateUpdatePacket(history.diff(0));
+}
+
+std::vector<PlayerState> applyStateUpdate(const Packet &packet) {
+  SnapshotTracker tracker;
+  tracker.apply(extractGameStateUpdate(packet, dictionary));
+  return tracker.players();
+}
+
+std::vector<PlayerState> makeRoom(size_t size) {
+  std::vector<PlayerState> room;
+  for (uint32_t i = 0; i < size; ++i)
+    room.emplace_back(1040 + i, "player_" + std::to_string(i),
+                      i == 0 ? PlayerRole::LIAR : PlayerRole::GUESSER,
+                      static_cast<int>(i));
+  return room;
+}
+
+struct DeltaRow {
+  std::string name;
+  size_t fullBytes;
+  size_t deltaBytes;
+};
+
+// Bytes of a full update of `after`, and of the delta from `before`.
+DeltaRow deltaBytes(std::string name, const std::vector<PlayerState> &before,
+                    const std::vector<PlayerState> &after) {
+  SnapshotHistory history;
+  uint32_t baseline = history.capture(before);
+  history.capture(after);
+  return DeltaRow{std::move(name),
+                  createGameStateUpdatePacket(history.diff(0)).getData().size(),
+                  createGameStateUpdatePacket(history.diff(baseline))
+                      .getData()
+                      .size()};
+}
+
+void printDeltaTable() {
+  std::vector<DeltaRow> rows;
+  std::vector<PlayerState> room = makeRoom(6);
+
+  std::vector<PlayerState> scored = room;
+  scored[2].score += 1;
+  rows.push_back(deltaBytes("one score x6", room, scored));
+
+  std::vector<PlayerState> roundOver = room;
+  for (auto &player : roundOver)
+    player.role = PlayerRole::NONE;
+  roundOver[1].score += 1;
+  roundOver[3].score += 1;
+  rows.push_back(deltaBytes("round over x6", room, roundOver));
+
+  std::vector<PlayerState> joined = room;
+  joined.emplace_back(1046, "player_6");
+  rows.push_back(deltaBytes("join x6", room, joined));
+
+  std::vector<PlayerState> left = room;
+  left.erase(left.begin() + 4);
+  rows.push_back(deltaBytes("leave x6", room, left));
+
+  for (size_t size : {32, 128, 512}) {
+    std::vector<PlayerState> big = makeRoom(size);
+    std::vector<PlayerState> bigScored = big;
+    bigScored[size / 2].score += 1;
+    rows.push_back(
+        deltaBytes("one score x" + std::to_string(size), big, bigScored));
+  }
+
+  std::cout << std::endl << "GAME_STATE_UPDATE bytes" << std::endl;
+  std::cout << std::left << std::setw(22) << "change" << std::right
+            << std::setw(10) << "full" << std::setw(10) << "delta"
+            << std::endl;
+  for (const DeltaRow &row : rows) {
+    std::cout << std::left << std::setw(22) << row.name << std::right
+              << std::setw(10) << row.fullBytes << std::setw(10)
+              << row.deltaBytes << std::endl;
+  }
+}
+
+// Bytes one client receives for a stretch of chat from a six-player room:
+// the username in every message before interning, and afterwards its id
+// plus one STRING_DEFINE per name for the session.
+void printChatTable(const std::vector<PlayerState> &room) {
+  std::cout << std::endl << "chat received by one client" << std::endl;
+  std::cout << std::left << std::setw(22) << "messages" << std::right
+            << std::setw(10) << "previous" << std::setw(10) << "interned"
+            << std::endl;
+  for (size_t messages : {10, 100, 1000}) {
+    size_t previous = 0;
+    size_t interned = 0;
+    std::vector<StringDefinition> defined;
+    for (size_t i = 0; i < messages; ++i) {
+      const PlayerState &sender = room[i % room.size()];
+      ChatMessage chat(sender.id, sender.username, "any ideas? it's blue");
+      previous += legacy::createChatMessagePacket(chat).getTotalSize();
+      interned += createChatMessagePacket(chat).getTotalSize();
+      if (i < room.size())
+        defined.push_back(
+            StringDefinition{sender.username.id(), sender.username.str()});
+    }
+    interned += createStringDefinePacket(defined).getTotalSize();
+    std::cout << std::left << std::setw(22) << messages << std::right
+              << std::setw(10) << previous << std::setw(10) << interned
+              << std::endl;
+  }
+  std::cout << "username field in memory: " << sizeof(std::string)
+            << " bytes (std::string) -> " << sizeof(InternedString)
+            << " (InternedString)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  PlayerState player(1042, "player_one", PlayerRole::GUESSER, 3);
+  std::vector<PlayerState> room = makeRoom(6);
+  ChatMessage chat(1042, "player_one", "I think it's something you eat");
+  RoleAssignment role(1042, PlayerRole::GUESSER, "Food", "Pizza");
+  VoteCommand vote(1042, 1043);
+  VoteResult result;
+  for (uint32_t i = 0; i < 6; ++i)
+    result.tally[1040 + i] = i % 3;
+  result.winnerId = 1041;
+  result.liarCaught = true;
+
+  define(player.username);
+  for (const PlayerState &state : room)
+    define(state.username);
+  define(role.topic);
+  define(role.secretWord);
+
+  Row rows[] = {
+      measure("PlayerState", iterations, player, legacyPlayerJoined,
+              playerJoined, legacy::extractPlayerState, extractPlayer),
+      measure("GAME_STATE_UPDATE x6", iterations, room,
+              legacy::createGameStateUpdatePacket, fullStateUpdate,
+              legacy::extractGameStateUpdate, applyStateUpdate),
+      measure("ChatMessage", iterations, chat, legacy::createChatMessagePacket,
+              createChatMessagePacket, legacy::extractChatMessage,
+              extractChat),
+      measure("RoleAssignment", iterations, role,
+              legacy::createRoleAssignmentPacket, createRoleAssignmentPacket,
+              legacy::extractRoleAssignment, extractRole),
+      measure("VoteCommand", iterations, vote, legacy::createVoteCommandPacket,
+              createVoteCommandPacket, legacy::extractVoteCommand,
+              extractVoteCommand),
+      measure("VoteResult x6", iterations, result,
+              legacy::createVoteResultPacket, createVoteResultPacket,
+              legacy::extractVoteResult, extractVoteResult),
+  };
+
+  std::cout << iterations << " iterations; previous -> compact" << std::endl;
+  std::cout << std::left << std::setw(22) << "message" << std::right
+            << std::setw(14) << "bytes" << std::setw(20) << "encode ns"
+            << std::setw(20) << "decode ns" << std::endl;
+  std::cout << std::fixed << std::setprecision(0);
+  for (const Row &row : rows) {
+    std::cout << std::left << std::setw(22) << row.name << std::right
+              << std::setw(6) << row.legacyBytes << " -> " << std::setw(4)
+              << row.compactBytes << std::setw(10) << row.legacyEncode
+              << " -> " << std::setw(6) << row.compactEncode << std::setw(10)
+              << row.legacyDecode << " -> " << std::setw(6)
+              << row.compactDecode << std::endl;
+  }
+
+  printDeltaTable();
+  printChatTable(room);
+  return 0;
+}
@@ -0,0 +1,188 @@
+#include "server/timer_wheel.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+// Cost of keeping many idle/heartbeat deadlines armed.
+//
+// Usage: timer_wheel_bench [seconds]
+//
+// For each timer count, arms that many timers with deadlines spread over
+// 45 s (the default idle timeout) on a 50 ms tick, then measures:
+//   schedule  ns per schedule()
+//   cancel    ns per cancel(), for every other timer
+//   steady    ns per fired timer while simulated time runs for `seconds`
+//             and each callback re-arms itself, as checkIdle() does
+//   idle tick ns per advance() over a tick where nothing is due
+// "map" is the same workload on a std::multimap keyed by deadline, the
+// usual ordered-set alternative; "scan" is the per-tick cost of walking
+// every deadline, as a sweeper thread over the connection table would.
+
+using namespace net;
+using Clock = TimerWheel::Clock;
+
+namespace {
+
+constexpr std::chrono::milliseconds TICK(50);
+constexpr std::chrono::milliseconds SPREAD(45000);
+
+volatile size_t sink;
+
+double nanosSince(Clock::time_point start, size_t ops) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         static_cast<double>(ops ? ops : 1);
+}
+
+// Deadlines spread evenly over SPREAD, in an order that is not sorted.
+std::chrono::milliseconds delayFor(size_t i, size_t count) {
+  size_t step = (i * 2654435761u) % count;
+  return std::chrono::milliseconds(1 + SPREAD.count() * step / count);
+}
+
+// One pointer, so the callback fits std::function's inline storage the way
+// the server's [this, id] captures do.
+struct Renewing {
+  TimerWheel wheel;
+  size_t fired;
+};
+
+struct Renew {
+  Renewing *owner;
+  void operator()() const {
+    ++owner->fired;
+    owner->wheel.schedule(SPREAD, *this);
+  }
+};
+
+struct Row {
+  double schedule, cancel, steady, idleTick;
+};
+
+Row runWheel(size_t count, int seconds) {
+  Row row{};
+  auto base = Clock::now();
+  TimerWheel wheel(TICK, base);
+  std::vector<TimerWheel::TimerId> ids(count);
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < count; ++i)
+    ids[i] = wheel.schedule(delayFor(i, count), [] {});
+  row.schedule = nanosSince(start, count);
+
+  start = Clock::now();
+  for (size_t i = 0; i < count; i += 2)
+    wheel.cancel(ids[i]);
+  row.cancel = nanosSince(start, count / 2);
+
+  // Re-arm everything with self-renewing callbacks and let time run.
+  Renewing steady{TimerWheel(TICK, base), 0};
+  for (size_t i = 0; i < count; ++i)
+    steady.wheel.schedule(delayFor(i, count), Renew{&steady});
+  start = Clock::now();
+  for (auto now = base; now < base + std::chrono::seconds(seconds);
+       now += TICK)
+    steady.wheel.advance(now);
+  row.steady = nanosSince(start, steady.fired);
+
+  // A wheel whose timers are all far away: advancing is a bitmap check.
+  TimerWheel far(TICK, base);
+  for (size_t i = 0; i < count; ++i)
+    far.schedule(SPREAD + delayFor(i, count), [] {});
+  size_t ticks = 400;
+  start = Clock::now();
+  for (size_t t = 1; t <= ticks; ++t)
+    sink = far.advance(base + TICK * t);
+  row.idleTick = nanosSince(start, ticks);
+  return row;
+}
+
+Row runMap(size_t count, int seconds) {
+  Row row{};
+  auto base = Clock::now();
+  std::multimap<Clock::time_point, size_t> timers;
+  std::vector<std::multimap<Clock::time_point, size_t>::iterator> ids(count);
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < count; ++i)
+    ids[i] = timers.emplace(base + delayFor(i, count), i);
+  row.schedule = nanosSince(start, count);
+
+  start = Clock::now();
+  for (size_t i = 0; i < count; i += 2)
+    timers.erase(ids[i]);
+  row.cancel = nanosSince(start, count / 2);
+
+  timers.clear();
+  for (size_t i = 0; i < count; ++i)
+    timers.emplace(base + delayFor(i, count), i);
+  size_t fired = 0;
+  start = Clock::now();
+  for (auto now = base; now < base + std::chrono::seconds(seconds);
+       now += TICK) {
+    while (!timers.empty() && timers.begin()->first <= now) {
+      size_t id = timers.begin()->second;
+      timers.erase(timers.begin());
+      timers.emplace(now + SPREAD, id);
+      ++fired;
+    }
+  }
+  row.steady = nanosSince(start, fired);
+
+  size_t ticks = 400;
+  start = Clock::now();
+  for (size_t t = 1; t <= ticks; ++t)
+    sink = !timers.empty() && timers.begin()->first <= base;
+  row.idleTick = nanosSince(start, ticks);
+  return row;
+}
+
+double scanTick(size_t count) {
+  auto base = Clock::now();
+  std::vector<Clock::time_point> deadlines(count);
+  for (size_t i = 0; i < count; ++i)
+    deadlines[i] = base + SPREAD + delayFor(i, count);
+  size_t ticks = count >= 1000000 ? 20 : 200;
+  auto start = Clock::now();
+  for (size_t t = 1; t <= ticks; ++t) {
+    auto now = base + TICK * t;
+    size_t due = 0;
+    for (auto deadline : deadlines)
+      due += deadline <= now;
+    sink = due;
+  }
+  return nanosSince(start, ticks);
+}
+
+void printRow(const char *name, size_t count, const Row &row) {
+  std::cout << std::left << std::setw(8) << name << std::right
+            << std::setw(10) << count << std::setw(12) << row.schedule
+            << std::setw(12) << row.cancel << std::setw(12) << row.steady
+            << std::setw(14) << row.idleTick << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int seconds = argc > 1 ? std::atoi(argv[1]) : 120;
+
+  std::cout << TICK.count() << " ms tick, deadlines over " << SPREAD.count()
+            << " ms, " << seconds << " s simulated; ns per op" << std::endl;
+  std::cout << std::left << std::setw(8) << "impl" << std::right
+            << std::setw(10) << "timers" << std::setw(12) << "schedule"
+            << std::setw(12) << "cancel" << std::setw(12) << "steady"
+            << std::setw(14) << "idle tick" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+
+  for (size_t count : {1000, 100000, 1000000}) {
+    printRow("wheel", count, runWheel(count, seconds));
+    printRow("map", count, runMap(count, seconds));
+    std::cout << std::left << std::setw(8) << "scan" << std::right
+              << std::setw(10) << count << std::setw(50) << scanTick(count)
+              << std::endl;
+  }
+  return 0;
+}
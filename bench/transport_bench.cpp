@@ -0,0 +1,149 @@
+#include "client/client.h"
+#include "common/packet.h"
+#include "server/server.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Echo throughput of the Server backends on loopback.
+//
+// Usage: transport_bench [clients] [packets per client] [payload bytes]
+//
+// Every client keeps WINDOW packets in flight and the server echoes each one
+// back to its sender from the packet callback, so the numbers cover recv
+// framing, callback dispatch and sendPacket() for each backend. The
+// "no metrics" rows turn off ServerConfig::packetMetrics to show what the
+// per-type instrumentation costs; the table at the end is what it recorded.
+
+using namespace net;
+
+namespace {
+
+constexpr uint16_t BASE_PORT = 18000;
+constexpr size_t WINDOW = 16;
+
+struct Result {
+  double seconds;
+  size_t packets;
+  size_t bytes;
+};
+
+bool runClient(uint16_t port, size_t packets, size_t payloadSize) {
+  Client client;
+  if (!client.connect("127.0.0.1", port))
+    return false;
+
+  Packet request(MessageType::ECHO, std::string(payloadSize, 'x'));
+  Packet reply;
+  size_t sent = 0;
+  size_t received = 0;
+
+  while (received < packets) {
+    while (sent < packets && sent - received < WINDOW) {
+      if (!client.sendPacket(request))
+        return false;
+      ++sent;
+    }
+    if (!client.receivePacket(reply))
+      return false;
+    ++received;
+  }
+
+  client.disconnect();
+  return true;
+}
+
+Result runBackend(const ServerConfig &config, uint16_t port, size_t clients,
+                  size_t packets, size_t payloadSize) {
+  Server server(port, config);
+  server.setPacketCallback([&server](const Packet &packet, uint32_t clientId) {
+    if (packet.getType() == MessageType::ECHO)
+      server.sendPacket(clientId, packet);
+  });
+
+  std::thread serverThread([&server]() { server.start(); });
+  while (!server.isRunning())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < clients; ++i)
+    threads.emplace_back(runClient, port, packets, payloadSize);
+  for (auto &thread : threads)
+    thread.join();
+  auto end = std::chrono::steady_clock::now();
+
+  server.stop();
+  serverThread.join();
+
+  Result result;
+  result.seconds = std::chrono::duration<double>(end - begin).count();
+  result.packets = clients * packets;
+  result.bytes = result.packets * (PacketHeader::SIZE + payloadSize);
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t clients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+  size_t packets = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+  size_t payloadSize = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+
+  struct Variant {
+    const char *name;
+    ServerBackend backend;
+    bool reusePortShards;
+    bool packetMetrics;
+  };
+  std::vector<Variant> variants = {
+      {"thread-per-client", ServerBackend::THREAD_PER_CLIENT, false, true},
+#ifdef __linux__
+      {"epoll", ServerBackend::EPOLL, false, true},
+      {"epoll no metrics", ServerBackend::EPOLL, false, false},
+      {"epoll sharded", ServerBackend::EPOLL, true, true},
+      {"io_uring", ServerBackend::IO_URING, false, true},
+      {"io_uring no metrics", ServerBackend::IO_URING, false, false},
+      {"io_uring sharded", ServerBackend::IO_URING, true, true},
+#endif
+  };
+
+  // Keep the report readable: the servers log every connect/disconnect.
+  std::streambuf *coutBuffer = std::cout.rdbuf();
+
+  std::vector<std::pair<const char *, Result>> results;
+  uint16_t port = BASE_PORT;
+  for (const auto &variant : variants) {
+    ServerConfig config;
+    config.backend = variant.backend;
+    config.reusePortShards = variant.reusePortShards;
+    config.packetMetrics = variant.packetMetrics;
+
+    std::cout.rdbuf(nullptr);
+    Result result = runBackend(config, port++, clients, packets, payloadSize);
+    std::cout.rdbuf(coutBuffer);
+    results.emplace_back(variant.name, result);
+  }
+
+  std::cout << clients << " clients x " << packets << " echoes, "
+            << payloadSize << "-byte payload, window " << WINDOW << std::endl;
+  std::cout << std::left << std::setw(20) << "backend" << std::right
+            << std::setw(14) << "packets/s" << std::setw(12) << "MB/s"
+            << std::endl;
+  for (const auto &[name, result] : results) {
+    double rate = result.packets / result.seconds;
+    double megabytes = result.bytes / result.seconds / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(0) << rate
+              << std::setw(12) << std::setprecision(1) << megabytes
+              << std::endl;
+  }
+
+  std::cout << std::endl;
+  writePacketStats(std::cout, PacketMetrics::instance().snapshot());
+  return 0;
+}
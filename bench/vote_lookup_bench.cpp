@@ -0,0 +1,103 @@
+#include "common/game_state.h"
+#include "server/connection_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Vote target lookup by username as the player count grows.
+//
+// Usage: vote_lookup_bench [iterations]
+//
+// For each size, fills a GameState and a ConnectionManager with that many
+// named players and resolves `iterations` vote targets, cycling through the
+// names. "scan" is the previous path (copy every PlayerState, or walk every
+// connection, and compare names); "index" is findPlayerByUsername /
+// findConnectionByUsername.
+
+using namespace net;
+
+namespace {
+
+volatile uint32_t sink;
+
+template <typename F> double nanosPerOp(size_t iterations, F &&body) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i)
+    body(i);
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         static_cast<double>(iterations);
+}
+
+uint32_t scanPlayers(const GameState &state, std::string_view name) {
+  for (const auto &player : state.getAllPlayerStates()) {
+    if (player.username == name)
+      return player.id;
+  }
+  return 0;
+}
+
+uint32_t scanConnections(const ConnectionManager &connections,
+                         std::string_view name) {
+  uint32_t found = 0;
+  connections.forEachActive([&](const ConnectionInfo &info) {
+    if (found == 0 && info.username == name)
+      found = info.id;
+  });
+  return found;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+  std::cout << iterations << " lookups per row, ns/lookup" << std::endl;
+  std::cout << std::left << std::setw(10) << "players" << std::right
+            << std::setw(14) << "state scan" << std::setw(14) << "state index"
+            << std::setw(14) << "conn scan" << std::setw(14) << "conn index"
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+
+  for (size_t players : {6, 64, 512, 4096}) {
+    GameState state(true);
+    ConnectionManager connections;
+    std::vector<std::string> names;
+    for (uint32_t id = 1; id <= players; ++id) {
+      names.push_back("player_" + std::to_string(id));
+      state.addPlayer(id, names.back());
+      sockaddr_in address{};
+      connections.addConnection(id, INVALID_SOCKET, address);
+      connections.setStatus(id, ConnectionStatus::ACTIVE);
+      connections.setUsername(id, names.back());
+    }
+
+    // The scans are O(players); keep their total time bounded.
+    size_t scanIterations = std::max<size_t>(iterations * 6 / players, 100);
+
+    double stateScan = nanosPerOp(scanIterations, [&](size_t i) {
+      sink = scanPlayers(state, names[i % players]);
+    });
+    double stateIndex = nanosPerOp(iterations, [&](size_t i) {
+      sink = state.findPlayerByUsername(names[i % players]);
+    });
+    double connScan = nanosPerOp(scanIterations, [&](size_t i) {
+      sink = scanConnections(connections, names[i % players]);
+    });
+    double connIndex = nanosPerOp(iterations, [&](size_t i) {
+      auto info = connections.findConnectionByUsername(names[i % players]);
+      sink = info ? info->id : 0;
+    });
+
+    std::cout << std::left << std::setw(10) << players << std::right
+              << std::setw(14) << stateScan << std::setw(14) << stateIndex
+              << std::setw(14) << connScan << std::setw(14) << connIndex
+              << std::endl;
+  }
+  return 0;
+}
@@ -1,15 +1,13 @@
 #pragma once
 
 #include "common/packet.h"
+#include "common/platform.h"
+#include "common/receive_buffer.h"
 #include <atomic>
 #include <functional>
 #include <string>
 #include <thread>
 #include <vector>
-#include <winsock2.h>
-#include <ws2tcpip.h>
-
-#pragma comment(lib, "ws2_32.lib")
 
 namespace net {
 
@@ -28,10 +26,23 @@ public:
 
   bool sendPacket(const Packet &packet);
 
+  // Receive calls answer the server's HEARTBEAT pings themselves and never
+  // return them, so a client that keeps reading stays connected while idle.
   bool receivePacket(Packet &packet);
 
+  // Like receivePacket() but without copying the payload; the view stays
+  // valid until the next receive call on this client.
+  bool receivePacketView(PacketView &view);
+
   bool tryReceivePacket(Packet &packet);
 
+  // For callers that multiplex many clients on one thread: poll
+  // getSocket() for readability, call readAvailable() once, then drain
+  // with tryReceivePacket(). False once the server has closed the
+  // connection or the read failed.
+  SOCKET getSocket() const { return socket_; }
+  bool readAvailable();
+
   void setPacketCallback(PacketCallback callback);
 
   void startReceiving();
@@ -50,13 +61,17 @@ private:
 
   static constexpr size_t BUFFER_SIZE = 4096;
 
-  std::vector<uint8_t> packetBuffer_;
+  ReceiveBuffer receiveBuffer_;
+  // Size of the packet last handed out by receivePacketView().
+  size_t heldBytes_ = 0;
 
   bool initializeWinsock();
 
   void cleanupWinsock();
 
   void receivingThread();
+
+  void answerHeartbeat(const PacketView &view);
 };
 
 } // namespace net
\ No newline at end of file
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "common/random.h"
+#include "common/string_table.h"
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -13,25 +18,49 @@ enum class PlayerRole { NONE = 0, LIAR = 1, GUESSER = 2 };
 
 struct PlayerState {
   uint32_t id;
-  std::string username;
+  InternedString username;
   PlayerRole role;
   int score;
 
   PlayerState() : id(0), role(PlayerRole::NONE), score(0) {}
-  PlayerState(uint32_t id, const std::string &username,
+  PlayerState(uint32_t id, const InternedString &username,
               PlayerRole role = PlayerRole::NONE, int score = 0)
       : id(id), username(username), role(role), score(score) {}
 };
 
+// What submitVote did with a vote. ROUND_COMPLETE means it was counted
+// and every player has now voted.
+enum class VoteStatus { NO_ROUND, REJECTED, COUNTED, ROUND_COMPLETE };
+
+// Where the current round's vote stands. Kept up to date by submitVote and
+// removePlayer rather than recounted.
+struct VoteStanding {
+  uint32_t leaderId = 0; // first to reach the most votes; 0 before any
+  uint32_t leaderVotes = 0;
+  size_t votesCast = 0;
+  size_t playerCount = 0;
+};
+
 class GameState {
 public:
-  GameState();
+  // Pass synchronized = false when a single thread (a game loop) owns the
+  // state; every accessor then skips the mutex. Liar, topic and word are
+  // drawn from `random`; pass a seeded one to replay the same rounds.
+  explicit GameState(bool synchronized = true);
+  GameState(bool synchronized, const Random &random);
   ~GameState() = default;
 
   bool addPlayer(uint32_t id, const std::string &username = "");
 
   bool removePlayer(uint32_t id);
 
+  bool renamePlayer(uint32_t id, const std::string &username);
+
+  // The player with this username, or 0. Scans at most INLINE_PLAYERS
+  // names; bigger tables keep an index updated by add/remove/rename. With
+  // duplicate names, any one of them.
+  uint32_t findPlayerByUsername(std::string_view username) const;
+
   PlayerState getPlayerState(uint32_t id) const;
 
   bool hasPlayer(uint32_t id) const;
@@ -48,15 +77,16 @@ public:
   void startNewRound();
   void clearRound();
 
-  std::string getCurrentTopic() const;
-  std::string getCurrentWord() const;
+  InternedString getCurrentTopic() const;
+  InternedString getCurrentWord() const;
   uint32_t getCurrentLiarId() const;
   bool isRoundActive() const;
 
-  bool submitVote(uint32_t voterId, uint32_t targetId);
+  VoteStatus submitVote(uint32_t voterId, uint32_t targetId);
   bool hasPlayerVoted(uint32_t playerId) const;
   std::unordered_map<uint32_t, uint32_t>
   getVoteTally() const; // targetId -> vote count
+  VoteStanding getVoteStanding() const;
   void clearVotes();
 
   void calculateAndApplyScores(bool liarCaught, uint32_t votedOutId,
@@ -64,22 +94,100 @@ public:
   int getPlayerScore(uint32_t playerId) const;
   std::unordered_map<uint32_t, int> getAllScores() const;
 
+  // Players a table holds inline; a playable room never has more.
+  static constexpr size_t INLINE_PLAYERS = 6;
+
 private:
+  static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+  // Players in structure-of-arrays form: slot i of every column is one
+  // player, slots are dense, and removing a player moves the last one into
+  // its slot. voteFor is who the player voted for this round (0 if nobody
+  // yet) and votesAgainst the votes they have received.
+  struct InlinePlayers {
+    uint32_t ids[INLINE_PLAYERS];
+    uint32_t voteFor[INLINE_PLAYERS];
+    uint32_t votesAgainst[INLINE_PLAYERS];
+    int scores[INLINE_PLAYERS];
+    PlayerRole roles[INLINE_PLAYERS];
+    InternedString usernames[INLINE_PLAYERS];
+  };
+
+  // The same columns once a table outgrows INLINE_PLAYERS, with hash
+  // indexes in place of scans. byUsername keys view the interned names.
+  struct HeapPlayers {
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> voteFor;
+    std::vector<uint32_t> votesAgainst;
+    std::vector<int> scores;
+    std::vector<PlayerRole> roles;
+    std::vector<InternedString> usernames;
+    std::unordered_map<uint32_t, size_t> slotOf;
+    std::unordered_multimap<std::string_view, uint32_t> byUsername;
+  };
+
+  bool synchronized_;
   mutable std::mutex mutex_;
-  std::unordered_map<uint32_t, PlayerState> players_;
 
+  size_t count_ = 0;
+  size_t votesCast_ = 0;
+  uint32_t leaderId_ = 0;
+  uint32_t leaderVotes_ = 0;
+  InlinePlayers inline_;
+  std::unique_ptr<HeapPlayers> heap_;
+
+  Random random_;
   bool roundActive_;
-  std::string currentTopic_;
-  std::string currentWord_;
+  InternedString currentTopic_;
+  InternedString currentWord_;
   uint32_t currentLiarId_;
 
-  // voterId -> targetId
-  std::unordered_map<uint32_t, uint32_t> votes_;
-
-  static const std::vector<std::pair<std::string, std::vector<std::string>>>
+  static const std::vector<
+      std::pair<InternedString, std::vector<InternedString>>>
       TOPIC_WORDS;
 
-  std::pair<std::string, std::string> pickRandomTopicAndWord() const;
+  std::unique_lock<std::mutex> acquire() const;
+  void resetRound();
+  void resetVotes();
+  void electLeader();
+
+  uint32_t *ids() { return heap_ ? heap_->ids.data() : inline_.ids; }
+  const uint32_t *ids() const {
+    return heap_ ? heap_->ids.data() : inline_.ids;
+  }
+  uint32_t *voteFor() {
+    return heap_ ? heap_->voteFor.data() : inline_.voteFor;
+  }
+  const uint32_t *voteFor() const {
+    return heap_ ? heap_->voteFor.data() : inline_.voteFor;
+  }
+  uint32_t *votesAgainst() {
+    return heap_ ? heap_->votesAgainst.data() : inline_.votesAgainst;
+  }
+  const uint32_t *votesAgainst() const {
+    return heap_ ? heap_->votesAgainst.data() : inline_.votesAgainst;
+  }
+  int *scores() { return heap_ ? heap_->scores.data() : inline_.scores; }
+  const int *scores() const {
+    return heap_ ? heap_->scores.data() : inline_.scores;
+  }
+  PlayerRole *roles() { return heap_ ? heap_->roles.data() : inline_.roles; }
+  const PlayerRole *roles() const {
+    return heap_ ? heap_->roles.data() : inline_.roles;
+  }
+  InternedString *usernames() {
+    return heap_ ? heap_->usernames.data() : inline_.usernames;
+  }
+  const InternedString *usernames() const {
+    return heap_ ? heap_->usernames.data() : inline_.usernames;
+  }
+
+  size_t findSlot(uint32_t id) const;
+  PlayerState stateAt(size_t slot) const;
+  void spillToHeap();
+  void removeSlot(size_t slot);
+
+  std::pair<InternedString, InternedString> pickRandomTopicAndWord();
 };
 
 } // namespace net
\ No newline at end of file
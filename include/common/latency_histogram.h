@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace net {
+
+// Log-linear latency histogram in the style of HdrHistogram: each power of
+// two is split into SUB_BUCKETS linear buckets, so a percentile read back is
+// within 1/SUB_BUCKETS of the recorded value from 1 ns to about a minute.
+struct LatencyHistogram {
+  static constexpr int SUB_BITS = 3;
+  static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+  // Longer latencies land in the last bucket.
+  static constexpr uint64_t MAX_NANOS = (uint64_t(1) << 36) - 1;
+  static constexpr size_t BUCKETS = (36 - SUB_BITS + 1) * SUB_BUCKETS;
+
+  std::array<uint64_t, BUCKETS> counts{};
+  uint64_t total = 0;
+  uint64_t sumNanos = 0;
+  uint64_t maxNanos = 0;
+
+  static size_t bucketFor(uint64_t nanos);
+  // Largest value that falls in bucket.
+  static uint64_t upperBound(size_t bucket);
+
+  // Upper bound of the bucket holding the q-quantile (0 <= q <= 1), capped
+  // at the largest value recorded; 0 when empty.
+  uint64_t percentile(double q) const;
+  double meanNanos() const;
+
+  void record(uint64_t nanos);
+  void merge(const LatencyHistogram &other);
+};
+
+} // namespace net
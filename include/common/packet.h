@@ -1,7 +1,10 @@
 #pragma once
 
+#include "common/payload.h"
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace MessageType {
@@ -23,11 +26,18 @@ constexpr uint16_t ROUND_START = 18;
 constexpr uint16_t ROLE_ASSIGNMENT = 19;
 constexpr uint16_t VOTE_COMMAND = 21;
 constexpr uint16_t VOTE_RESULT = 22;
+constexpr uint16_t STATE_ACK = 23;
+constexpr uint16_t STRING_DEFINE = 24;
 
 } // namespace MessageType
 
 namespace net {
 
+// An encoded packet, header included, immutable once built. Broadcasts
+// hand the same buffer to every recipient's send queue instead of
+// re-serializing per client. Built by Packet::toWire() or PacketWriter.
+using WireBuffer = std::shared_ptr<const Payload>;
+
 struct PacketHeader {
   uint32_t length;
   uint16_t type;
@@ -36,6 +46,10 @@ struct PacketHeader {
   PacketHeader(uint32_t len, uint16_t t) : length(len), type(t) {}
 
   static constexpr size_t SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+
+  // Largest length a peer may announce; anything above is a protocol error
+  // rather than a reason to buffer without bound.
+  static constexpr uint32_t MAX_LENGTH = 16 * 1024 * 1024;
 };
 
 class Packet {
@@ -43,9 +57,10 @@ public:
   Packet();
   Packet(uint16_t type, const std::vector<uint8_t> &data);
   Packet(uint16_t type, const std::string &data);
+  Packet(uint16_t type, const uint8_t *data, size_t size);
 
   uint16_t getType() const { return header_.type; }
-  const std::vector<uint8_t> &getData() const { return data_; }
+  const Payload &getData() const { return data_; }
   PacketHeader getHeader() const { return header_; }
   size_t getTotalSize() const { return PacketHeader::SIZE + data_.size(); }
 
@@ -55,6 +70,8 @@ public:
 
   std::vector<uint8_t> serialize() const;
 
+  WireBuffer toWire() const;
+
   static Packet deserialize(const std::vector<uint8_t> &buffer);
   static Packet deserialize(const uint8_t *buffer, size_t size);
 
@@ -62,9 +79,41 @@ public:
 
 private:
   PacketHeader header_;
-  std::vector<uint8_t> data_;
+  Payload data_;
 
   void updateHeader();
 };
 
+enum class FrameResult { COMPLETE, INCOMPLETE, MALFORMED };
+
+// A framed packet whose payload still lives in the receive buffer. Valid
+// only until that buffer is read into or consumed; call toPacket() to keep
+// it longer.
+class PacketView {
+public:
+  PacketView() = default;
+  PacketView(uint16_t type, const uint8_t *payload, size_t size)
+      : type_(type), payload_(payload), size_(size) {}
+
+  uint16_t getType() const { return type_; }
+  const uint8_t *data() const { return payload_; }
+  size_t size() const { return size_; }
+  size_t getTotalSize() const { return PacketHeader::SIZE + size_; }
+
+  std::string_view asString() const {
+    return std::string_view(reinterpret_cast<const char *>(payload_), size_);
+  }
+
+  Packet toPacket() const { return Packet(type_, payload_, size_); }
+
+  // Frames the packet at the start of buffer without copying it.
+  static FrameResult frame(const uint8_t *buffer, size_t size,
+                           PacketView &view);
+
+private:
+  uint16_t type_ = 0;
+  const uint8_t *payload_ = nullptr;
+  size_t size_ = 0;
+};
+
 } // namespace net
\ No newline at end of file
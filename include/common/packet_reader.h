@@ -0,0 +1,115 @@
+#pragma once
+
+#include "common/packet.h"
+#include "common/payload.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace net {
+
+class StringDictionary;
+
+// Bounds-checked cursor over received bytes, typically a packet payload
+// still in the receive buffer. Every read checks what remains and leaves
+// the cursor where it was on failure, so decoders never index past the
+// span whatever a peer sends.
+class PacketReader {
+public:
+  PacketReader() = default;
+  PacketReader(const uint8_t *data, size_t size)
+      : position_(data), end_(data + size) {}
+  explicit PacketReader(const PacketView &view)
+      : PacketReader(view.data(), view.size()) {}
+  explicit PacketReader(const Payload &payload)
+      : PacketReader(payload.data(), payload.size()) {}
+
+  size_t remaining() const { return static_cast<size_t>(end_ - position_); }
+  bool atEnd() const { return position_ == end_; }
+  const uint8_t *position() const { return position_; }
+
+  // Resolves interned-string ids while decoding; carried into spans.
+  const StringDictionary *strings() const { return strings_; }
+  void setStrings(const StringDictionary *strings) { strings_ = strings; }
+
+  bool readU8(uint8_t &value) {
+    if (remaining() < 1)
+      return false;
+    value = *position_++;
+    return true;
+  }
+
+  // Big-endian, like the packet header.
+  bool readU16(uint16_t &value) {
+    if (remaining() < 2)
+      return false;
+    value = static_cast<uint16_t>((position_[0] << 8) | position_[1]);
+    position_ += 2;
+    return true;
+  }
+
+  bool readU32(uint32_t &value) {
+    if (remaining() < 4)
+      return false;
+    value = (static_cast<uint32_t>(position_[0]) << 24) |
+            (static_cast<uint32_t>(position_[1]) << 16) |
+            (static_cast<uint32_t>(position_[2]) << 8) | position_[3];
+    position_ += 4;
+    return true;
+  }
+
+  // Little-endian base-128, at most ten bytes.
+  bool readVarint(uint64_t &value) {
+    // Keys, roles and small counts take one byte; client ids usually two.
+    size_t available = remaining();
+    if (available >= 1 && position_[0] < 0x80) {
+      value = *position_++;
+      return true;
+    }
+    if (available >= 2 && position_[1] < 0x80) {
+      value = (position_[0] & 0x7Fu) | (static_cast<uint64_t>(position_[1]) << 7);
+      position_ += 2;
+      return true;
+    }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < available && i < 10; ++i) {
+      result |= static_cast<uint64_t>(position_[i] & 0x7F) << (7 * i);
+      if ((position_[i] & 0x80) == 0) {
+        position_ += i + 1;
+        value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool readBytes(size_t size, const uint8_t *&bytes) {
+    if (remaining() < size)
+      return false;
+    bytes = position_;
+    position_ += size;
+    return true;
+  }
+
+  bool skip(size_t size) {
+    const uint8_t *ignored = nullptr;
+    return readBytes(size, ignored);
+  }
+
+  // Splits the next `size` bytes off as a reader of their own.
+  bool readSpan(size_t size, PacketReader &span) {
+    const uint8_t *bytes = nullptr;
+    if (!readBytes(size, bytes))
+      return false;
+    span = PacketReader(bytes, size);
+    span.strings_ = strings_;
+    return true;
+  }
+
+private:
+  const uint8_t *position_ = nullptr;
+  const uint8_t *end_ = nullptr;
+  const StringDictionary *strings_ = nullptr;
+};
+
+} // namespace net
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common/packet.h"
+#include "common/payload.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace net {
+
+// Builds an encoded packet in place: the header is reserved up front,
+// serializers append the payload straight into the buffer that will be
+// sent, and finish() patches the length. The buffer is a Payload behind a
+// single shared allocation, so packets up to Payload::INLINE_CAPACITY cost
+// one malloc and larger ones add a block from the per-thread pool.
+class PacketWriter {
+public:
+  // payloadHint reserves room for that many payload bytes up front.
+  explicit PacketWriter(uint16_t type, size_t payloadHint = 0);
+
+  // Appends `size` uninitialized bytes and returns where they start. The
+  // pointer is valid until the next append.
+  uint8_t *extend(size_t size) {
+    size_t offset = buffer_->size();
+    buffer_->resize(offset + size);
+    return buffer_->data() + offset;
+  }
+
+  void write(const void *data, size_t size);
+
+  size_t payloadSize() const { return buffer_->size() - PacketHeader::SIZE; }
+
+  // Fills in the header and hands over the buffer; the writer is spent.
+  WireBuffer finish();
+
+private:
+  std::shared_ptr<Payload> buffer_;
+  uint16_t type_;
+};
+
+} // namespace net
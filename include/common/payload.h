@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace net {
+
+// Packet payload bytes. Payloads up to INLINE_CAPACITY (a chat line) live
+// inside the object; larger ones come from a per-thread pool of
+// power-of-two blocks, so steady-state traffic does not hit malloc. Offers
+// the subset of std::vector<uint8_t> the serializers and PacketWriter use.
+class Payload {
+public:
+  static constexpr size_t INLINE_CAPACITY = 128;
+
+  Payload() = default;
+  Payload(const uint8_t *data, size_t size) { assign(data, size); }
+  explicit Payload(const std::vector<uint8_t> &data)
+      : Payload(data.data(), data.size()) {}
+  explicit Payload(const std::string &data)
+      : Payload(reinterpret_cast<const uint8_t *>(data.data()), data.size()) {}
+  ~Payload() { release(); }
+
+  Payload(const Payload &other) : Payload(other.data(), other.size()) {}
+  Payload(Payload &&other) noexcept { steal(other); }
+  Payload &operator=(const Payload &other);
+  Payload &operator=(Payload &&other) noexcept;
+
+  const uint8_t *data() const { return isInline() ? inline_ : heap_; }
+  uint8_t *data() { return isInline() ? inline_ : heap_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+
+  const uint8_t *begin() const { return data(); }
+  const uint8_t *end() const { return data() + size_; }
+  uint8_t operator[](size_t index) const { return data()[index]; }
+
+  void assign(const uint8_t *data, size_t size);
+
+  // Grow or shrink keeping the current bytes; new bytes are uninitialized.
+  void resize(size_t size);
+  void reserve(size_t capacity);
+
+  void clear() { size_ = 0; }
+
+  bool isInline() const { return capacity_ <= INLINE_CAPACITY; }
+
+private:
+  union {
+    uint8_t inline_[INLINE_CAPACITY];
+    uint8_t *heap_;
+  };
+  size_t size_ = 0;
+  size_t capacity_ = INLINE_CAPACITY;
+
+  void release();
+  void steal(Payload &other) noexcept;
+};
+
+} // namespace net
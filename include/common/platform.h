@@ -0,0 +1,69 @@
+#pragma once
+
+// Socket portability layer. The networking code is written against the
+// Winsock names (SOCKET, INVALID_SOCKET, closesocket, WSAGetLastError...);
+// on POSIX systems those names are mapped onto the BSD socket API.
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#pragma comment(lib, "ws2_32.lib")
+
+#ifndef SHUT_RDWR
+#define SHUT_RDWR SD_BOTH
+#endif
+
+namespace net {
+constexpr int SEND_FLAGS = 0;
+
+inline bool setNonBlocking(SOCKET socket) {
+  u_long mode = 1;
+  return ioctlsocket(socket, FIONBIO, &mode) == 0;
+}
+
+inline int pollSockets(pollfd *fds, unsigned long count, int timeoutMs) {
+  return WSAPoll(fds, count, timeoutMs);
+}
+} // namespace net
+
+#else
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using SOCKET = int;
+
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SOCKET_ERROR = -1;
+
+constexpr int WSAECONNRESET = ECONNRESET;
+constexpr int WSAENOTCONN = ENOTCONN;
+constexpr int WSAEWOULDBLOCK = EWOULDBLOCK;
+
+inline int closesocket(SOCKET socket) { return ::close(socket); }
+
+inline int WSAGetLastError() { return errno; }
+
+namespace net {
+// Peers that vanish mid-send must surface as EPIPE, not kill the process.
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+
+inline bool setNonBlocking(SOCKET socket) {
+  int flags = fcntl(socket, F_GETFL, 0);
+  return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+inline int pollSockets(pollfd *fds, unsigned long count, int timeoutMs) {
+  return ::poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+} // namespace net
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace net {
+
+// xoshiro256**: a small, fast generator for game decisions (liar, topic,
+// word). Not for anything security-sensitive. Each room owns one, so draws
+// take no lock and a fixed seed replays the same deals.
+class Random {
+public:
+  using result_type = uint64_t;
+
+  // The state is filled from seed by splitmix64; `stream` picks one of many
+  // independent sequences for the same seed (one per room).
+  explicit Random(uint64_t seed, uint64_t stream = 0) {
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    for (uint64_t &word : state_)
+      word = splitmix(x);
+  }
+
+  // Seeded from this thread's generator, which read std::random_device
+  // once when the thread first asked.
+  static Random fromEntropy();
+
+  uint64_t next() {
+    uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+  }
+
+  // Uniform in [0, bound), bound > 0, without modulo bias (Lemire).
+  uint32_t below(uint32_t bound) {
+    uint64_t product = (next() >> 32) * bound;
+    if (static_cast<uint32_t>(product) < bound) {
+      uint32_t threshold = (0u - bound) % bound;
+      while (static_cast<uint32_t>(product) < threshold)
+        product = (next() >> 32) * bound;
+    }
+    return static_cast<uint32_t>(product >> 32);
+  }
+
+  // UniformRandomBitGenerator, for <random> distributions and std::shuffle.
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() { return next(); }
+
+private:
+  uint64_t state_[4];
+
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+  static uint64_t splitmix(uint64_t &x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+};
+
+} // namespace net
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace net {
+
+// Contiguous receive buffer with read and write cursors. Sockets read
+// straight into the free tail and parsed packets are consumed by moving the
+// read cursor; unread bytes only move (to the front) when the tail runs out
+// of room, so a burst of packets costs no per-packet shifting.
+class ReceiveBuffer {
+public:
+  ReceiveBuffer() = default;
+
+  ReceiveBuffer(const ReceiveBuffer &) = delete;
+  ReceiveBuffer &operator=(const ReceiveBuffer &) = delete;
+  ReceiveBuffer(ReceiveBuffer &&) = default;
+  ReceiveBuffer &operator=(ReceiveBuffer &&) = default;
+
+  const uint8_t *data() const { return storage_.get() + readPos_; }
+  size_t size() const { return writePos_ - readPos_; }
+  bool empty() const { return readPos_ == writePos_; }
+
+  // Returns a tail with at least minSpace writable bytes; follow the write
+  // with commit().
+  uint8_t *prepare(size_t minSpace);
+  size_t writable() const { return capacity_ - writePos_; }
+  void commit(size_t bytes) { writePos_ += bytes; }
+
+  void append(const uint8_t *data, size_t size);
+
+  void consume(size_t bytes);
+
+  void clear() { readPos_ = writePos_ = 0; }
+
+private:
+  static constexpr size_t MIN_CAPACITY = 4096;
+
+  std::unique_ptr<uint8_t[]> storage_;
+  size_t capacity_ = 0;
+  size_t readPos_ = 0;
+  size_t writePos_ = 0;
+};
+
+} // namespace net
@@ -2,19 +2,22 @@
 
 #include "common/game_state.h"
 #include "common/packet.h"
+#include "common/packet_writer.h"
+#include "common/platform.h"
+#include "common/state_sync.h"
+#include "common/string_table.h"
 #include <cstring>
 #include <vector>
-#include <winsock2.h>
 
 namespace net {
 
 struct ChatMessage {
   uint32_t senderId;
-  std::string senderUsername;
+  InternedString senderUsername;
   std::string senderMessage;
 
   ChatMessage() : senderId(0) {}
-  ChatMessage(uint32_t id, const std::string &username,
+  ChatMessage(uint32_t id, const InternedString &username,
               const std::string &message)
       : senderId(id), senderUsername(username), senderMessage(message) {}
 };
@@ -22,26 +25,42 @@ struct ChatMessage {
 struct RoleAssignment {
   uint32_t playerId;
   PlayerRole role;
-  std::string topic;      // Liar sees this
-  std::string secretWord; // Guessers see this
+  InternedString topic;      // Liar sees this
+  InternedString secretWord; // Guessers see this
 
   RoleAssignment() : playerId(0), role(PlayerRole::NONE) {}
-  RoleAssignment(uint32_t id, PlayerRole r, const std::string &t,
-                 const std::string &w)
+  RoleAssignment(uint32_t id, PlayerRole r, const InternedString &t,
+                 const InternedString &w)
       : playerId(id), role(r), topic(t), secretWord(w) {}
 };
 
+// Payloads use the compact tagged encoding from common/wire_codec.h; each
+// message's fields are listed once in serialization.cpp.
+//
+// Usernames, topics and words travel as their StringTable id. The server
+// sends a STRING_DEFINE with the text before a client's first message that
+// uses an id, and clients decode through the StringDictionary built from
+// those; without one, interned fields decode empty.
 std::vector<uint8_t> serializePlayerState(const PlayerState &state);
 
 PlayerState deserializePlayerState(const uint8_t *data, size_t size);
 
 Packet createPlayerStatePacket(uint16_t type, const PlayerState &state);
 
-Packet createGameStateUpdatePacket(const std::vector<PlayerState> &states);
-
 PlayerState extractPlayerState(const Packet &packet);
+PlayerState extractPlayerState(const Packet &packet,
+                               const StringDictionary &strings);
+
+// GAME_STATE_UPDATE carries a StateUpdate (see common/state_sync.h); the
+// client answers each one with a STATE_ACK naming the snapshot it now holds.
+Packet createGameStateUpdatePacket(const StateUpdate &update);
+StateUpdate extractGameStateUpdate(const Packet &packet);
+StateUpdate extractGameStateUpdate(const Packet &packet,
+                                   const StringDictionary &strings);
 
-std::vector<PlayerState> extractGameStateUpdate(const Packet &packet);
+Packet createStateAckPacket(uint32_t snapshotId);
+uint32_t deserializeStateAck(const uint8_t *data, size_t size);
+uint32_t extractStateAck(const Packet &packet);
 
 std::vector<uint8_t> serializeChatMessage(const ChatMessage &message);
 
@@ -50,11 +69,18 @@ ChatMessage deserializeChatMessage(const uint8_t *data, size_t size);
 Packet createChatMessagePacket(const ChatMessage &message);
 
 ChatMessage extractChatMessage(const Packet &packet);
+ChatMessage extractChatMessage(const Packet &packet,
+                               const StringDictionary &strings);
 
 std::vector<uint8_t> serializeRoleAssignment(const RoleAssignment &assignment);
 RoleAssignment deserializeRoleAssignment(const uint8_t *data, size_t size);
 Packet createRoleAssignmentPacket(const RoleAssignment &assignment);
 RoleAssignment extractRoleAssignment(const Packet &packet);
+RoleAssignment extractRoleAssignment(const Packet &packet,
+                                     const StringDictionary &strings);
+
+Packet createStringDefinePacket(const std::vector<StringDefinition> &strings);
+std::vector<StringDefinition> extractStringDefinitions(const Packet &packet);
 
 struct VoteCommand {
   uint32_t voterId;
@@ -83,4 +109,13 @@ VoteResult deserializeVoteResult(const uint8_t *data, size_t size);
 Packet createVoteResultPacket(const VoteResult &result);
 VoteResult extractVoteResult(const Packet &packet);
 
+// Encode straight into a sendable buffer with PacketWriter: one allocation,
+// no intermediate Packet. For the server's sends.
+WireBuffer encodePlayerState(uint16_t type, const PlayerState &state);
+WireBuffer encodeGameStateUpdate(const StateUpdate &update);
+WireBuffer encodeChatMessage(const ChatMessage &message);
+WireBuffer encodeRoleAssignment(const RoleAssignment &assignment);
+WireBuffer encodeVoteResult(const VoteResult &result);
+WireBuffer encodeStringDefinitions(const std::vector<StringDefinition> &strings);
+
 } // namespace net
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "common/game_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace net {
+
+// One player's entry in a GAME_STATE_UPDATE. Only the fields flagged in
+// `changed` carry information; a new player has all of them.
+struct PlayerDelta {
+  enum Field : uint8_t { USERNAME = 1, ROLE = 2, SCORE = 4, ALL = 7 };
+
+  uint32_t id = 0;
+  uint8_t changed = 0;
+  InternedString username;
+  PlayerRole role = PlayerRole::NONE;
+  int score = 0;
+};
+
+// GAME_STATE_UPDATE: snapshot `snapshotId` of the room, expressed as the
+// changes since `baselineId`, a snapshot the client acknowledged with
+// STATE_ACK. baselineId 0 is a full snapshot: every player, all fields.
+struct StateUpdate {
+  uint32_t snapshotId = 0;
+  uint32_t baselineId = 0;
+  std::vector<PlayerDelta> players;
+  std::vector<uint32_t> removed;
+
+  bool isFull() const { return baselineId == 0; }
+};
+
+// Server side: the room's last few snapshots, so each client can be sent
+// the difference from whichever one it last acknowledged. Players are kept
+// sorted by id.
+class SnapshotHistory {
+public:
+  static constexpr size_t DEPTH = 8;
+
+  // Records the players as the newest snapshot and returns its id. An
+  // unchanged room keeps the current id.
+  uint32_t capture(std::vector<PlayerState> players);
+
+  uint32_t latestId() const {
+    return snapshots_.empty() ? 0 : snapshots_.back().id;
+  }
+  bool contains(uint32_t snapshotId) const;
+
+  // The latest snapshot relative to `baselineId`; a full snapshot if that
+  // one is 0 or has aged out.
+  StateUpdate diff(uint32_t baselineId) const;
+
+private:
+  struct Snapshot {
+    uint32_t id;
+    std::vector<PlayerState> players;
+  };
+
+  std::deque<Snapshot> snapshots_;
+  uint32_t nextId_ = 1;
+
+  const Snapshot *find(uint32_t snapshotId) const;
+};
+
+// Client side: rebuilds snapshots from updates. Keeps as many as the
+// server may still use as a baseline.
+class SnapshotTracker {
+public:
+  // False if the update's baseline is unknown; the client should then
+  // acknowledge snapshot 0 to ask for a full resync. A full snapshot
+  // always applies and drops every snapshot held before it.
+  bool apply(const StateUpdate &update);
+
+  uint32_t latestId() const {
+    return snapshots_.empty() ? 0 : snapshots_.back().id;
+  }
+  // Players in the latest snapshot, sorted by id.
+  const std::vector<PlayerState> &players() const;
+
+private:
+  struct Snapshot {
+    uint32_t id;
+    std::vector<PlayerState> players;
+  };
+
+  std::deque<Snapshot> snapshots_;
+};
+
+} // namespace net
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace net {
+
+// A handle to one copy of a string in the process-wide StringTable:
+// usernames, topics and words. Copying it bumps a reference count instead
+// of the characters, equal strings compare by pointer, and id() names the
+// string on the wire. The empty string is the null handle, id 0.
+class InternedString {
+public:
+  InternedString() = default;
+  InternedString(std::string_view text);
+  InternedString(const std::string &text)
+      : InternedString(std::string_view(text)) {}
+  InternedString(const char *text) : InternedString(std::string_view(text)) {}
+  ~InternedString() { release(); }
+
+  InternedString(const InternedString &other) : entry_(other.entry_) {
+    retain();
+  }
+  InternedString(InternedString &&other) noexcept : entry_(other.entry_) {
+    other.entry_ = nullptr;
+  }
+  InternedString &operator=(const InternedString &other);
+  InternedString &operator=(InternedString &&other) noexcept;
+
+  uint32_t id() const { return entry_ ? entry_->id : 0; }
+  const std::string &str() const { return entry_ ? entry_->text : empty_; }
+  std::string_view view() const { return str(); }
+  bool empty() const { return entry_ == nullptr; }
+  size_t size() const { return str().size(); }
+
+  operator const std::string &() const { return str(); }
+
+  friend bool operator==(const InternedString &a, const InternedString &b) {
+    return a.entry_ == b.entry_;
+  }
+  friend bool operator!=(const InternedString &a, const InternedString &b) {
+    return a.entry_ != b.entry_;
+  }
+  friend bool operator==(const InternedString &a, std::string_view b) {
+    return a.view() == b;
+  }
+  friend bool operator!=(const InternedString &a, std::string_view b) {
+    return a.view() != b;
+  }
+  friend bool operator==(const InternedString &a, const std::string &b) {
+    return a.view() == b;
+  }
+  friend bool operator!=(const InternedString &a, const std::string &b) {
+    return a.view() != b;
+  }
+
+private:
+  friend class StringTable;
+
+  struct Entry {
+    std::atomic<uint32_t> refs{1};
+    uint32_t id = 0;
+    std::string text;
+  };
+
+  static const std::string empty_;
+  Entry *entry_ = nullptr;
+
+  explicit InternedString(Entry *entry) : entry_(entry) {}
+  void retain() {
+    if (entry_)
+      entry_->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  void release();
+};
+
+std::ostream &operator<<(std::ostream &out, const InternedString &text);
+
+// The process-wide set of interned strings. Ids count up from 1 and are
+// never reused, so a peer that learned an id can keep it for the whole
+// session; a string is freed when its last handle goes.
+class StringTable {
+public:
+  static StringTable &instance();
+
+  InternedString intern(std::string_view text);
+  // The live string with this id, or the null handle.
+  InternedString find(uint32_t id) const;
+  size_t size() const;
+
+private:
+  friend class InternedString;
+  using Entry = InternedString::Entry;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string_view, Entry *> byText_;
+  std::unordered_map<uint32_t, Entry *> byId_;
+  uint32_t nextId_ = 1;
+
+  StringTable() = default;
+  void reclaim(uint32_t id);
+};
+
+// STRING_DEFINE: strings a client has not been sent yet, each with its id.
+// Later messages carry only the id.
+struct StringDefinition {
+  uint32_t id = 0;
+  std::string text;
+};
+
+// Client side: the strings the server has defined this session, by their
+// wire id.
+class StringDictionary {
+public:
+  void define(uint32_t id, std::string_view text) {
+    strings_[id] = InternedString(text);
+  }
+  // The null handle for an id that was never defined.
+  InternedString resolve(uint32_t id) const {
+    auto it = strings_.find(id);
+    return it != strings_.end() ? it->second : InternedString();
+  }
+  size_t size() const { return strings_.size(); }
+
+private:
+  std::unordered_map<uint32_t, InternedString> strings_;
+};
+
+} // namespace net
@@ -0,0 +1,345 @@
+#pragma once
+
+#include "common/packet_reader.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace net {
+namespace wire {
+
+// Compact tagged encoding for game messages. Every field is a varint key
+// (tag << 3 | wire type) followed by either a varint or a length-prefixed
+// byte string. Fields equal to their default are omitted, and decoders
+// skip tags they do not know, so a message can gain fields without
+// breaking older peers.
+//
+// A message type becomes encodable by describing its fields once:
+//
+//   template <> struct Schema<VoteCommand> {
+//     using Fields = std::tuple<Field<1, &VoteCommand::voterId>,
+//                               Field<2, &VoteCommand::targetId>>;
+//   };
+//
+// and encodedSize / encode / decode are generated from that list.
+
+enum WireType : uint8_t { VARINT = 0, BYTES = 2 };
+
+inline size_t varintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+inline uint8_t *putVarint(uint8_t *out, uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+// Reads a length prefix and splits off the bytes it announces.
+inline bool readLengthPrefixed(PacketReader &reader, PacketReader &span) {
+  uint64_t length = 0;
+  return reader.readVarint(length) && length <= reader.remaining() &&
+         reader.readSpan(static_cast<size_t>(length), span);
+}
+
+inline uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+constexpr uint64_t fieldKey(uint32_t tag, WireType type) {
+  return (static_cast<uint64_t>(tag) << 3) | type;
+}
+
+inline bool skipValue(PacketReader &reader, uint64_t type) {
+  if (type == VARINT) {
+    uint64_t ignored = 0;
+    return reader.readVarint(ignored);
+  }
+  PacketReader ignored;
+  return type == BYTES && readLengthPrefixed(reader, ignored);
+}
+
+// One entry in a Schema: Field<1, &PlayerState::id>.
+template <uint32_t Tag, auto Member> struct Field {
+  static constexpr uint32_t TAG = Tag;
+  static constexpr auto MEMBER = Member;
+};
+
+template <typename T> struct Schema;
+
+template <typename T, typename = void> struct HasSchema : std::false_type {};
+template <typename T>
+struct HasSchema<T, std::void_t<typename Schema<T>::Fields>>
+    : std::true_type {};
+
+template <typename T> struct IsVector : std::false_type {};
+template <typename E, typename A>
+struct IsVector<std::vector<E, A>> : std::true_type {};
+
+template <typename T> size_t encodedSize(const T &message);
+template <typename T> uint8_t *encode(uint8_t *out, const T &message);
+template <typename T> bool decode(PacketReader &reader, T &message);
+
+// How one value is laid out. Integers, enums and bools are varints (signed
+// integers zigzagged so small negatives stay short); strings, maps and
+// nested messages are length-prefixed.
+template <typename V, typename = void> struct Codec;
+
+template <typename V>
+struct Codec<V, std::enable_if_t<std::is_integral_v<V> || std::is_enum_v<V>>> {
+  static constexpr WireType TYPE = VARINT;
+
+  static uint64_t toWire(V value) {
+    if constexpr (std::is_enum_v<V>)
+      return static_cast<uint64_t>(value);
+    else if constexpr (std::is_signed_v<V>)
+      return zigzag(value);
+    else
+      return value;
+  }
+
+  static bool isDefault(const V &value) { return value == V{}; }
+  static size_t size(const V &value) { return varintSize(toWire(value)); }
+  static uint8_t *write(uint8_t *out, const V &value) {
+    return putVarint(out, toWire(value));
+  }
+
+  static bool read(PacketReader &reader, V &value) {
+    uint64_t raw = 0;
+    if (!reader.readVarint(raw))
+      return false;
+    if constexpr (std::is_same_v<V, bool>)
+      value = raw != 0;
+    else if constexpr (std::is_enum_v<V> || !std::is_signed_v<V>)
+      value = static_cast<V>(raw);
+    else
+      value = static_cast<V>(unzigzag(raw));
+    return true;
+  }
+};
+
+template <> struct Codec<std::string> {
+  static constexpr WireType TYPE = BYTES;
+
+  static bool isDefault(const std::string &value) { return value.empty(); }
+  static size_t size(const std::string &value) {
+    return varintSize(value.size()) + value.size();
+  }
+  static uint8_t *write(uint8_t *out, const std::string &value) {
+    out = putVarint(out, value.size());
+    std::memcpy(out, value.data(), value.size());
+    return out + value.size();
+  }
+
+  static bool read(PacketReader &reader, std::string &value) {
+    PacketReader span;
+    if (!readLengthPrefixed(reader, span))
+      return false;
+    value.assign(reinterpret_cast<const char *>(span.position()),
+                 span.remaining());
+    return true;
+  }
+};
+
+// Maps of varint keys and values: one length-prefixed run of pairs.
+template <typename K, typename V> struct Codec<std::unordered_map<K, V>> {
+  static constexpr WireType TYPE = BYTES;
+  using Map = std::unordered_map<K, V>;
+
+  static size_t bodySize(const Map &map) {
+    size_t size = 0;
+    for (const auto &[key, value] : map)
+      size += Codec<K>::size(key) + Codec<V>::size(value);
+    return size;
+  }
+
+  static bool isDefault(const Map &map) { return map.empty(); }
+  static size_t size(const Map &map) {
+    size_t body = bodySize(map);
+    return varintSize(body) + body;
+  }
+  static uint8_t *write(uint8_t *out, const Map &map) {
+    out = putVarint(out, bodySize(map));
+    for (const auto &[key, value] : map) {
+      out = Codec<K>::write(out, key);
+      out = Codec<V>::write(out, value);
+    }
+    return out;
+  }
+
+  static bool read(PacketReader &reader, Map &map) {
+    PacketReader span;
+    if (!readLengthPrefixed(reader, span))
+      return false;
+    while (!span.atEnd()) {
+      K key{};
+      V value{};
+      if (!Codec<K>::read(span, key) || !Codec<V>::read(span, value))
+        return false;
+      map[key] = value;
+    }
+    return true;
+  }
+};
+
+// Nested messages.
+template <typename T> struct Codec<T, std::enable_if_t<HasSchema<T>::value>> {
+  static constexpr WireType TYPE = BYTES;
+
+  static bool isDefault(const T &) { return false; }
+  static size_t size(const T &message) {
+    size_t body = encodedSize(message);
+    return varintSize(body) + body;
+  }
+  static uint8_t *write(uint8_t *out, const T &message) {
+    out = putVarint(out, encodedSize(message));
+    return encode(out, message);
+  }
+
+  static bool read(PacketReader &reader, T &message) {
+    PacketReader span;
+    return readLengthPrefixed(reader, span) && decode(span, message);
+  }
+};
+
+// A vector field repeats its key once per element.
+template <uint32_t Tag, typename E>
+size_t repeatedSize(const std::vector<E> &values) {
+  const size_t keySize = varintSize(fieldKey(Tag, Codec<E>::TYPE));
+  size_t size = 0;
+  for (const E &value : values)
+    size += keySize + Codec<E>::size(value);
+  return size;
+}
+
+template <uint32_t Tag, typename E>
+uint8_t *encodeRepeated(uint8_t *out, const std::vector<E> &values) {
+  for (const E &value : values) {
+    out = putVarint(out, fieldKey(Tag, Codec<E>::TYPE));
+    out = Codec<E>::write(out, value);
+  }
+  return out;
+}
+
+namespace detail {
+
+template <typename F, typename T> size_t fieldSize(const T &message) {
+  const auto &value = message.*F::MEMBER;
+  using V = std::decay_t<decltype(value)>;
+  if constexpr (IsVector<V>::value) {
+    return repeatedSize<F::TAG>(value);
+  } else {
+    if (Codec<V>::isDefault(value))
+      return 0;
+    return varintSize(fieldKey(F::TAG, Codec<V>::TYPE)) +
+           Codec<V>::size(value);
+  }
+}
+
+template <typename F, typename T>
+uint8_t *writeField(uint8_t *out, const T &message) {
+  const auto &value = message.*F::MEMBER;
+  using V = std::decay_t<decltype(value)>;
+  if constexpr (IsVector<V>::value) {
+    return encodeRepeated<F::TAG>(out, value);
+  } else {
+    if (Codec<V>::isDefault(value))
+      return out;
+    out = putVarint(out, fieldKey(F::TAG, Codec<V>::TYPE));
+    return Codec<V>::write(out, value);
+  }
+}
+
+// A known tag carrying an unexpected wire type is skipped like an
+// unknown one.
+template <typename F, typename T>
+bool readField(PacketReader &reader, uint64_t type, T &message) {
+  auto &value = message.*F::MEMBER;
+  using V = std::decay_t<decltype(value)>;
+  if constexpr (IsVector<V>::value) {
+    using E = typename V::value_type;
+    if (type != Codec<E>::TYPE)
+      return skipValue(reader, type);
+    value.emplace_back();
+    return Codec<E>::read(reader, value.back());
+  } else {
+    if (type != Codec<V>::TYPE)
+      return skipValue(reader, type);
+    return Codec<V>::read(reader, value);
+  }
+}
+
+} // namespace detail
+
+template <typename T> size_t encodedSize(const T &message) {
+  return std::apply(
+      [&](auto... fields) {
+        return (size_t{0} + ... +
+                detail::fieldSize<decltype(fields)>(message));
+      },
+      typename Schema<T>::Fields{});
+}
+
+template <typename T> uint8_t *encode(uint8_t *out, const T &message) {
+  std::apply(
+      [&](auto... fields) {
+        ((out = detail::writeField<decltype(fields)>(out, message)), ...);
+      },
+      typename Schema<T>::Fields{});
+  return out;
+}
+
+// Fills `message` field by field; false on truncated or malformed input,
+// with the fields read so far kept.
+template <typename T> bool decode(PacketReader &reader, T &message) {
+  while (!reader.atEnd()) {
+    uint64_t key = 0;
+    if (!reader.readVarint(key))
+      return false;
+    uint64_t tag = key >> 3;
+    uint64_t type = key & 7;
+
+    bool ok = true;
+    bool known = std::apply(
+        [&](auto... fields) {
+          return ((tag == decltype(fields)::TAG &&
+                   (ok = detail::readField<decltype(fields)>(reader, type,
+                                                             message),
+                    true)) ||
+                  ...);
+        },
+        typename Schema<T>::Fields{});
+
+    if (!known)
+      ok = skipValue(reader, type);
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+template <typename T> bool decode(const uint8_t *data, size_t size, T &message) {
+  PacketReader reader(data, size);
+  return decode(reader, message);
+}
+
+} // namespace wire
+} // namespace net
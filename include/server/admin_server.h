@@ -0,0 +1,99 @@
+#pragma once
+
+#include "common/platform.h"
+#include "server/packet_metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+class Server;
+
+// Builds a Prometheus text-format (version 0.0.4) exposition.
+class MetricsWriter {
+public:
+  using Labels =
+      std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+  // Starts a family: its # HELP and # TYPE lines. type is "counter",
+  // "gauge" or "summary".
+  void family(std::string_view name, std::string_view type,
+              std::string_view help);
+
+  void sample(std::string_view name, uint64_t value, Labels labels = {});
+  void sample(std::string_view name, double value, Labels labels = {});
+
+  // A whole summary family: p50/p90/p99/p999 quantiles, _sum and _count
+  // per label set, converted from nanoseconds to seconds.
+  void summary(std::string_view name, std::string_view help,
+               std::string_view labelName,
+               const std::vector<std::pair<std::string, const LatencyHistogram *>>
+                   &series);
+
+  const std::string &text() const { return out_; }
+
+private:
+  std::string out_;
+
+  void labels(Labels labels);
+  void value(const std::string &text);
+};
+
+// A loopback-only listener that answers every HTTP GET with the text the
+// registered collectors write, for a Prometheus scraper or curl. One
+// request at a time on its own thread, so a scrape never runs on an I/O or
+// game thread; collectors must therefore only read state that is safe to
+// read concurrently (atomics, epoch-pinned iteration, short per-item
+// locks).
+class AdminServer {
+public:
+  using Collector = std::function<void(MetricsWriter &)>;
+
+  explicit AdminServer(uint16_t port);
+  ~AdminServer();
+
+  AdminServer(const AdminServer &) = delete;
+  AdminServer &operator=(const AdminServer &) = delete;
+
+  // Register before start().
+  void addCollector(Collector collector);
+
+  // Binds 127.0.0.1:port and starts serving. False if it cannot listen.
+  bool start();
+  void stop();
+
+  // The exposition a request would get now.
+  std::string render() const;
+
+private:
+  uint16_t port_;
+  SOCKET listenSocket_;
+  std::atomic<bool> running_;
+  std::thread thread_;
+  std::vector<Collector> collectors_;
+  // Serializes render(): collectors may keep state between scrapes.
+  mutable std::mutex renderMutex_;
+
+  static constexpr int POLL_INTERVAL_MS = 200;
+  static constexpr int REQUEST_TIMEOUT_MS = 1000;
+  static constexpr size_t MAX_REQUEST = 8192;
+
+  void run();
+  void handle(SOCKET client);
+};
+
+// Connection, MessageQueue, send-queue and per-type packet metrics of a
+// Server. Send-queue bytes take each connection's send lock only for that
+// connection's read; only connections with bytes queued get their own
+// series.
+void collectServerMetrics(MetricsWriter &out, Server &server);
+
+} // namespace net
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace net {
+
+// What push() does when the queue is full.
+enum class OverflowPolicy {
+  // Refuse the new item; push() returns false.
+  DROP_NEWEST,
+  // Evict the oldest queued item to make room.
+  DROP_OLDEST,
+  // Wait until a consumer frees a slot.
+  BLOCK
+};
+
+// Sleep/wake primitive on a 32-bit counter: a futex on Linux, a condition
+// variable elsewhere. Waiters announce themselves with beginWait(), re-check
+// their condition, then wait(); notify() is a single fence and load when
+// nobody is waiting.
+class WaitSignal {
+public:
+  uint32_t beginWait();
+  void endWait();
+
+  // Returns when notified after `observed` was read, on timeout, or
+  // spuriously; callers re-check their condition.
+  void wait(uint32_t observed, std::chrono::nanoseconds timeout);
+
+  void notify(bool all = false);
+
+private:
+  std::atomic<uint32_t> word_{0};
+  std::atomic<uint32_t> waiters_{0};
+#ifndef __linux__
+  std::mutex mutex_;
+  std::condition_variable condition_;
+#endif
+};
+
+// Bounded lock-free multi-producer multi-consumer ring (Vyukov's
+// sequence-numbered cells). Producers and consumers each claim slots with
+// one CAS on their own cursor; blocking is opt-in and costs nothing while
+// no thread is asleep. T must be default-constructible and movable.
+template <typename T> class BoundedQueue {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+  // Capacity is rounded up to a power of two.
+  explicit BoundedQueue(size_t capacity = DEFAULT_CAPACITY,
+                        OverflowPolicy policy = OverflowPolicy::DROP_NEWEST);
+  ~BoundedQueue() = default;
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  // False if the item was dropped (DROP_NEWEST on a full queue).
+  bool push(const T &item) { return pushImpl(item); }
+  bool push(T &&item) { return pushImpl(std::move(item)); }
+
+  // Blocks until an item is available.
+  T pop();
+
+  bool tryPop(T &item) { return tryPopN(&item, 1) == 1; }
+
+  // Moves up to maxCount items into out; returns how many.
+  size_t tryPopN(T *out, size_t maxCount);
+
+  // Like tryPopN(), but sleeps up to timeout for the first item. Returns
+  // 0 on timeout, after notifyAll(), or on a spurious wakeup.
+  size_t waitPopN(T *out, size_t maxCount, std::chrono::nanoseconds timeout);
+
+  bool empty() const { return size() == 0; }
+
+  // Approximate while producers or consumers are active.
+  size_t size() const;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Items discarded by the overflow policy so far.
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  void clear();
+
+  // Wakes every sleeping consumer, e.g. for shutdown.
+  void notifyAll() { notEmpty_.notify(true); }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T item;
+  };
+
+  static constexpr size_t CACHE_LINE = 64;
+  static constexpr int WAIT_SPIN_LIMIT = 16;
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  OverflowPolicy policy_;
+
+  alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+  alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+  alignas(CACHE_LINE) std::atomic<uint64_t> dropped_{0};
+
+  WaitSignal notEmpty_;
+  WaitSignal notFull_;
+
+  static size_t roundUpToPowerOfTwo(size_t value);
+
+  template <typename U> bool pushImpl(U &&item);
+  template <typename U> bool tryPush(U &&item);
+};
+
+template <typename T>
+size_t BoundedQueue<T>::roundUpToPowerOfTwo(size_t value) {
+  size_t result = 2;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity, OverflowPolicy policy)
+    : mask_(roundUpToPowerOfTwo(capacity) - 1), policy_(policy) {
+  cells_.reset(new Cell[mask_ + 1]);
+  for (size_t i = 0; i <= mask_; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+template <typename U>
+bool BoundedQueue<T>::tryPush(U &&item) {
+  size_t position = tail_.load(std::memory_order_relaxed);
+  Cell *cell;
+  for (;;) {
+    cell = &cells_[position & mask_];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(position, position + 1,
+                                      std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;
+    } else {
+      position = tail_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->item = std::forward<U>(item);
+  cell->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+template <typename U>
+bool BoundedQueue<T>::pushImpl(U &&item) {
+  while (!tryPush(std::forward<U>(item))) {
+    switch (policy_) {
+    case OverflowPolicy::DROP_NEWEST:
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case OverflowPolicy::DROP_OLDEST: {
+      T evicted;
+      if (tryPop(evicted))
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+
+    case OverflowPolicy::BLOCK: {
+      // Sleep until consumers have drained half the ring, so a full queue
+      // costs one wakeup per half-ring rather than one per pop.
+      uint32_t observed = notFull_.beginWait();
+      if (size() > capacity() / 2)
+        notFull_.wait(observed, std::chrono::milliseconds(100));
+      notFull_.endWait();
+      break;
+    }
+    }
+  }
+
+  notEmpty_.notify();
+  return true;
+}
+
+template <typename T> T BoundedQueue<T>::pop() {
+  T item;
+  while (waitPopN(&item, 1, std::chrono::seconds(1)) == 0) {
+  }
+  return item;
+}
+
+template <typename T>
+size_t BoundedQueue<T>::tryPopN(T *out, size_t maxCount) {
+  if (maxCount == 0)
+    return 0;
+
+  size_t position = head_.load(std::memory_order_relaxed);
+  size_t count;
+  for (;;) {
+    // Count the consecutive published cells from position; once published
+    // they stay that way until whoever claims them releases them.
+    count = 0;
+    while (count < maxCount) {
+      const Cell &cell = cells_[(position + count) & mask_];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence != position + count + 1)
+        break;
+      ++count;
+    }
+
+    if (count == 0) {
+      const Cell &cell = cells_[position & mask_];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if (static_cast<intptr_t>(sequence) -
+              static_cast<intptr_t>(position + 1) <
+          0)
+        return 0;
+      // Another consumer took it; start over from the new head.
+      position = head_.load(std::memory_order_relaxed);
+      continue;
+    }
+
+    if (head_.compare_exchange_weak(position, position + count,
+                                    std::memory_order_relaxed))
+      break;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    Cell &cell = cells_[(position + i) & mask_];
+    out[i] = std::move(cell.item);
+    cell.sequence.store(position + i + mask_ + 1, std::memory_order_release);
+  }
+
+  if (policy_ == OverflowPolicy::BLOCK && size() <= capacity() / 2)
+    notFull_.notify(true);
+  return count;
+}
+
+template <typename T>
+size_t BoundedQueue<T>::waitPopN(T *out, size_t maxCount,
+                                 std::chrono::nanoseconds timeout) {
+  // Brief yield phase first: a producer that is mid-burst refills the ring
+  // sooner than a futex round trip would.
+  for (int spin = 0; spin < WAIT_SPIN_LIMIT; ++spin) {
+    size_t count = tryPopN(out, maxCount);
+    if (count > 0)
+      return count;
+    std::this_thread::yield();
+  }
+
+  uint32_t observed = notEmpty_.beginWait();
+  size_t count = tryPopN(out, maxCount);
+  if (count == 0)
+    notEmpty_.wait(observed, timeout);
+  notEmpty_.endWait();
+
+  return count > 0 ? count : tryPopN(out, maxCount);
+}
+
+template <typename T> size_t BoundedQueue<T>::size() const {
+  size_t head = head_.load(std::memory_order_acquire);
+  size_t tail = tail_.load(std::memory_order_acquire);
+  return tail > head ? tail - head : 0;
+}
+
+template <typename T> void BoundedQueue<T>::clear() {
+  T discarded[16];
+  while (tryPopN(discarded, 16) > 0) {
+  }
+}
+
+} // namespace net
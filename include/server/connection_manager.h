@@ -1,14 +1,19 @@
 #pragma once
 
+#include "common/packet.h"
+#include "common/platform.h"
+#include "common/string_table.h"
+#include "server/epoch_reclaimer.h"
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 
 namespace net {
 
@@ -18,11 +23,20 @@ struct ConnectionInfo {
   uint32_t id;
   SOCKET socket;
   sockaddr_in address;
-  std::string username;
-  ConnectionStatus status;
-  std::chrono::steady_clock::time_point lastHeartbeat;
+  InternedString username;
+  // Read without any lock by broadcast and lookup paths.
+  std::atomic<ConnectionStatus> status;
+  std::atomic<std::chrono::steady_clock::time_point> lastHeartbeat;
   std::chrono::steady_clock::time_point connectedAt;
 
+  // Guards socket writes and teardown. Outbound packets wait in sendQueue
+  // until the I/O layer drains them; sendOffset is how much of the front
+  // buffer has already been written and queuedBytes the queue's total size.
+  std::mutex sendMutex;
+  std::deque<WireBuffer> sendQueue;
+  size_t sendOffset = 0;
+  size_t queuedBytes = 0;
+
   ConnectionInfo(uint32_t id, SOCKET sock, const sockaddr_in &addr)
       : id(id), socket(sock), address(addr),
         status(ConnectionStatus::CONNECTING),
@@ -30,10 +44,22 @@ struct ConnectionInfo {
         connectedAt(std::chrono::steady_clock::now()) {}
 };
 
+// Connections are split into shards by id % shardCount. The reactor
+// backends use one shard per event loop and hand out ids so that a loop's
+// connections all live in its own shard.
+//
+// Each shard is an open-addressed table of atomic entry pointers. Writers
+// (add/remove/set*) serialize on the shard mutex; readers never lock. Lookups
+// and active-set iteration pin the process-wide EpochReclaimer, so removed
+// entries and replaced tables stay valid until every pinned reader is done.
+// A reader may still observe a connection removed concurrently with it.
 class ConnectionManager {
 public:
-  ConnectionManager() = default;
-  ~ConnectionManager() = default;
+  explicit ConnectionManager(size_t shardCount = 1);
+  ~ConnectionManager();
+
+  ConnectionManager(const ConnectionManager &) = delete;
+  ConnectionManager &operator=(const ConnectionManager &) = delete;
 
   bool addConnection(uint32_t id, SOCKET socket, const sockaddr_in &address);
 
@@ -41,6 +67,31 @@ public:
 
   std::shared_ptr<ConnectionInfo> getConnection(uint32_t id) const;
 
+  // Calls fn(ConnectionInfo &) without copying the shared_ptr. Returns false
+  // if the connection does not exist.
+  template <typename Fn> bool withConnection(uint32_t id, Fn &&fn) const {
+    auto guard = EpochReclaimer::instance().pin();
+    const Entry *entry = find(id);
+    if (!entry)
+      return false;
+    fn(*entry->info);
+    return true;
+  }
+
+  // Calls fn(ConnectionInfo &) for every ACTIVE connection. Bounded by the
+  // table capacity; never blocks on writers.
+  template <typename Fn> void forEachActive(Fn &&fn) const {
+    auto guard = EpochReclaimer::instance().pin();
+    for (const Shard &shard : shards_) {
+      const Table *table = shard.table.load(std::memory_order_acquire);
+      for (size_t i = 0; i <= table->mask; ++i) {
+        const Entry *entry = table->slots[i].load(std::memory_order_acquire);
+        if (isLive(entry) && entry->info->status == ConnectionStatus::ACTIVE)
+          fn(*entry->info);
+      }
+    }
+  }
+
   bool hasConnection(uint32_t id) const;
 
   bool setStatus(uint32_t id, ConnectionStatus status);
@@ -57,16 +108,70 @@ public:
 
   size_t getActiveConnectionCount() const;
 
+  // Through a username -> id index kept by setUsername and removal, so
+  // the cost does not grow with the number of connections. With several
+  // connections sharing a name, any one of them.
   std::shared_ptr<ConnectionInfo>
-  findConnectionByUsername(const std::string &username) const;
+  findConnectionByUsername(std::string_view username) const;
 
   void cleanupInactiveConnections();
 
   void clearAllConnections();
 
+  size_t getShardCount() const { return shards_.size(); }
+
 private:
-  mutable std::mutex mutex_;
-  std::unordered_map<uint32_t, std::shared_ptr<ConnectionInfo>> connections_;
+  struct Entry {
+    uint32_t id;
+    std::shared_ptr<ConnectionInfo> info;
+  };
+
+  // Capacity is a power of two and kept at most 3/4 full, counting
+  // tombstones, so every probe sequence reaches an empty slot.
+  struct Table {
+    explicit Table(size_t capacity);
+
+    size_t mask;
+    std::unique_ptr<std::atomic<Entry *>[]> slots;
+  };
+
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    std::atomic<Table *> table{nullptr};
+    std::atomic<size_t> size{0};
+    // Live entries plus tombstones; guarded by mutex.
+    size_t used = 0;
+  };
+
+  static constexpr size_t MIN_CAPACITY = 16;
+
+  std::vector<Shard> shards_;
+
+  // Keys view the text of each connection's interned username, which the
+  // ConnectionInfo keeps alive until its entry is erased. Taken after a
+  // shard mutex when both are held.
+  mutable std::mutex usernameMutex_;
+  std::unordered_multimap<std::string_view, uint32_t> byUsername_;
+
+  static Entry *tombstone() { return reinterpret_cast<Entry *>(uintptr_t{1}); }
+  static bool isLive(const Entry *entry) {
+    return entry && entry != tombstone();
+  }
+  static size_t hash(uint32_t id);
+
+  Shard &shardFor(uint32_t id) { return shards_[id % shards_.size()]; }
+  const Shard &shardFor(uint32_t id) const {
+    return shards_[id % shards_.size()];
+  }
+
+  // Caller must be pinned or hold the shard mutex.
+  const Entry *find(uint32_t id) const;
+
+  // Caller must hold the shard mutex.
+  std::atomic<Entry *> *findSlot(Shard &shard, uint32_t id);
+  void eraseSlot(Shard &shard, std::atomic<Entry *> &slot);
+  void unindexUsername(uint32_t id, const InternedString &username);
+  void rehash(Shard &shard, size_t capacity);
 };
 
 } // namespace net
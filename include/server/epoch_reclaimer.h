@@ -0,0 +1,77 @@
+#pragma once
+
+#include "server/thread_slot_list.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+// Epoch-based reclamation for read-mostly shared structures.
+//
+// Readers pin() around every access to memory that writers may unlink; a
+// pin is two atomic stores into a per-thread slot, so reads never block.
+// Writers unlink an object, then retire() it; the deleter runs only once
+// every reader that could still hold a reference has unpinned.
+class EpochReclaimer {
+public:
+  class Guard {
+  public:
+    explicit Guard(EpochReclaimer &reclaimer);
+    ~Guard();
+
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+  private:
+    EpochReclaimer &reclaimer_;
+  };
+
+  EpochReclaimer() = default;
+  ~EpochReclaimer();
+
+  EpochReclaimer(const EpochReclaimer &) = delete;
+  EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+  // Process-wide domain shared by every ConnectionManager.
+  static EpochReclaimer &instance();
+
+  Guard pin() { return Guard(*this); }
+
+  void retire(std::function<void()> deleter);
+
+  // Frees whatever no pinned reader can still observe.
+  void collect();
+
+  size_t pendingCount() const;
+
+private:
+  static constexpr uint64_t IDLE = UINT64_MAX;
+  static constexpr size_t COLLECT_THRESHOLD = 64;
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{IDLE};
+    std::atomic<bool> claimed{false};
+    Slot *next = nullptr;
+    // Owned by the claiming thread only.
+    size_t depth = 0;
+
+    void onRelease() { epoch.store(IDLE, std::memory_order_release); }
+  };
+
+  std::atomic<uint64_t> globalEpoch_{1};
+  ThreadSlotList<Slot> slots_;
+
+  mutable std::mutex retiredMutex_;
+  std::vector<std::pair<uint64_t, std::function<void()>>> retired_;
+  size_t collectAt_ = COLLECT_THRESHOLD;
+
+  void enter();
+  void exit();
+  uint64_t minPinnedEpoch() const;
+};
+
+} // namespace net
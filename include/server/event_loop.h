@@ -0,0 +1,85 @@
+#pragma once
+
+#include "common/platform.h"
+#include "common/receive_buffer.h"
+#include "server/connection_manager.h"
+#include "server/io_loop.h"
+#include "server/timer_wheel.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace net {
+
+class Server;
+
+// Edge-triggered epoll reactor. Other threads request teardown of a socket
+// via shutdown(); the owning loop sees the hangup and closes it. Each
+// connection's idle timer lives in the loop's TimerWheel, which sets the
+// epoll_wait timeout. A connection that still has data after its read
+// budget goes on a ready list the loop revisits before the next epoll_wait,
+// so one fast sender cannot starve the rest of the loop.
+class EventLoop : public IoLoop {
+public:
+  EventLoop(Server &server, size_t index);
+  ~EventLoop() override;
+
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  bool init() override;
+
+  bool watchListener(SOCKET listenSocket) override;
+
+  void run() override;
+
+  void wakeup() override;
+
+  void adopt(std::shared_ptr<ConnectionInfo> connection) override;
+
+  // Writes from the calling thread right away; EPOLLOUT drains the rest.
+  void scheduleFlush(ConnectionInfo &connection) override;
+
+private:
+  struct LoopConnection {
+    std::shared_ptr<ConnectionInfo> info;
+    ReceiveBuffer receiveBuffer;
+    TimerWheel::TimerId idleTimer = 0;
+    bool readReady = false;
+  };
+
+  static constexpr uint64_t LISTENER_TOKEN = 0;
+  static constexpr uint64_t WAKEUP_TOKEN = UINT64_MAX;
+  static constexpr int MAX_EVENTS = 256;
+  static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+  static constexpr size_t MIN_READ_SPACE = 2048;
+  static constexpr int READ_BUDGET = 4;
+
+  Server &server_;
+  size_t index_;
+  int epollFd_;
+  int wakeupFd_;
+  SOCKET listenSocket_;
+
+  std::unordered_map<uint32_t, LoopConnection> connections_;
+  TimerWheel timers_;
+  std::vector<uint32_t> readReady_;
+
+  std::mutex pendingMutex_;
+  std::vector<std::shared_ptr<ConnectionInfo>> pending_;
+
+  void acceptClients();
+  void drainPending();
+  void registerConnection(std::shared_ptr<ConnectionInfo> connection);
+  void handleReadable(uint32_t clientId);
+  void serviceReadReady();
+  void handleWritable(uint32_t clientId);
+  void armIdleTimer(uint32_t clientId, TimerWheel::Clock::duration delay);
+  void onIdleTimer(uint32_t clientId);
+  void closeConnection(uint32_t clientId);
+  void closeAll();
+};
+
+} // namespace net
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "server/bounded_queue.h"
+#include "server/game_room.h"
+#include "server/timer_wheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace net {
+
+// Runs game logic on one dedicated thread. I/O threads only decode packets
+// and submit() commands; the loop drains them in batches and hands them to
+// the handler in queue order, so the GameState it drives can be
+// unsynchronized. Every tickInterval the optional tick callback runs on the
+// same thread, and so do timers in getTimers() (tick resolution), e.g. a
+// room's round deadline.
+class GameLoop {
+public:
+  using CommandHandler = std::function<void(const GameCommand &command)>;
+  using TickCallback = std::function<void(uint64_t tick)>;
+
+  static constexpr size_t COMMAND_CAPACITY = 16384;
+
+  GameLoop(CommandHandler handler, std::chrono::milliseconds tickInterval);
+  ~GameLoop();
+
+  GameLoop(const GameLoop &) = delete;
+  GameLoop &operator=(const GameLoop &) = delete;
+
+  void setTickCallback(TickCallback callback);
+
+  void start();
+  void stop();
+
+  // Called from I/O threads. Blocks while the loop is COMMAND_CAPACITY
+  // commands behind rather than dropping a join or leave.
+  void submit(GameCommand &&command);
+
+  // Only from the loop thread: in the handler, tick or a timer callback, or
+  // before start().
+  TimerWheel &getTimers() { return timers_; }
+
+  uint64_t getTickCount() const {
+    return ticks_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t BATCH_SIZE = 64;
+
+  CommandHandler handler_;
+  std::chrono::milliseconds tickInterval_;
+  BoundedQueue<GameCommand> commands_;
+  TickCallback tickCallback_;
+  TimerWheel timers_;
+
+  std::atomic<bool> running_;
+  std::atomic<uint64_t> ticks_;
+  std::thread thread_;
+
+  void run();
+};
+
+} // namespace net
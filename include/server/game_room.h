@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/game_state.h"
+#include "common/packet.h"
+#include "common/payload.h"
+#include "common/state_sync.h"
+#include "common/string_table.h"
+#include "server/server.h"
+#include "server/timer_wheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace net {
+
+// A player action decoded from a packet on the I/O thread. `text` is the
+// username (JOIN), the trimmed chat line (CHAT) or the vote target (VOTE).
+// roomId is filled in by RoomManager routing.
+struct GameCommand {
+  enum class Kind : uint8_t { NONE, JOIN, CHAT, VOTE, LEAVE, ACK };
+
+  Kind kind = Kind::NONE;
+  uint32_t clientId = 0;
+  uint32_t roomId = 0;
+  Payload text;
+  // JOIN only: don't start a round yet, more of a matched group follows.
+  bool holdRound = false;
+  // ACK only: the state snapshot the client now holds, 0 for a resync.
+  uint32_t snapshotId = 0;
+
+  std::string_view textView() const {
+    return std::string_view(reinterpret_cast<const char *>(text.data()),
+                            text.size());
+  }
+
+  // False for packet types the game ignores.
+  static bool decode(const PacketView &packet, uint32_t clientId,
+                     GameCommand &command);
+};
+
+// Totals over every GameRoom in the process, for the admin endpoint.
+struct GameRoomStats {
+  std::atomic<uint64_t> roundsStarted{0};
+  // Every round that ended and was scored, timed out or not.
+  std::atomic<uint64_t> roundsCompleted{0};
+  std::atomic<uint64_t> roundsTimedOut{0};
+  // Accepted votes.
+  std::atomic<uint64_t> votes{0};
+};
+
+// Liar Line rules on top of a GameState: applies commands and sends the
+// packets that announce the result to the room's players. Not thread-safe
+// by itself; either one thread runs it (GameLoop) or the GameState is
+// synchronized.
+class GameRoom {
+public:
+  GameRoom(Server &server, GameState &state);
+
+  void execute(const GameCommand &command);
+
+  void onJoin(uint32_t clientId, std::string_view username,
+              bool startRound = true);
+  void onChat(uint32_t clientId, std::string_view message);
+  void onVote(uint32_t clientId, std::string_view targetName);
+  void onLeave(uint32_t clientId);
+  void onAck(uint32_t clientId, uint32_t snapshotId);
+
+  // Ends each round `timeout` after it starts if not everyone has voted,
+  // scoring the votes cast so far. `timers` must run on the thread that
+  // runs execute() (GameLoop::getTimers()). Call before the first command.
+  void setRoundTimeout(TimerWheel &timers, std::chrono::milliseconds timeout);
+
+  GameState &getState() { return state_; }
+
+  static GameRoomStats &stats();
+
+private:
+  // What each player has of the room's state: the last snapshot it
+  // acknowledged (the baseline for its next delta), the last one sent, and
+  // the interned strings it has been given the text of.
+  struct ClientSync {
+    uint32_t acked = 0;
+    uint32_t sent = 0;
+    std::unordered_set<uint32_t> knownStrings;
+  };
+
+  Server &server_;
+  GameState &state_;
+
+  // Default mode runs execute() on every I/O thread, so snapshots are
+  // taken and sent under one lock to keep their ids in send order.
+  std::mutex syncMutex_;
+  SnapshotHistory history_;
+  std::unordered_map<uint32_t, ClientSync> clientSync_;
+
+  TimerWheel *timers_ = nullptr;
+  std::chrono::milliseconds roundTimeout_{0};
+  TimerWheel::TimerId roundTimer_ = 0;
+
+  // `strings` are the interned strings `wire` refers to; recipients that
+  // have not seen one get a STRING_DEFINE first.
+  void sendTo(const std::vector<uint32_t> &recipients, const WireBuffer &wire,
+              const std::vector<InternedString> &strings = {});
+  void sendToRoom(const WireBuffer &wire,
+                  const std::vector<InternedString> &strings = {});
+  void sendToRoomExcept(uint32_t excludeClientId, const WireBuffer &wire,
+                        const std::vector<InternedString> &strings = {});
+  // Called with syncMutex_ held.
+  void defineStrings(const std::vector<uint32_t> &recipients,
+                     const std::vector<InternedString> &strings);
+  // GAME_STATE_UPDATE to each recipient, as a delta from its acknowledged
+  // snapshot. Recipients sharing a baseline share one encoded buffer.
+  void sendStateUpdate(const std::vector<uint32_t> &recipients);
+  void startNewRoundIfPossible();
+  void finishRound();
+  void cancelRoundTimer();
+  void onRoundTimeout();
+};
+
+} // namespace net
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "common/platform.h"
+#include "server/connection_manager.h"
+#include <cstdint>
+#include <memory>
+
+namespace net {
+
+// A reactor thread that owns a subset of the server's sockets. Sockets are
+// handed out by the acceptor as clientId % loopCount; only the owning loop
+// reads from or closes a socket, other threads write through send().
+class IoLoop {
+public:
+  virtual ~IoLoop() = default;
+
+  virtual bool init() = 0;
+
+  // Registers the listening socket; only loop 0 accepts.
+  virtual bool watchListener(SOCKET listenSocket) = 0;
+
+  virtual void run() = 0;
+
+  virtual void wakeup() = 0;
+
+  // Thread-safe hand-off of a freshly accepted connection to this loop.
+  virtual void adopt(std::shared_ptr<ConnectionInfo> connection) = 0;
+
+  // Thread-safe; called once a packet lands in an empty send queue so the
+  // loop starts draining it. Later packets ride along with that drain.
+  virtual void scheduleFlush(ConnectionInfo &connection) = 0;
+};
+
+} // namespace net
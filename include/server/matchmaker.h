@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace net {
+
+struct MatchmakingConfig {
+  size_t minPlayers = 3;
+  size_t maxPlayers = 6;
+
+  // A room opens as soon as this many players are waiting...
+  size_t targetPlayers = 6;
+  // ...or once the longest-waiting player has waited this long and at
+  // least minPlayers are queued. Zero favours latency, larger values
+  // favour fuller rooms.
+  std::chrono::milliseconds maxWait{2000};
+};
+
+// Buffers joining players and packs them into rooms in arrival order.
+// Enqueue, cancel and forming a group are O(1) per player (a FIFO list
+// plus a clientId index). A background thread sleeps until the oldest
+// ticket's deadline or until enough players arrive.
+class Matchmaker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Ticket {
+    uint32_t clientId;
+    std::string username;
+    Clock::time_point enqueued;
+  };
+
+  // Seats a group; returns false if no room is available, in which case
+  // the tickets stay queued. Runs with the matchmaker's lock held.
+  using MatchCallback = std::function<bool(const std::vector<Ticket> &group)>;
+
+  Matchmaker(const MatchmakingConfig &config, MatchCallback callback);
+  ~Matchmaker();
+
+  Matchmaker(const Matchmaker &) = delete;
+  Matchmaker &operator=(const Matchmaker &) = delete;
+
+  void start();
+  void stop();
+
+  // False if the client is already queued.
+  bool enqueue(uint32_t clientId, std::string_view username,
+               Clock::time_point now = Clock::now());
+
+  // False if the client was not queued. Returns only after any group
+  // being seated has been handed to the callback.
+  bool cancel(uint32_t clientId);
+
+  // Forms every group that is due at `now`; returns how many. The
+  // background thread calls this; tests may drive it with their own clock.
+  size_t poll(Clock::time_point now = Clock::now());
+
+  size_t getQueuedCount() const;
+  uint64_t getRoomsFormed() const;
+  uint64_t getPlayersMatched() const;
+
+private:
+  MatchmakingConfig config_;
+  MatchCallback callback_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::list<Ticket> queue_;
+  std::unordered_map<uint32_t, std::list<Ticket>::iterator> index_;
+  std::vector<Ticket> group_;
+
+  uint64_t roomsFormed_;
+  uint64_t playersMatched_;
+
+  bool running_;
+  std::thread thread_;
+
+  size_t formGroups(Clock::time_point now);
+  bool groupDue(Clock::time_point now) const;
+  void run();
+};
+
+} // namespace net
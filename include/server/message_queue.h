@@ -1,35 +1,14 @@
 #pragma once
 
 #include "common/packet.h"
-#include <condition_variable>
-#include <mutex>
-#include <queue>
+#include "server/bounded_queue.h"
 
 namespace net {
 
-class MessageQueue {
-public:
-  MessageQueue() = default;
-  ~MessageQueue() = default;
+// Received packets for PacketCallback users; see BoundedQueue for the
+// overflow and blocking behaviour.
+using MessageQueue = BoundedQueue<Packet>;
 
-  void push(const Packet &packet);
+extern template class BoundedQueue<Packet>;
 
-  Packet pop();
-
-  bool tryPop(Packet &packet);
-
-  bool empty() const;
-
-  size_t size() const;
-
-  void clear();
-
-  void notifyAll();
-
-private:
-  mutable std::mutex mutex_;
-  std::condition_variable condition_;
-  std::queue<Packet> queue_;
-};
-
-} // namespace net
\ No newline at end of file
+} // namespace net
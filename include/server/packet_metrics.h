@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common/latency_histogram.h"
+#include "server/thread_slot_list.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace net {
+
+// Everything recorded for one MessageType, summed over all threads.
+struct PacketTypeStats {
+  // 0 collects types at or above PacketMetrics::TYPE_SLOTS.
+  uint16_t type = 0;
+  uint64_t packetsIn = 0;
+  uint64_t bytesIn = 0;
+  uint64_t packetsOut = 0;
+  uint64_t bytesOut = 0;
+  // recv -> decode: from the read that delivered the packet until it was
+  // framed, i.e. time spent behind earlier packets of the same read.
+  LatencyHistogram queued;
+  // decode -> handled: the packet callback, including what it sends.
+  LatencyHistogram handled;
+  // The time sendPacket()/broadcast() spend queueing one recipient's copy
+  // (thread-per-client also writes it to the socket there). Sampled: holds
+  // about one in PacketMetrics::SEND_SAMPLE_PERIOD sends.
+  LatencyHistogram sent;
+};
+
+// Per-MessageType packet counts, bytes and latency histograms for the
+// server's receive and send paths.
+//
+// Each recording thread owns a slot it alone writes, with plain relaxed
+// loads and stores, so recording costs a few uncontended cache lines and no
+// lock or atomic read-modify-write. snapshot() walks every slot and sums
+// them; a slot released by an exiting thread keeps its counts and is
+// reused by the next new thread. Like EpochReclaimer there is one
+// process-wide instance.
+class PacketMetrics {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Types below this get their own row.
+  static constexpr size_t TYPE_SLOTS = 32;
+  // Sends are counted individually but timed one in this many per thread;
+  // a broadcast is one send per recipient and two clock reads each would
+  // cost more than the enqueue being measured.
+  static constexpr uint32_t SEND_SAMPLE_PERIOD = 8;
+
+  PacketMetrics();
+  ~PacketMetrics();
+
+  PacketMetrics(const PacketMetrics &) = delete;
+  PacketMetrics &operator=(const PacketMetrics &) = delete;
+
+  static PacketMetrics &instance();
+
+  void recordReceived(uint16_t type, size_t bytes, Clock::duration queued,
+                      Clock::duration handled);
+  // True when the calling thread's next send should be timed.
+  bool sampleSend();
+  void recordSent(uint16_t type, size_t bytes);
+  void recordSent(uint16_t type, size_t bytes, Clock::duration sent);
+
+  // One row per type seen so far, in type order.
+  std::vector<PacketTypeStats> snapshot() const;
+
+private:
+  struct Histogram;
+  struct TypeCounters;
+  struct Slot;
+
+  ThreadSlotList<Slot> slots_;
+
+  TypeCounters &countersFor(uint16_t type);
+  TypeCounters &countSent(uint16_t type, size_t bytes);
+};
+
+// The MessageType constant's name, or nullptr for an unknown type.
+const char *messageTypeName(uint16_t type);
+
+// A fixed-width table of the snapshot: per type, packets and bytes each
+// way and p50/p99/max of each stage in microseconds.
+void writePacketStats(std::ostream &out,
+                      const std::vector<PacketTypeStats> &stats);
+
+} // namespace net
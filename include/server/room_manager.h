@@ -0,0 +1,133 @@
+#pragma once
+
+#include "common/game_state.h"
+#include "server/game_loop.h"
+#include "server/game_room.h"
+#include "server/matchmaker.h"
+#include "server/server.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace net {
+
+// Hosts many independent rooms in one process. Each room owns an
+// unsynchronized GameState and is pinned to one worker GameLoop (room id
+// modulo worker count), so rooms never share a lock or a thread with
+// anything but their worker's other rooms. I/O threads only route: a JOIN
+// takes a seat in the lowest-numbered room with space, later commands
+// follow the client's seat. With a Matchmaker attached, JOINs queue there
+// instead and each formed group gets an empty room of its own.
+class RoomManager {
+public:
+  static constexpr size_t DEFAULT_MAX_ROOMS = 16384;
+  static constexpr size_t DEFAULT_ROOM_SIZE = 6;
+
+  // workers = 0 uses one per core.
+  RoomManager(Server &server, size_t workers,
+              std::chrono::milliseconds tickInterval,
+              size_t roomSize = DEFAULT_ROOM_SIZE,
+              size_t maxRooms = DEFAULT_MAX_ROOMS);
+  ~RoomManager();
+
+  RoomManager(const RoomManager &) = delete;
+  RoomManager &operator=(const RoomManager &) = delete;
+
+  void start();
+  void stop();
+
+  // Routes JOINs through `matchmaker`, whose callback should call
+  // seatGroup(). Set before start(); rooms then never take late joiners.
+  void setMatchmaker(Matchmaker *matchmaker) { matchmaker_ = matchmaker; }
+
+  // Makes every room's deals reproducible: room N draws from
+  // Random(seed, N) instead of a fresh entropy seed. Set before start().
+  void setSeed(uint64_t seed) {
+    seeded_ = true;
+    seed_ = seed;
+  }
+
+  // Every room ends a round `timeout` after it starts, on its worker's
+  // timers (GameRoom::setRoundTimeout). Set before start().
+  void setRoundTimeout(std::chrono::milliseconds timeout) {
+    roundTimeout_ = timeout;
+  }
+
+  // Seats a matched group together in an empty room. False if every room
+  // is in use.
+  bool seatGroup(const std::vector<Matchmaker::Ticket> &group);
+
+  // Called from I/O threads with a decoded command. False if it was not
+  // routed: a command from a client without a seat, or a JOIN while every
+  // room is full.
+  bool submit(GameCommand &&command);
+
+  size_t getRoomCount() const {
+    return roomCount_.load(std::memory_order_acquire);
+  }
+  size_t getWorkerCount() const { return workers_.size(); }
+  size_t getSeatedCount() const;
+
+private:
+  struct Room {
+    GameState state;
+    GameRoom room;
+    size_t seats = 0; // guarded by lobbyMutex_
+
+    Room(Server &server, const Random &random)
+        : state(false, random), room(server, state) {}
+  };
+
+  static constexpr size_t CLIENT_SHARDS = 64;
+
+  // clientId -> roomId, sharded so chat routing from different I/O
+  // threads rarely meets on a mutex.
+  struct ClientShard {
+    std::mutex mutex;
+    std::unordered_map<uint32_t, uint32_t> rooms;
+  };
+
+  Server &server_;
+  size_t roomSize_;
+  size_t maxRooms_;
+
+  // Slots are written once under lobbyMutex_ before the first command for
+  // the room is queued, so workers read them without locking.
+  std::unique_ptr<std::unique_ptr<Room>[]> rooms_;
+  std::atomic<size_t> roomCount_;
+
+  std::mutex lobbyMutex_;
+  std::set<uint32_t> openRooms_;
+  std::vector<uint32_t> emptyRooms_; // matchmaking only
+
+  Matchmaker *matchmaker_ = nullptr;
+  bool seeded_ = false;
+  uint64_t seed_ = 0;
+  std::chrono::milliseconds roundTimeout_{0};
+
+  mutable std::array<ClientShard, CLIENT_SHARDS> clients_;
+  std::vector<std::unique_ptr<GameLoop>> workers_;
+
+  ClientShard &shardFor(uint32_t clientId) {
+    return clients_[clientId % CLIENT_SHARDS];
+  }
+
+  Random randomFor(size_t roomId) const {
+    return seeded_ ? Random(seed_, roomId) : Random::fromEntropy();
+  }
+  void createRoom(size_t roomId);
+  bool takeSeat(uint32_t &roomId);
+  bool takeEmptyRoom(uint32_t &roomId, size_t seats);
+  void releaseSeat(uint32_t roomId);
+  GameLoop &workerFor(uint32_t roomId) {
+    return *workers_[roomId % workers_.size()];
+  }
+};
+
+} // namespace net
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/packet.h"
+#include "server/connection_manager.h"
+#include <cstddef>
+
+namespace net {
+
+// What happens when a connection's queued bytes would pass the high-water
+// mark, i.e. the peer is reading slower than the server is producing.
+enum class SlowConsumerPolicy {
+  // Refuse the new packet; everything already queued still goes out.
+  DROP,
+  // Replace queued packets of the same message type with the new one
+  // (latest state wins), dropping the new packet if that is not enough.
+  COALESCE,
+  // Refuse the packet and disconnect the client.
+  DISCONNECT
+};
+
+enum class EnqueueResult { QUEUED, DROPPED, OVER_LIMIT };
+
+// The type field of an encoded packet's header; 0 if it is too short.
+uint16_t packetType(const WireBuffer &buffer);
+
+// Appends buffer to connection.sendQueue subject to highWater. The caller
+// holds connection.sendMutex. STRING_DEFINE is always queued and never
+// coalesced: the server records a string as known once it is sent, so a
+// lost definition would leave the client without it for good.
+EnqueueResult enqueueSend(ConnectionInfo &connection, const WireBuffer &buffer,
+                          size_t highWater, SlowConsumerPolicy policy);
+
+// Writes as much of connection.sendQueue as the non-blocking socket accepts,
+// batching queued packets into scatter-gather sends. Returns false on a
+// socket error. The caller holds connection.sendMutex.
+bool flushSendQueue(ConnectionInfo &connection);
+
+} // namespace net
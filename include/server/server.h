@@ -1,37 +1,95 @@
 #pragma once
 
 #include "common/packet.h"
+#include "common/platform.h"
+#include "common/receive_buffer.h"
 #include "server/connection_manager.h"
 #include "server/message_queue.h"
+#include "server/packet_metrics.h"
+#include "server/send_queue.h"
+#include "server/timer_wheel.h"
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
-#include <winsock2.h>
-#include <ws2tcpip.h>
-
-#pragma comment(lib, "ws2_32.lib")
 
 namespace net {
 
+class IoLoop;
+
+enum class ServerBackend {
+  // One blocking std::thread per accepted socket (portable).
+  THREAD_PER_CLIENT,
+  // Edge-triggered epoll reactor on a fixed pool of loop threads (Linux).
+  EPOLL,
+  // io_uring completion loops with multishot recv into a provided-buffer
+  // ring (Linux 6.0+).
+  IO_URING
+};
+
+struct ServerConfig {
+#ifdef __linux__
+  ServerBackend backend = ServerBackend::EPOLL;
+#else
+  ServerBackend backend = ServerBackend::THREAD_PER_CLIENT;
+#endif
+
+  // Number of event loop threads for reactor backends; 0 = one per core.
+  size_t ioThreads = 0;
+
+  // Reactor backends only: every loop binds its own SO_REUSEPORT listener,
+  // accepts for itself and owns its slice of the connection table, instead
+  // of loop 0 accepting for everyone.
+  bool reusePortShards = false;
+
+  // Bytes a connection may have queued for sending before the
+  // slowConsumerPolicy applies. An empty queue always takes one packet.
+  size_t sendQueueHighWater = 4 * 1024 * 1024;
+  SlowConsumerPolicy slowConsumerPolicy = SlowConsumerPolicy::DISCONNECT;
+
+  // Bound on packets held in getMessageQueue() when no callback is set;
+  // overflowPolicy applies once nobody drains it fast enough.
+  size_t messageQueueCapacity = MessageQueue::DEFAULT_CAPACITY;
+  OverflowPolicy messageQueuePolicy = OverflowPolicy::DROP_NEWEST;
+
+  // A connection that has sent nothing for heartbeatInterval is sent a
+  // HEARTBEAT (net::Client answers it); one silent for idleTimeout is
+  // disconnected. A zero idleTimeout disables both.
+  std::chrono::milliseconds heartbeatInterval{15000};
+  std::chrono::milliseconds idleTimeout{45000};
+
+  // Record per-MessageType counts, bytes and latencies into
+  // PacketMetrics::instance().
+  bool packetMetrics = true;
+};
+
 struct ClientConnection {
   uint32_t id;
   SOCKET socket;
   sockaddr_in address;
   std::thread thread;
-  bool active;
+  std::atomic<bool> active;
+  // Set as the thread exits, so the reaper can join it without waiting.
+  std::atomic<bool> finished;
 
   ClientConnection(uint32_t id, SOCKET sock, const sockaddr_in &addr)
-      : id(id), socket(sock), address(addr), active(true) {}
+      : id(id), socket(sock), address(addr), active(true), finished(false) {}
 };
 
 class Server {
 public:
   using PacketCallback = std::function<void(const Packet &, uint32_t clientId)>;
+  // Receives packets in place in the connection's receive buffer. Takes
+  // precedence over PacketCallback. Packets only reach the MessageQueue when
+  // neither callback is set.
+  using PacketViewCallback =
+      std::function<void(const PacketView &, uint32_t clientId)>;
 
   Server(uint16_t port = 8000);
+  Server(uint16_t port, const ServerConfig &config);
   ~Server();
 
   bool start();
@@ -42,16 +100,35 @@ public:
   void broadcast(const Packet &packet);
   void broadcastExcept(uint32_t excludeClientId, const Packet &packet);
 
+  // Sends to an explicit recipient list, e.g. every player holding a role.
+  // Like broadcast(), the packet is encoded once and shared by all of them.
+  void multicast(const std::vector<uint32_t> &clientIds, const Packet &packet);
+
+  // Already-encoded variants, for packets built with PacketWriter.
+  bool sendPacket(uint32_t clientId, const WireBuffer &wire);
+  void broadcast(const WireBuffer &wire);
+  void broadcastExcept(uint32_t excludeClientId, const WireBuffer &wire);
+  void multicast(const std::vector<uint32_t> &clientIds,
+                 const WireBuffer &wire);
+
   size_t getConnectionCount() const;
   void setPacketCallback(PacketCallback callback);
+  void setPacketViewCallback(PacketViewCallback callback);
   bool disconnectClient(uint32_t clientId);
 
   MessageQueue &getMessageQueue() { return messageQueue_; }
 
   ConnectionManager &getConnectionManager() { return connectionManager_; }
 
+  const ServerConfig &getConfig() const { return config_; }
+
 private:
+  friend class EventLoop;
+  friend class UringLoop;
+
   uint16_t port_;
+  ServerConfig config_;
+  size_t loopCount_;
   SOCKET serverSocket_;
   std::atomic<bool> running_;
   std::atomic<uint32_t> nextClientId_;
@@ -61,15 +138,82 @@ private:
   std::vector<std::shared_ptr<ClientConnection>> clientThreads_;
   mutable std::mutex clientThreadsMutex_;
 
+#ifdef __linux__
+  std::vector<std::unique_ptr<IoLoop>> eventLoops_;
+  std::vector<std::thread> eventLoopThreads_;
+
+  // Sharded mode: listeners for loops 1..N-1 and each loop's id sequence,
+  // touched only by its own loop.
+  std::vector<SOCKET> shardListeners_;
+  std::vector<uint32_t> shardSequences_;
+
+  void closeShardListeners();
+#endif
+
   MessageQueue messageQueue_;
   PacketCallback packetCallback_;
+  PacketViewCallback packetViewCallback_;
 
   static constexpr size_t BUFFER_SIZE = 4096;
+  // Thread-per-client: how long a client thread waits in poll() before it
+  // rechecks its send queue for packets other threads could not finish.
+  static constexpr int POLL_INTERVAL_MS = 50;
+  // Resolution of the loops' timer wheels, and how often the
+  // thread-per-client accept loop joins finished client threads.
+  static constexpr std::chrono::milliseconds TIMER_TICK{50};
+  static constexpr std::chrono::milliseconds REAP_INTERVAL{1000};
+
+  WireBuffer heartbeat_;
+  // Null when config_.packetMetrics is off.
+  PacketMetrics *metrics_;
+
+  bool usesEventLoops() const {
+    return config_.backend != ServerBackend::THREAD_PER_CLIENT;
+  }
+
+  bool openListener();
+  SOCKET createListenSocket();
+  bool runThreadPerClient();
+  bool createEventLoops();
+  bool runEventLoops();
+
+  uint32_t registerClient(SOCKET clientSocket, const sockaddr_in &clientAddr,
+                          size_t shard);
+  // Dispatches every complete packet in data and returns the bytes used.
+  // A malformed header disconnects the client and consumes everything.
+  size_t dispatchPackets(uint32_t clientId, const uint8_t *data, size_t size);
+  void processReceivedData(uint32_t clientId, ReceiveBuffer &receiveBuffer);
+  void onClientDisconnected(uint32_t clientId);
+
+  // Caller must keep connInfo pinned (see ConnectionManager::withConnection).
+  bool sendWire(ConnectionInfo &connInfo, const WireBuffer &wire);
+  bool queueWire(ConnectionInfo &connInfo, const WireBuffer &wire);
+
+  bool idleTimersEnabled() const {
+    return config_.idleTimeout > std::chrono::milliseconds::zero();
+  }
+  // Delay before a new connection's first idle check.
+  std::chrono::milliseconds firstIdleCheck() const;
+  // Run by a connection's idle timer on the thread that owns its timers.
+  // Pings a connection silent for heartbeatInterval. Returns false once it
+  // has been silent for idleTimeout and should be dropped, else sets next
+  // to the delay before the following check.
+  bool checkIdle(ConnectionInfo &connInfo,
+                 std::chrono::steady_clock::time_point now,
+                 std::chrono::steady_clock::duration &next);
+  // Thread-per-client: idle checks and reaping run on the accept loop.
+  void armIdleCheck(TimerWheel &timers, uint32_t clientId,
+                    std::chrono::steady_clock::duration delay);
+  void armReaper(TimerWheel &timers);
 
   void handleClient(std::shared_ptr<ClientConnection> client);
+  // Reads once from a client socket; returns true once it would block or
+  // the client is gone (client->active cleared).
+  bool receive(const std::shared_ptr<ClientConnection> &client,
+               ReceiveBuffer &receiveBuffer);
   void cleanupConnections();
   bool initializeWinsock();
   void cleanupWinsock();
 };
 
-} // namespace net
\ No newline at end of file
+} // namespace net
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+
+namespace net {
+
+// A grow-only, lock-free list of per-thread slots: each thread claims one
+// slot the first time it asks and only that thread writes it, while any
+// thread may walk the list to read every slot. A slot released by an
+// exiting thread keeps its contents and is reused by the next new thread,
+// so the list is as long as the most threads ever alive at once.
+//
+// Slot must provide `std::atomic<bool> claimed`, `Slot *next` and
+// `void onRelease()`, which the releasing thread calls just before it
+// gives the slot up. Slots are deleted with the list.
+//
+// A thread caches one slot per Slot type, so every thread should use a
+// single list of each type; a process-wide owner (EpochReclaimer,
+// PacketMetrics) is leaked rather than destroyed, because thread-exit
+// hooks may run after static destruction.
+template <typename Slot> class ThreadSlotList {
+public:
+  ThreadSlotList() = default;
+  ~ThreadSlotList() {
+    Slot *slot = slots_.load();
+    while (slot) {
+      Slot *next = slot->next;
+      delete slot;
+      slot = next;
+    }
+  }
+
+  ThreadSlotList(const ThreadSlotList &) = delete;
+  ThreadSlotList &operator=(const ThreadSlotList &) = delete;
+
+  // The calling thread's slot, claimed on first use.
+  Slot &local() {
+    static thread_local ThreadSlot threadSlot;
+    if (threadSlot.owner != this) {
+      threadSlot.release();
+      threadSlot.owner = this;
+      threadSlot.slot = acquire();
+    }
+    return *threadSlot.slot;
+  }
+
+  // First slot of the list; follow `next` for the rest. Slots are never
+  // unlinked, so a walk needs no protection.
+  Slot *head() const { return slots_.load(std::memory_order_acquire); }
+
+private:
+  // Releases the thread's slot for reuse when the thread exits.
+  struct ThreadSlot {
+    ThreadSlotList *owner = nullptr;
+    Slot *slot = nullptr;
+
+    ~ThreadSlot() { release(); }
+
+    void release() {
+      if (!slot)
+        return;
+      slot->onRelease();
+      slot->claimed.store(false, std::memory_order_release);
+      slot = nullptr;
+    }
+  };
+
+  std::atomic<Slot *> slots_{nullptr};
+
+  Slot *acquire() {
+    // Reuse a slot released by an exited thread before growing the list.
+    for (Slot *slot = head(); slot; slot = slot->next) {
+      bool expected = false;
+      if (!slot->claimed.load(std::memory_order_relaxed) &&
+          slot->claimed.compare_exchange_strong(expected, true))
+        return slot;
+    }
+
+    Slot *slot = new Slot();
+    slot->claimed.store(true, std::memory_order_relaxed);
+    Slot *head = slots_.load(std::memory_order_relaxed);
+    do {
+      slot->next = head;
+    } while (!slots_.compare_exchange_weak(head, slot,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+    return slot;
+  }
+};
+
+} // namespace net
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace net {
+
+// Hierarchical timing wheel: LEVELS wheels of SLOTS slots, each level's
+// slot spanning SLOTS times the one below, so 64^4 ticks fit without a
+// scan. schedule() and cancel() are O(1); advance() fires due timers and
+// moves a higher slot's timers down a level when the one below wraps.
+// Timers live in a pooled array linked into their slot by index, and a
+// bitmap per level tells the owner how long it may sleep.
+//
+// Not thread-safe: one loop thread owns a wheel and runs its callbacks.
+// Deadlines round up to whole ticks; a timer never fires early.
+class TimerWheel {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Callback = std::function<void()>;
+  // Names one scheduled timer; 0 is never a valid id. Stale ids (fired or
+  // cancelled) are ignored by cancel().
+  using TimerId = uint64_t;
+
+  static constexpr size_t LEVELS = 4;
+  static constexpr size_t SLOTS = 64;
+
+  explicit TimerWheel(std::chrono::milliseconds tick,
+                      Clock::time_point start = Clock::now());
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  TimerId schedule(Clock::duration delay, Callback callback);
+  // True if the timer was still pending.
+  bool cancel(TimerId id);
+
+  // Runs every timer due by `now`, in deadline order by tick. Callbacks may
+  // schedule and cancel. Returns how many fired.
+  size_t advance(Clock::time_point now);
+
+  // How long the owner may block before advance() has work: -1 with no
+  // timers armed, otherwise a lower bound in milliseconds (at most one
+  // lap of the lowest wheel).
+  int msUntilNext(Clock::time_point now) const;
+
+  size_t size() const { return size_; }
+  std::chrono::milliseconds tick() const { return tick_; }
+
+private:
+  static constexpr uint32_t NIL = UINT32_MAX;
+  static constexpr int BITS = 6; // log2(SLOTS)
+
+  struct Node {
+    uint64_t expires = 0; // absolute tick
+    uint32_t prev = NIL;
+    uint32_t next = NIL;
+    uint32_t generation = 0;
+    uint8_t level = 0;
+    uint8_t slot = 0;
+    bool armed = false;
+    Callback callback;
+  };
+
+  std::chrono::milliseconds tick_;
+  Clock::time_point start_;
+  uint64_t current_ = 0;
+  size_t size_ = 0;
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> free_;
+  uint32_t heads_[LEVELS][SLOTS];
+  uint64_t occupied_[LEVELS] = {};
+
+  uint64_t tickAt(Clock::time_point time) const;
+  void link(uint32_t index);
+  void unlink(uint32_t index);
+  void cascade(size_t level);
+  void release(uint32_t index);
+};
+
+} // namespace net
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "common/platform.h"
+#include "common/receive_buffer.h"
+#include "server/connection_manager.h"
+#include "server/io_loop.h"
+#include "server/timer_wheel.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unordered_map>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+namespace net {
+
+class Server;
+
+// io_uring completion loop. Loop 0 keeps one multishot accept armed, every
+// connection keeps one multishot recv armed that fills buffers from a
+// kernel-registered provided-buffer ring, and queued packets are coalesced
+// into a single SENDMSG per connection in flight. Submission and reaping share
+// one io_uring_enter() per loop iteration, which also waits no longer than
+// the next timer in the loop's TimerWheel (connection idle checks).
+class UringLoop : public IoLoop {
+public:
+  UringLoop(Server &server, size_t index);
+  ~UringLoop() override;
+
+  UringLoop(const UringLoop &) = delete;
+  UringLoop &operator=(const UringLoop &) = delete;
+
+  bool init() override;
+
+  bool watchListener(SOCKET listenSocket) override;
+
+  void run() override;
+
+  void wakeup() override;
+
+  void adopt(std::shared_ptr<ConnectionInfo> connection) override;
+
+  void scheduleFlush(ConnectionInfo &connection) override;
+
+private:
+  enum class Op : uint8_t { ACCEPT = 1, WAKEUP, MESSAGE, RECV, SEND, CANCEL };
+
+  struct LoopConnection {
+    std::shared_ptr<ConnectionInfo> info;
+    ReceiveBuffer receiveBuffer;
+    // Packets referenced by the kernel until the SENDMSG completes;
+    // inflightOffset counts bytes already sent from the front one.
+    std::vector<WireBuffer> inflight;
+    size_t inflightOffset = 0;
+    std::vector<iovec> iovecs;
+    msghdr message{};
+    bool sending = false;
+    bool receiving = false;
+    TimerWheel::TimerId idleTimer = 0;
+  };
+
+  static constexpr unsigned RING_ENTRIES = 4096;
+  static constexpr unsigned BUFFER_COUNT = 4096;
+  static constexpr unsigned BUFFER_SIZE = 4096;
+  static constexpr uint16_t BUFFER_GROUP = 0;
+  static constexpr size_t MAX_SEND_IOVECS = 256;
+
+  Server &server_;
+  size_t index_;
+
+  int ringFd_;
+  void *sqRing_;
+  size_t sqRingSize_;
+  void *cqRing_;
+  size_t cqRingSize_;
+  io_uring_sqe *sqes_;
+  size_t sqesSize_;
+  unsigned *sqHead_;
+  unsigned *sqTail_;
+  unsigned sqMask_;
+  unsigned sqEntries_;
+  unsigned *cqHead_;
+  unsigned *cqTail_;
+  unsigned cqMask_;
+  io_uring_cqe *cqes_;
+  unsigned sqLocalTail_;
+  size_t inflightOps_;
+
+  io_uring_buf *bufferRing_;
+  size_t bufferRingSize_;
+  std::vector<uint8_t> bufferPool_;
+  uint16_t bufferTail_;
+
+  int wakeupFd_;
+  uint64_t wakeupValue_;
+  std::atomic<bool> notified_;
+
+  SOCKET listenSocket_;
+
+  std::unordered_map<uint32_t, LoopConnection> connections_;
+  TimerWheel timers_;
+
+  std::mutex pendingMutex_;
+  std::vector<std::shared_ptr<ConnectionInfo>> pending_;
+  std::vector<uint32_t> flushQueue_;
+
+  bool setupRing();
+  bool setupBufferRing();
+
+  io_uring_sqe *nextSqe();
+  // timeoutMs < 0 waits for minComplete completions however long it takes.
+  int submitAndWait(unsigned minComplete, int timeoutMs = -1);
+  void reapCompletions();
+  void handleCompletion(const io_uring_cqe &cqe);
+
+  void armAccept();
+  void armWakeup();
+  void armRecv(uint32_t clientId, SOCKET socket);
+  void submitSend(uint32_t clientId, LoopConnection &connection);
+  void recycleBuffer(uint16_t bufferId);
+  void notify();
+
+  void drainPending();
+  void drainFlushQueue();
+  void registerConnection(std::shared_ptr<ConnectionInfo> connection);
+  void onAccept(int result);
+  void onRecv(uint32_t clientId, int result, uint32_t flags);
+  void onSend(uint32_t clientId, int result);
+  void armIdleTimer(uint32_t clientId, TimerWheel::Clock::duration delay);
+  void onIdleTimer(uint32_t clientId);
+  void closeConnection(uint32_t clientId);
+  void shutdownAll();
+
+  static uint64_t encode(Op op, uint32_t clientId);
+};
+
+} // namespace net
@@ -10,16 +10,22 @@ Client::Client()
 Client::~Client() { disconnect(); }
 
 bool Client::initializeWinsock() {
+#ifdef _WIN32
   WSADATA wsaData;
   int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
   if (result != 0) {
     std::cerr << "WSAStartup failed: " << result << std::endl;
     return false;
   }
+#endif
   return true;
 }
 
-void Client::cleanupWinsock() { WSACleanup(); }
+void Client::cleanupWinsock() {
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
 
 bool Client::connect(const std::string &serverAddress, uint16_t port) {
   if (connected_)
@@ -54,6 +60,8 @@ bool Client::connect(const std::string &serverAddress, uint16_t port) {
     return false;
   }
 
+  receiveBuffer_.clear();
+  heldBytes_ = 0;
   connected_ = true;
   std::cout << "Connected to server at " << serverAddress << ":" << port
             << std::endl;
@@ -62,9 +70,14 @@ bool Client::connect(const std::string &serverAddress, uint16_t port) {
 }
 
 void Client::disconnect() {
-  if (!connected_)
+  // A connection the server closed still owns its socket.
+  if (!connected_ && socket_ == INVALID_SOCKET)
     return;
 
+  // Unblock a receiving thread parked in recv() before joining it.
+  if (socket_ != INVALID_SOCKET)
+    shutdown(socket_, SHUT_RDWR);
+
   stopReceiving();
 
   connected_ = false;
@@ -87,7 +100,7 @@ bool Client::sendPacket(const Packet &packet) {
   std::vector<uint8_t> data = packet.serialize();
 
   int bytesSent = send(socket_, reinterpret_cast<const char *>(data.data()),
-                       static_cast<int>(data.size()), 0);
+                       static_cast<int>(data.size()), SEND_FLAGS);
 
   if (bytesSent == SOCKET_ERROR) {
     int error = WSAGetLastError();
@@ -106,46 +119,46 @@ bool Client::sendPacket(const Packet &packet) {
 }
 
 bool Client::receivePacket(Packet &packet) {
-  if (!connected_)
+  PacketView view;
+  if (!receivePacketView(view))
     return false;
 
-  std::vector<uint8_t> receiveBuffer;
-  receiveBuffer.resize(BUFFER_SIZE);
+  packet = view.toPacket();
+  return true;
+}
 
-  while (connected_) {
-    // Check if we have a complete packet in the buffer
-    if (!packetBuffer_.empty() &&
-        Packet::isCompletePacket(packetBuffer_.data(), packetBuffer_.size())) {
-      packet = Packet::deserialize(packetBuffer_.data(), packetBuffer_.size());
-      size_t packetSize = packet.getTotalSize();
+bool Client::receivePacketView(PacketView &view) {
+  // The previous view is no longer needed once the caller asks again.
+  receiveBuffer_.consume(heldBytes_);
+  heldBytes_ = 0;
 
-      // Remove the processed packet from the buffer
-      packetBuffer_.erase(packetBuffer_.begin(),
-                          packetBuffer_.begin() + packetSize);
+  while (connected_) {
+    FrameResult result =
+        PacketView::frame(receiveBuffer_.data(), receiveBuffer_.size(), view);
+
+    if (result == FrameResult::COMPLETE) {
+      if (view.getType() == 0 || view.getType() == MessageType::HEARTBEAT) {
+        answerHeartbeat(view);
+        receiveBuffer_.consume(view.getTotalSize());
+        continue;
+      }
+      heldBytes_ = view.getTotalSize();
+      return true;
+    }
 
-      return packet.getType() != 0;
+    if (result == FrameResult::MALFORMED) {
+      std::cerr << "Malformed packet header from server" << std::endl;
+      connected_ = false;
+      return false;
     }
 
+    uint8_t *tail = receiveBuffer_.prepare(BUFFER_SIZE);
     int bytesReceived =
-        recv(socket_, reinterpret_cast<char *>(receiveBuffer.data()),
-             BUFFER_SIZE, 0);
+        recv(socket_, reinterpret_cast<char *>(tail),
+             static_cast<int>(receiveBuffer_.writable()), 0);
 
     if (bytesReceived > 0) {
-      packetBuffer_.insert(packetBuffer_.end(), receiveBuffer.data(),
-                           receiveBuffer.data() + bytesReceived);
-
-      if (Packet::isCompletePacket(packetBuffer_.data(),
-                                   packetBuffer_.size())) {
-        packet =
-            Packet::deserialize(packetBuffer_.data(), packetBuffer_.size());
-        size_t packetSize = packet.getTotalSize();
-
-        // Remove the processed packet from the buffer
-        packetBuffer_.erase(packetBuffer_.begin(),
-                            packetBuffer_.begin() + packetSize);
-
-        return packet.getType() != 0;
-      }
+      receiveBuffer_.commit(static_cast<size_t>(bytesReceived));
     } else if (bytesReceived == 0) {
       connected_ = false;
       return false;
@@ -165,19 +178,53 @@ bool Client::tryReceivePacket(Packet &packet) {
   if (!connected_)
     return false;
 
-  if (!packetBuffer_.empty() &&
-      Packet::isCompletePacket(packetBuffer_.data(), packetBuffer_.size())) {
-    packet = Packet::deserialize(packetBuffer_.data(), packetBuffer_.size());
-    size_t packetSize = packet.getTotalSize();
-    packetBuffer_.erase(packetBuffer_.begin(),
-                        packetBuffer_.begin() + packetSize);
-    return packet.getType() != 0;
+  receiveBuffer_.consume(heldBytes_);
+  heldBytes_ = 0;
+
+  // Only frames what has already arrived; never blocks in recv().
+  PacketView view;
+  while (PacketView::frame(receiveBuffer_.data(), receiveBuffer_.size(),
+                           view) == FrameResult::COMPLETE) {
+    answerHeartbeat(view);
+    receiveBuffer_.consume(view.getTotalSize());
+    if (view.getType() != 0 && view.getType() != MessageType::HEARTBEAT) {
+      packet = view.toPacket();
+      return true;
+    }
   }
 
-  // Try to receive without blocking (non-blocking socket would be needed)
   return false;
 }
 
+bool Client::readAvailable() {
+  if (!connected_)
+    return false;
+
+  receiveBuffer_.consume(heldBytes_);
+  heldBytes_ = 0;
+
+  uint8_t *tail = receiveBuffer_.prepare(BUFFER_SIZE);
+  int bytesReceived = recv(socket_, reinterpret_cast<char *>(tail),
+                           static_cast<int>(receiveBuffer_.writable()), 0);
+  if (bytesReceived > 0) {
+    receiveBuffer_.commit(static_cast<size_t>(bytesReceived));
+    return true;
+  }
+
+  if (bytesReceived < 0) {
+    int error = WSAGetLastError();
+    if (error != WSAECONNRESET)
+      std::cerr << "Receive failed: " << error << std::endl;
+  }
+  connected_ = false;
+  return false;
+}
+
+void Client::answerHeartbeat(const PacketView &view) {
+  if (view.getType() == MessageType::HEARTBEAT)
+    sendPacket(Packet(MessageType::HEARTBEAT, std::vector<uint8_t>()));
+}
+
 void Client::setPacketCallback(PacketCallback callback) {
   packetCallback_ = callback;
 }
@@ -2,6 +2,7 @@
 #include "common/game_state.h"
 #include "common/packet.h"
 #include "common/serialization.h"
+#include "common/state_sync.h"
 #include <cctype>
 #include <chrono>
 #include <conio.h>
@@ -16,6 +17,10 @@ using namespace net;
 
 std::map<uint32_t, PlayerState> players;
 std::mutex playersMutex;
+// Receive thread only: snapshots the server may send deltas against, and
+// the text of the usernames, topics and words it has sent by id.
+SnapshotTracker snapshots;
+StringDictionary strings;
 
 void printStatusBar() {
   std::lock_guard<std::mutex> lock(playersMutex);
@@ -81,14 +86,37 @@ int main(int argc, char *argv[]) {
     uint16_t packetType = packet.getType();
 
     switch (packetType) {
+    case MessageType::STRING_DEFINE: {
+      for (const auto &definition : extractStringDefinitions(packet))
+        strings.define(definition.id, definition.text);
+      break;
+    }
+
     case MessageType::GAME_STATE_UPDATE: {
       static bool initialStateReceived = false;
-      auto allPlayers = extractGameStateUpdate(packet);
+      StateUpdate update = extractGameStateUpdate(packet, strings);
+      if (!snapshots.apply(update)) {
+        // Missing the baseline: ask for the whole state again.
+        client.sendPacket(createStateAckPacket(0));
+        break;
+      }
+      client.sendPacket(createStateAckPacket(update.snapshotId));
       {
         std::lock_guard<std::mutex> lock(playersMutex);
-        players.clear();
-        for (const auto &player : allPlayers)
-          players[player.id] = player;
+        if (update.isFull()) {
+          players.clear();
+          for (const auto &player : snapshots.players())
+            players[player.id] = player;
+        } else {
+          for (uint32_t id : update.removed)
+            players.erase(id);
+          for (const auto &player : snapshots.players()) {
+            for (const auto &delta : update.players) {
+              if (delta.id == player.id)
+                players[player.id] = player;
+            }
+          }
+        }
       }
       std::cout << std::endl;
       if (!initialStateReceived) {
@@ -109,7 +137,7 @@ int main(int argc, char *argv[]) {
     }
 
     case MessageType::PLAYER_JOINED: {
-      PlayerState newPlayer = extractPlayerState(packet);
+      PlayerState newPlayer = extractPlayerState(packet, strings);
       {
         std::lock_guard<std::mutex> lock(playersMutex);
         players[newPlayer.id] = newPlayer;
@@ -122,7 +150,7 @@ int main(int argc, char *argv[]) {
     }
 
     case MessageType::PLAYER_LEAVE: {
-      PlayerState leavingPlayer = extractPlayerState(packet);
+      PlayerState leavingPlayer = extractPlayerState(packet, strings);
       {
         std::lock_guard<std::mutex> lock(playersMutex);
         players.erase(leavingPlayer.id);
@@ -135,14 +163,14 @@ int main(int argc, char *argv[]) {
     }
 
     case MessageType::CHAT_BROADCAST: {
-      ChatMessage chatMessage = extractChatMessage(packet);
+      ChatMessage chatMessage = extractChatMessage(packet, strings);
       std::cout << std::endl;
       printChatMessage(chatMessage.senderUsername, chatMessage.senderMessage);
       break;
     }
 
     case MessageType::ROLE_ASSIGNMENT: {
-      RoleAssignment assignment = extractRoleAssignment(packet);
+      RoleAssignment assignment = extractRoleAssignment(packet, strings);
       std::cout << std::endl;
       std::cout
           << "============================================================"
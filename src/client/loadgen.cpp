@@ -0,0 +1,580 @@
+#include "client/client.h"
+#include "common/latency_histogram.h"
+#include "common/packet.h"
+#include "common/random.h"
+#include "common/serialization.h"
+#include "common/state_sync.h"
+#include "common/string_table.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Scripted load against a game_server: N bots join, chat, vote and
+// reconnect on their own schedules, and the run ends with latency
+// percentiles and counts.
+//
+// Every action is open loop: it has an intended time drawn up front
+// (a Poisson process for chat, the ramp for joins), and a bot that falls
+// behind still sends everything that came due, each stamped with its own
+// intended time. Latency is measured from that intended time, so a stall
+// in the server -- or in this process -- shows up in the percentiles
+// instead of silently delaying the next request (coordinated omission).
+// The raw chat row measures from the actual send for comparison.
+//
+// Aim it at `game_server --rooms` (or --matchmaking): the default mode has
+// a single table of six seats.
+
+using namespace net;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string host = "127.0.0.1";
+  long port = 8000;
+  long bots = 100;
+  long threads = 2;
+  double durationS = 30.0;
+  double rampS = 5.0;
+  // Chat messages per bot per second, Poisson.
+  double chatRate = 0.5;
+  // Mean delay from a role assignment to the bot's vote.
+  long voteDelayMs = 2000;
+  // Mean session length before a bot leaves and rejoins; 0 stays for the
+  // whole run.
+  double sessionS = 0.0;
+  bool seeded = false;
+  uint64_t seed = 0;
+};
+
+// After the run, in-flight replies get this long before bots disconnect.
+constexpr auto DRAIN = std::chrono::milliseconds(500);
+// Wait before retrying a failed connect or rejoining after a drop.
+constexpr auto RETRY_DELAY = std::chrono::seconds(1);
+// Longest a worker sleeps in poll() with nothing due.
+constexpr int MAX_POLL_MS = 10;
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--host ADDR] [--port N] [--bots N] [--threads N]"
+               " [--duration-s S] [--ramp-s S] [--chat-rate R]"
+               " [--vote-delay-ms N] [--session-s S] [--seed N]"
+            << std::endl;
+}
+
+uint64_t nanosBetween(Clock::time_point from, Clock::time_point to) {
+  auto nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+  return nanos > 0 ? static_cast<uint64_t>(nanos) : 0;
+}
+
+// Uniform in [0, 1).
+double uniform(Random &random) {
+  return static_cast<double>(random.next() >> 11) * 0x1.0p-53;
+}
+
+Clock::duration exponential(Random &random, double mean) {
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(-std::log(1.0 - uniform(random)) * mean));
+}
+
+// Totals of one worker. Written only by the worker; the main thread reads
+// them for the once-a-second progress line.
+struct Counters {
+  std::atomic<uint64_t> connects{0};
+  std::atomic<uint64_t> connectFailures{0};
+  std::atomic<uint64_t> reconnects{0};
+  std::atomic<uint64_t> drops{0};
+  std::atomic<uint64_t> joined{0};
+  std::atomic<uint64_t> chatsSent{0};
+  std::atomic<uint64_t> chatsEchoed{0};
+  std::atomic<uint64_t> chatsUnanswered{0};
+  std::atomic<uint64_t> votesSent{0};
+  std::atomic<uint64_t> roles{0};
+  std::atomic<uint64_t> voteResults{0};
+  // Total time bots spent seated, for the target chat rate.
+  std::atomic<uint64_t> seatedNanos{0};
+
+  void bump(std::atomic<uint64_t> &counter, uint64_t amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount,
+                  std::memory_order_relaxed);
+  }
+};
+
+struct Latencies {
+  LatencyHistogram join;
+  LatencyHistogram chat;
+  LatencyHistogram chatRaw;
+
+  void merge(const Latencies &other) {
+    join.merge(other.join);
+    chat.merge(other.chat);
+    chatRaw.merge(other.chatRaw);
+  }
+};
+
+struct PendingChat {
+  uint64_t seq;
+  Clock::time_point intended;
+  Clock::time_point sent;
+};
+
+struct Bot {
+  enum class Phase { OFFLINE, JOINING, SEATED };
+
+  uint32_t index = 0;
+  uint32_t generation = 0;
+  Phase phase = Phase::OFFLINE;
+  Random random{0};
+  std::unique_ptr<Client> client;
+  std::string name;
+  uint32_t playerId = 0;
+
+  // Intended times; time_point::max() when nothing is scheduled.
+  Clock::time_point connectAt = Clock::time_point::max();
+  Clock::time_point nextChat = Clock::time_point::max();
+  Clock::time_point voteAt = Clock::time_point::max();
+  Clock::time_point leaveAt = Clock::time_point::max();
+  Clock::time_point seatedAt;
+
+  uint64_t chatSeq = 0;
+  // Chats awaiting their broadcast, oldest first; one room echoes them in
+  // the order they were sent.
+  std::deque<PendingChat> pending;
+  StringDictionary strings;
+  SnapshotTracker snapshots;
+
+  Clock::time_point nextDue() const {
+    return std::min({connectAt, nextChat, voteAt, leaveAt});
+  }
+};
+
+class Worker {
+public:
+  Worker(const Options &options, Counters &counters)
+      : options_(options), counters_(counters) {}
+
+  void addBot(uint32_t index, uint64_t seed, Clock::time_point connectAt) {
+    Bot bot;
+    bot.index = index;
+    bot.random = Random(seed, index);
+    bot.client = std::make_unique<Client>();
+    bot.connectAt = connectAt;
+    bots_.push_back(std::move(bot));
+  }
+
+  void run(Clock::time_point end);
+
+  const Latencies &latencies() const { return latencies_; }
+
+private:
+  const Options &options_;
+  Counters &counters_;
+  std::vector<Bot> bots_;
+  Latencies latencies_;
+  std::vector<pollfd> descriptors_;
+  std::vector<Bot *> polled_;
+
+  void poll(Clock::time_point until, bool act);
+  void runDue(Bot &bot, Clock::time_point now);
+  void connect(Bot &bot, Clock::time_point now);
+  void leave(Bot &bot, Clock::time_point now);
+  void handle(Bot &bot, const Packet &packet, Clock::time_point now);
+  void onChat(Bot &bot, const ChatMessage &message, Clock::time_point now);
+  void sendChat(Bot &bot, Clock::time_point intended, Clock::time_point now);
+  void sendVote(Bot &bot);
+};
+
+void Worker::run(Clock::time_point end) {
+  while (Clock::now() < end)
+    poll(end, true);
+
+  // Stop scheduling; give replies already in flight a moment to land.
+  Clock::time_point drainEnd = Clock::now() + DRAIN;
+  while (Clock::now() < drainEnd)
+    poll(drainEnd, false);
+
+  // Seated time is counted up to the end of the run, not the drain.
+  for (Bot &bot : bots_) {
+    if (bot.phase != Bot::Phase::OFFLINE)
+      leave(bot, end);
+  }
+}
+
+void Worker::poll(Clock::time_point until, bool act) {
+  descriptors_.clear();
+  polled_.clear();
+  Clock::time_point due = until;
+  for (Bot &bot : bots_) {
+    if (bot.phase != Bot::Phase::OFFLINE) {
+      pollfd descriptor{};
+      descriptor.fd = bot.client->getSocket();
+      descriptor.events = POLLIN;
+      descriptors_.push_back(descriptor);
+      polled_.push_back(&bot);
+    }
+    if (act)
+      due = std::min(due, bot.nextDue());
+  }
+
+  Clock::time_point now = Clock::now();
+  int timeoutMs = 0;
+  if (due > now) {
+    auto wait =
+        std::chrono::ceil<std::chrono::milliseconds>(due - now).count();
+    timeoutMs = static_cast<int>(std::min<long long>(wait, MAX_POLL_MS));
+  }
+
+  int ready = 0;
+  if (descriptors_.empty())
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+  else
+    ready = pollSockets(descriptors_.data(),
+                        static_cast<unsigned long>(descriptors_.size()),
+                        timeoutMs);
+
+  now = Clock::now();
+  for (size_t i = 0; ready > 0 && i < descriptors_.size(); ++i) {
+    if (descriptors_[i].revents == 0)
+      continue;
+    --ready;
+    Bot &bot = *polled_[i];
+    bool open = bot.client->readAvailable();
+    Packet packet;
+    while (bot.client->tryReceivePacket(packet))
+      handle(bot, packet, now);
+    if (!open && bot.phase != Bot::Phase::OFFLINE) {
+      counters_.bump(counters_.drops);
+      leave(bot, now);
+      bot.connectAt = now + RETRY_DELAY;
+    }
+  }
+
+  if (!act)
+    return;
+  now = Clock::now();
+  for (Bot &bot : bots_) {
+    if (bot.nextDue() <= now)
+      runDue(bot, now);
+  }
+}
+
+void Worker::runDue(Bot &bot, Clock::time_point now) {
+  if (bot.connectAt <= now) {
+    connect(bot, now);
+    return;
+  }
+  if (bot.leaveAt <= now) {
+    leave(bot, now);
+    counters_.bump(counters_.reconnects);
+    bot.connectAt = now;
+    return;
+  }
+
+  // Open loop: send every chat that has come due, each with the intended
+  // time it was scheduled for.
+  while (bot.nextChat <= now && bot.client->isConnected()) {
+    Clock::time_point intended = bot.nextChat;
+    bot.nextChat += exponential(bot.random, 1.0 / options_.chatRate);
+    sendChat(bot, intended, now);
+  }
+  if (bot.voteAt <= now) {
+    bot.voteAt = Clock::time_point::max();
+    sendVote(bot);
+  }
+}
+
+void Worker::connect(Bot &bot, Clock::time_point now) {
+  Clock::time_point intended = bot.connectAt;
+  bot.connectAt = Clock::time_point::max();
+  if (!bot.client->connect(options_.host,
+                           static_cast<uint16_t>(options_.port))) {
+    counters_.bump(counters_.connectFailures);
+    bot.connectAt = now + RETRY_DELAY;
+    return;
+  }
+  counters_.bump(counters_.connects);
+
+  int noDelay = 1;
+  setsockopt(bot.client->getSocket(), IPPROTO_TCP, TCP_NODELAY,
+             reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+
+  bot.name = "bot" + std::to_string(bot.index) + "-" +
+             std::to_string(bot.generation++);
+  bot.phase = Bot::Phase::JOINING;
+  bot.playerId = 0;
+  bot.strings = StringDictionary();
+  bot.snapshots = SnapshotTracker();
+  // The join is timed from when it was due, so a slow connect counts.
+  bot.seatedAt = intended;
+  bot.client->sendPacket(Packet(MessageType::PLAYER_JOIN, bot.name));
+}
+
+void Worker::leave(Bot &bot, Clock::time_point now) {
+  if (bot.phase == Bot::Phase::SEATED)
+    counters_.bump(counters_.seatedNanos, nanosBetween(bot.seatedAt, now));
+  counters_.bump(counters_.chatsUnanswered, bot.pending.size());
+  bot.pending.clear();
+  bot.client->disconnect();
+  bot.phase = Bot::Phase::OFFLINE;
+  bot.nextChat = Clock::time_point::max();
+  bot.voteAt = Clock::time_point::max();
+  bot.leaveAt = Clock::time_point::max();
+}
+
+void Worker::handle(Bot &bot, const Packet &packet, Clock::time_point now) {
+  switch (packet.getType()) {
+  case MessageType::STRING_DEFINE:
+    for (const auto &definition : extractStringDefinitions(packet))
+      bot.strings.define(definition.id, definition.text);
+    break;
+
+  case MessageType::GAME_STATE_UPDATE: {
+    StateUpdate update = extractGameStateUpdate(packet, bot.strings);
+    bool applied = bot.snapshots.apply(update);
+    bot.client->sendPacket(createStateAckPacket(applied ? update.snapshotId
+                                                        : 0));
+    // The first snapshot means the bot has a seat.
+    if (bot.phase == Bot::Phase::JOINING) {
+      latencies_.join.record(nanosBetween(bot.seatedAt, now));
+      counters_.bump(counters_.joined);
+      bot.phase = Bot::Phase::SEATED;
+      bot.seatedAt = now;
+      if (options_.chatRate > 0)
+        bot.nextChat =
+            now + exponential(bot.random, 1.0 / options_.chatRate);
+      if (options_.sessionS > 0)
+        bot.leaveAt = now + exponential(bot.random, options_.sessionS);
+    }
+    break;
+  }
+
+  case MessageType::CHAT_BROADCAST:
+    onChat(bot, extractChatMessage(packet, bot.strings), now);
+    break;
+
+  case MessageType::ROLE_ASSIGNMENT: {
+    counters_.bump(counters_.roles);
+    bot.playerId = extractRoleAssignment(packet, bot.strings).playerId;
+    double delay = static_cast<double>(options_.voteDelayMs) *
+                   (0.5 + uniform(bot.random));
+    bot.voteAt = now + std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double, std::milli>(delay));
+    break;
+  }
+
+  case MessageType::VOTE_RESULT:
+    counters_.bump(counters_.voteResults);
+    bot.voteAt = Clock::time_point::max();
+    break;
+
+  default:
+    break;
+  }
+}
+
+void Worker::onChat(Bot &bot, const ChatMessage &message,
+                    Clock::time_point now) {
+  if (message.senderUsername != bot.name ||
+      message.senderMessage.compare(0, 5, "chat ") != 0)
+    return;
+
+  uint64_t seq = std::strtoull(message.senderMessage.c_str() + 5, nullptr, 10);
+  // Anything older than this echo is not coming.
+  while (!bot.pending.empty() && bot.pending.front().seq < seq) {
+    counters_.bump(counters_.chatsUnanswered);
+    bot.pending.pop_front();
+  }
+  if (bot.pending.empty() || bot.pending.front().seq != seq)
+    return;
+
+  latencies_.chat.record(nanosBetween(bot.pending.front().intended, now));
+  latencies_.chatRaw.record(nanosBetween(bot.pending.front().sent, now));
+  counters_.bump(counters_.chatsEchoed);
+  bot.pending.pop_front();
+}
+
+void Worker::sendChat(Bot &bot, Clock::time_point intended,
+                      Clock::time_point now) {
+  uint64_t seq = bot.chatSeq++;
+  if (!bot.client->sendPacket(
+          Packet(MessageType::CHAT_MESSAGE, "chat " + std::to_string(seq))))
+    return;
+  bot.pending.push_back({seq, intended, now});
+  counters_.bump(counters_.chatsSent);
+}
+
+void Worker::sendVote(Bot &bot) {
+  std::vector<const PlayerState *> others;
+  for (const auto &player : bot.snapshots.players()) {
+    if (player.id != bot.playerId && player.username != bot.name)
+      others.push_back(&player);
+  }
+  if (others.empty())
+    return;
+
+  const PlayerState &target =
+      *others[bot.random.below(static_cast<uint32_t>(others.size()))];
+  if (bot.client->sendPacket(Packet(MessageType::CHAT_MESSAGE,
+                                    "/vote " + target.username.str())))
+    counters_.bump(counters_.votesSent);
+}
+
+uint64_t sum(const std::vector<std::unique_ptr<Counters>> &counters,
+             std::atomic<uint64_t> Counters::*field) {
+  uint64_t total = 0;
+  for (const auto &worker : counters)
+    total += (worker.get()->*field).load(std::memory_order_relaxed);
+  return total;
+}
+
+void writeLatencyRow(std::ostream &out, const char *name,
+                     const LatencyHistogram &histogram) {
+  auto millis = [](uint64_t nanos) { return static_cast<double>(nanos) / 1e6; };
+  out << std::left << std::setw(12) << name << std::right << std::setw(10)
+      << histogram.total;
+  for (double q : {0.5, 0.9, 0.99, 0.999})
+    out << std::setw(10) << millis(histogram.percentile(q));
+  out << std::setw(10) << millis(histogram.maxNanos) << '\n';
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--host" && i + 1 < argc) {
+      options.host = argv[++i];
+    } else if (arg == "--port" && i + 1 < argc) {
+      options.port = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--bots" && i + 1 < argc) {
+      options.bots = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      options.threads = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--duration-s" && i + 1 < argc) {
+      options.durationS = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--ramp-s" && i + 1 < argc) {
+      options.rampS = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--chat-rate" && i + 1 < argc) {
+      options.chatRate = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--vote-delay-ms" && i + 1 < argc) {
+      options.voteDelayMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--session-s" && i + 1 < argc) {
+      options.sessionS = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      options.seeded = true;
+      options.seed = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (options.port <= 0 || options.port > 65535 || options.bots <= 0 ||
+      options.threads <= 0 || options.durationS <= 0 || options.rampS < 0 ||
+      options.chatRate < 0 || options.voteDelayMs < 0 ||
+      options.sessionS < 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  options.threads = std::min(options.threads, options.bots);
+  uint64_t seed =
+      options.seeded ? options.seed : Random::fromEntropy().next();
+
+  // Client logs every connect and disconnect to stdout; keep the terminal
+  // for progress and the report.
+  std::streambuf *console = std::cout.rdbuf();
+  std::ostream out(console);
+  std::cout.rdbuf(nullptr);
+
+  out << "Load: " << options.bots << " bots on " << options.threads
+      << " threads against " << options.host << ":" << options.port
+      << " for " << options.durationS << " s (ramp " << options.rampS
+      << " s, " << options.chatRate << " chats/s per bot, seed " << seed
+      << ")" << std::endl;
+
+  std::vector<std::unique_ptr<Counters>> counters;
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (long i = 0; i < options.threads; ++i) {
+    counters.push_back(std::make_unique<Counters>());
+    workers.push_back(std::make_unique<Worker>(options, *counters.back()));
+  }
+
+  Clock::time_point start = Clock::now();
+  Clock::time_point end =
+      start + std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(options.durationS));
+  for (long i = 0; i < options.bots; ++i) {
+    auto offset = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.rampS * static_cast<double>(i) /
+                                      static_cast<double>(options.bots)));
+    workers[static_cast<size_t>(i % options.threads)]->addBot(
+        static_cast<uint32_t>(i), seed, start + offset);
+  }
+
+  std::vector<std::thread> threads;
+  for (auto &worker : workers)
+    threads.emplace_back([&worker, end]() { worker->run(end); });
+
+  // Progress once a second until the run ends.
+  uint64_t lastSent = 0;
+  uint64_t lastEchoed = 0;
+  for (int second = 1; Clock::now() + std::chrono::seconds(1) <= end;
+       ++second) {
+    std::this_thread::sleep_until(start + std::chrono::seconds(second));
+    uint64_t sent = sum(counters, &Counters::chatsSent);
+    uint64_t echoed = sum(counters, &Counters::chatsEchoed);
+    out << std::setw(4) << second << "s  joined "
+        << sum(counters, &Counters::joined) << "  chats/s " << sent - lastSent
+        << " sent " << echoed - lastEchoed << " echoed  votes "
+        << sum(counters, &Counters::votesSent) << "  drops "
+        << sum(counters, &Counters::drops) << std::endl;
+    lastSent = sent;
+    lastEchoed = echoed;
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+  std::cout.rdbuf(console);
+
+  Latencies latencies;
+  for (const auto &worker : workers)
+    latencies.merge(worker->latencies());
+
+  uint64_t chatsSent = sum(counters, &Counters::chatsSent);
+  double seatedSeconds =
+      static_cast<double>(sum(counters, &Counters::seatedNanos)) / 1e9;
+  out << "\nConnects " << sum(counters, &Counters::connects) << " ("
+      << sum(counters, &Counters::connectFailures) << " failed), joined "
+      << sum(counters, &Counters::joined) << ", reconnects "
+      << sum(counters, &Counters::reconnects) << ", drops "
+      << sum(counters, &Counters::drops) << '\n';
+  out << std::fixed << std::setprecision(1);
+  out << "Chats sent " << chatsSent << " (" << chatsSent / options.durationS
+      << "/s, target " << seatedSeconds * options.chatRate / options.durationS
+      << "/s), echoed " << sum(counters, &Counters::chatsEchoed)
+      << ", unanswered " << sum(counters, &Counters::chatsUnanswered) << '\n';
+  out << "Roles " << sum(counters, &Counters::roles) << ", votes sent "
+      << sum(counters, &Counters::votesSent) << ", vote results "
+      << sum(counters, &Counters::voteResults) << "\n\n";
+
+  out << std::setprecision(2) << std::left << std::setw(12) << "latency ms"
+      << std::right << std::setw(10) << "samples" << std::setw(10) << "p50"
+      << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10)
+      << "p99.9" << std::setw(10) << "max" << '\n';
+  writeLatencyRow(out, "join", latencies.join);
+  writeLatencyRow(out, "chat", latencies.chat);
+  writeLatencyRow(out, "chat raw", latencies.chatRaw);
+  out.flush();
+  return 0;
+}
@@ -1,11 +1,10 @@
 #include "common/game_state.h"
 #include <algorithm>
 #include <iostream>
-#include <random>
 
 namespace net {
 
-const std::vector<std::pair<std::string, std::vector<std::string>>>
+const std::vector<std::pair<InternedString, std::vector<InternedString>>>
     GameState::TOPIC_WORDS = {
         {"Fruit",
          {"Apple", "Banana", "Orange", "Grape", "Strawberry", "Watermelon",
@@ -25,36 +24,202 @@ const std::vector<std::pair<std::string, std::vector<std::string>>>
          {"Soccer", "Basketball", "Tennis", "Swimming", "Running", "Cycling",
           "Golf", "Baseball"}}};
 
-GameState::GameState()
-    : roundActive_(false), currentTopic_(), currentWord_(), currentLiarId_(0) {}
+GameState::GameState(bool synchronized)
+    : GameState(synchronized, Random::fromEntropy()) {}
+
+GameState::GameState(bool synchronized, const Random &random)
+    : synchronized_(synchronized), random_(random), roundActive_(false),
+      currentTopic_(), currentWord_(), currentLiarId_(0) {}
+
+std::unique_lock<std::mutex> GameState::acquire() const {
+  if (!synchronized_)
+    return std::unique_lock<std::mutex>();
+  return std::unique_lock<std::mutex>(mutex_);
+}
+
+size_t GameState::findSlot(uint32_t id) const {
+  if (heap_) {
+    auto it = heap_->slotOf.find(id);
+    return it != heap_->slotOf.end() ? it->second : NO_SLOT;
+  }
+  for (size_t slot = 0; slot < count_; ++slot) {
+    if (inline_.ids[slot] == id)
+      return slot;
+  }
+  return NO_SLOT;
+}
+
+PlayerState GameState::stateAt(size_t slot) const {
+  return PlayerState(ids()[slot], usernames()[slot], roles()[slot],
+                     scores()[slot]);
+}
+
+// Moves the inline columns into vectors and builds the indexes. Only tables
+// that were never going to start a round (benchmarks, tests) get here.
+void GameState::spillToHeap() {
+  auto heap = std::make_unique<HeapPlayers>();
+  heap->ids.assign(inline_.ids, inline_.ids + count_);
+  heap->voteFor.assign(inline_.voteFor, inline_.voteFor + count_);
+  heap->votesAgainst.assign(inline_.votesAgainst,
+                            inline_.votesAgainst + count_);
+  heap->scores.assign(inline_.scores, inline_.scores + count_);
+  heap->roles.assign(inline_.roles, inline_.roles + count_);
+  for (size_t slot = 0; slot < count_; ++slot) {
+    heap->usernames.push_back(std::move(inline_.usernames[slot]));
+    heap->slotOf.emplace(heap->ids[slot], slot);
+    if (!heap->usernames[slot].empty())
+      heap->byUsername.emplace(heap->usernames[slot].view(), heap->ids[slot]);
+  }
+  heap_ = std::move(heap);
+}
 
 bool GameState::addPlayer(uint32_t id, const std::string &username) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
+
+  if (findSlot(id) != NO_SLOT)
+    return false;
+
+  if (!heap_ && count_ == INLINE_PLAYERS)
+    spillToHeap();
+
+  size_t slot = count_++;
+  if (heap_) {
+    heap_->ids.push_back(id);
+    heap_->voteFor.push_back(0);
+    heap_->votesAgainst.push_back(0);
+    heap_->scores.push_back(0);
+    heap_->roles.push_back(PlayerRole::NONE);
+    heap_->usernames.emplace_back(username);
+    heap_->slotOf.emplace(id, slot);
+    if (!heap_->usernames[slot].empty())
+      heap_->byUsername.emplace(heap_->usernames[slot].view(), id);
+    return true;
+  }
 
-  if (players_.find(id) != players_.end())
+  inline_.ids[slot] = id;
+  inline_.voteFor[slot] = 0;
+  inline_.votesAgainst[slot] = 0;
+  inline_.scores[slot] = 0;
+  inline_.roles[slot] = PlayerRole::NONE;
+  inline_.usernames[slot] = username;
+  return true;
+}
+
+bool GameState::renamePlayer(uint32_t id, const std::string &username) {
+  auto lock = acquire();
+
+  size_t slot = findSlot(id);
+  if (slot == NO_SLOT)
     return false;
 
-  players_[id] = PlayerState(id, username);
+  InternedString &name = usernames()[slot];
+  if (heap_ && !name.empty()) {
+    auto [first, last] = heap_->byUsername.equal_range(name.view());
+    for (auto it = first; it != last; ++it) {
+      if (it->second == id) {
+        heap_->byUsername.erase(it);
+        break;
+      }
+    }
+  }
+  name = username;
+  if (heap_ && !name.empty())
+    heap_->byUsername.emplace(name.view(), id);
   return true;
 }
 
+uint32_t GameState::findPlayerByUsername(std::string_view username) const {
+  auto lock = acquire();
+  if (heap_) {
+    auto it = heap_->byUsername.find(username);
+    return it != heap_->byUsername.end() ? it->second : 0;
+  }
+  for (size_t slot = 0; slot < count_; ++slot) {
+    if (inline_.usernames[slot] == username)
+      return inline_.ids[slot];
+  }
+  return 0;
+}
+
+// Fills the hole at slot with the last player. The index entries keyed by
+// the leaving name go before its handle does.
+void GameState::removeSlot(size_t slot) {
+  size_t last = count_ - 1;
+  if (heap_) {
+    InternedString &name = heap_->usernames[slot];
+    if (!name.empty()) {
+      auto [first, end] = heap_->byUsername.equal_range(name.view());
+      for (auto it = first; it != end; ++it) {
+        if (it->second == heap_->ids[slot]) {
+          heap_->byUsername.erase(it);
+          break;
+        }
+      }
+    }
+    heap_->slotOf.erase(heap_->ids[slot]);
+    if (slot != last)
+      heap_->slotOf[heap_->ids[last]] = slot;
+  }
+
+  uint32_t *idColumn = ids();
+  uint32_t *voteColumn = voteFor();
+  uint32_t *againstColumn = votesAgainst();
+  int *scoreColumn = scores();
+  PlayerRole *roleColumn = roles();
+  InternedString *nameColumn = usernames();
+  if (slot != last) {
+    idColumn[slot] = idColumn[last];
+    voteColumn[slot] = voteColumn[last];
+    againstColumn[slot] = againstColumn[last];
+    scoreColumn[slot] = scoreColumn[last];
+    roleColumn[slot] = roleColumn[last];
+    nameColumn[slot] = std::move(nameColumn[last]);
+  }
+  --count_;
+
+  if (heap_) {
+    heap_->ids.pop_back();
+    heap_->voteFor.pop_back();
+    heap_->votesAgainst.pop_back();
+    heap_->scores.pop_back();
+    heap_->roles.pop_back();
+    heap_->usernames.pop_back();
+  } else {
+    inline_.usernames[last] = InternedString();
+  }
+}
+
 bool GameState::removePlayer(uint32_t id) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
 
-  auto it = players_.find(id);
-  if (it == players_.end())
+  size_t slot = findSlot(id);
+  if (slot == NO_SLOT)
     return false;
 
-  votes_.erase(id);
+  uint32_t *voteColumn = voteFor();
+  uint32_t *againstColumn = votesAgainst();
+  bool hadVotes = false;
+  if (voteColumn[slot] != 0) {
+    --againstColumn[findSlot(voteColumn[slot])];
+    voteColumn[slot] = 0;
+    --votesCast_;
+    hadVotes = true;
+  }
 
-  for (auto voteIt = votes_.begin(); voteIt != votes_.end();) {
-    if (voteIt->second == id)
-      voteIt = votes_.erase(voteIt);
-    else
-      ++voteIt;
+  // Votes against the leaving player go with them.
+  if (againstColumn[slot] != 0) {
+    for (size_t voter = 0; voter < count_; ++voter) {
+      if (voteColumn[voter] == id) {
+        voteColumn[voter] = 0;
+        --votesCast_;
+      }
+    }
+    hadVotes = true;
   }
 
-  players_.erase(it);
+  removeSlot(slot);
+  if (hadVotes)
+    electLeader();
 
   if (currentLiarId_ == id)
     currentLiarId_ = 0;
@@ -63,65 +228,64 @@ bool GameState::removePlayer(uint32_t id) {
 }
 
 PlayerState GameState::getPlayerState(uint32_t id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = players_.find(id);
-  return it != players_.end() ? it->second : PlayerState();
+  auto lock = acquire();
+  size_t slot = findSlot(id);
+  return slot != NO_SLOT ? stateAt(slot) : PlayerState();
 }
 
 bool GameState::hasPlayer(uint32_t id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return players_.find(id) != players_.end();
+  auto lock = acquire();
+  return findSlot(id) != NO_SLOT;
 }
 
 std::vector<PlayerState> GameState::getAllPlayerStates() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
   std::vector<PlayerState> states;
-  states.reserve(players_.size());
-  for (const auto &pair : players_)
-    states.push_back(pair.second);
+  states.reserve(count_);
+  for (size_t slot = 0; slot < count_; ++slot)
+    states.push_back(stateAt(slot));
   return states;
 }
 
 std::vector<uint32_t> GameState::getAllPlayerIds() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  std::vector<uint32_t> ids;
-  ids.reserve(players_.size());
-  for (const auto &pair : players_)
-    ids.push_back(pair.first);
-  return ids;
+  auto lock = acquire();
+  const uint32_t *idColumn = ids();
+  return std::vector<uint32_t>(idColumn, idColumn + count_);
 }
 
 size_t GameState::getPlayerCount() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return players_.size();
+  auto lock = acquire();
+  return count_;
 }
 
 void GameState::clearAllPlayers() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  players_.clear();
-  clearRound();
+  auto lock = acquire();
+  heap_.reset();
+  for (size_t slot = 0; slot < count_; ++slot)
+    inline_.usernames[slot] = InternedString();
+  count_ = 0;
+  resetRound();
 }
 
 bool GameState::canStartRound() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  size_t count = players_.size();
-  return count >= 3 && count <= 6;
+  auto lock = acquire();
+  return count_ >= 3 && count_ <= INLINE_PLAYERS;
 }
 
 void GameState::startNewRound() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
 
   std::cout << "[GameState] startNewRound() called, player count: "
-            << players_.size() << std::endl;
+            << count_ << std::endl;
 
-  if (players_.size() < 3 || players_.size() > 6) {
+  if (count_ < 3 || count_ > INLINE_PLAYERS) {
     std::cerr << "[GameState] startNewRound() aborted: invalid player count"
               << std::endl;
     return;
   }
 
   std::cout << "[GameState] Clearing previous round..." << std::endl;
-  clearRound();
+  resetRound();
 
   std::cout << "[GameState] Picking random topic and word..." << std::endl;
   auto [topic, word] = pickRandomTopicAndWord();
@@ -130,29 +294,16 @@ void GameState::startNewRound() {
   std::cout << "[GameState] Selected topic: " << topic << ", word: " << word
             << std::endl;
 
-  std::vector<uint32_t> playerIds;
-  playerIds.reserve(players_.size());
-  for (const auto &pair : players_) {
-    playerIds.push_back(pair.first);
-  }
-
-  std::cout << "[GameState] Selecting random liar from " << playerIds.size()
+  std::cout << "[GameState] Selecting random liar from " << count_
             << " players..." << std::endl;
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<size_t> dis(0, playerIds.size() - 1);
-  size_t liarIndex = dis(gen);
-  currentLiarId_ = playerIds[liarIndex];
+  size_t liarIndex = random_.below(static_cast<uint32_t>(count_));
+  currentLiarId_ = ids()[liarIndex];
   std::cout << "[GameState] Selected liar: Player [" << currentLiarId_ << "]"
             << std::endl;
 
-  for (auto &pair : players_) {
-    if (pair.first == currentLiarId_) {
-      pair.second.role = PlayerRole::LIAR;
-    } else {
-      pair.second.role = PlayerRole::GUESSER;
-    }
-  }
+  PlayerRole *roleColumn = roles();
+  std::fill(roleColumn, roleColumn + count_, PlayerRole::GUESSER);
+  roleColumn[liarIndex] = PlayerRole::LIAR;
 
   roundActive_ = true;
   std::cout << "[GameState] Round is now active" << std::endl;
@@ -161,138 +312,189 @@ void GameState::startNewRound() {
 }
 
 void GameState::clearRound() {
+  auto lock = acquire();
+  resetRound();
+}
+
+void GameState::resetRound() {
   roundActive_ = false;
-  currentTopic_.clear();
-  currentWord_.clear();
+  currentTopic_ = InternedString();
+  currentWord_ = InternedString();
   currentLiarId_ = 0;
-  votes_.clear();
+  resetVotes();
 
-  for (auto &pair : players_) {
-    pair.second.role = PlayerRole::NONE;
-  }
+  PlayerRole *roleColumn = roles();
+  std::fill(roleColumn, roleColumn + count_, PlayerRole::NONE);
 }
 
-std::string GameState::getCurrentTopic() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+InternedString GameState::getCurrentTopic() const {
+  auto lock = acquire();
   return currentTopic_;
 }
 
-std::string GameState::getCurrentWord() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+InternedString GameState::getCurrentWord() const {
+  auto lock = acquire();
   return currentWord_;
 }
 
 uint32_t GameState::getCurrentLiarId() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
   return currentLiarId_;
 }
 
 bool GameState::isRoundActive() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
   return roundActive_;
 }
 
-std::pair<std::string, std::string> GameState::pickRandomTopicAndWord() const {
+std::pair<InternedString, InternedString>
+GameState::pickRandomTopicAndWord() {
   if (TOPIC_WORDS.empty()) {
-    return {"", ""};
+    return {};
   }
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<size_t> topicDis(0, TOPIC_WORDS.size() - 1);
-
-  size_t topicIndex = topicDis(gen);
+  size_t topicIndex =
+      random_.below(static_cast<uint32_t>(TOPIC_WORDS.size()));
   const auto &topicPair = TOPIC_WORDS[topicIndex];
-  const std::string &topic = topicPair.first;
-  const std::vector<std::string> &words = topicPair.second;
+  const InternedString &topic = topicPair.first;
+  const std::vector<InternedString> &words = topicPair.second;
 
   if (words.empty()) {
-    return {topic, ""};
+    return {topic, InternedString()};
   }
 
-  std::uniform_int_distribution<size_t> wordDis(0, words.size() - 1);
-  size_t wordIndex = wordDis(gen);
-  const std::string &word = words[wordIndex];
+  size_t wordIndex = random_.below(static_cast<uint32_t>(words.size()));
+  const InternedString &word = words[wordIndex];
 
   return {topic, word};
 }
 
-bool GameState::submitVote(uint32_t voterId, uint32_t targetId) {
-  std::lock_guard<std::mutex> lock(mutex_);
+VoteStatus GameState::submitVote(uint32_t voterId, uint32_t targetId) {
+  auto lock = acquire();
 
   if (!roundActive_) {
-    return false;
+    return VoteStatus::NO_ROUND;
   }
 
-  if (votes_.find(voterId) != votes_.end()) {
-    return false;
+  size_t voter = findSlot(voterId);
+  if (voter == NO_SLOT || voteFor()[voter] != 0) {
+    return VoteStatus::REJECTED;
   }
 
-  if (players_.find(voterId) == players_.end() ||
-      players_.find(targetId) == players_.end()) {
-    return false;
+  size_t target = findSlot(targetId);
+  if (target == NO_SLOT) {
+    return VoteStatus::REJECTED;
   }
 
-  votes_[voterId] = targetId;
-  return true;
+  voteFor()[voter] = targetId;
+  ++votesCast_;
+  uint32_t votes = ++votesAgainst()[target];
+  if (votes > leaderVotes_) {
+    leaderId_ = targetId;
+    leaderVotes_ = votes;
+  }
+
+  return votesCast_ >= count_ ? VoteStatus::ROUND_COMPLETE
+                              : VoteStatus::COUNTED;
 }
 
 bool GameState::hasPlayerVoted(uint32_t playerId) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return votes_.find(playerId) != votes_.end();
+  auto lock = acquire();
+  size_t slot = findSlot(playerId);
+  return slot != NO_SLOT && voteFor()[slot] != 0;
 }
 
 std::unordered_map<uint32_t, uint32_t> GameState::getVoteTally() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
   std::unordered_map<uint32_t, uint32_t> tally;
-
-  for (const auto &[voterId, targetId] : votes_) {
-    tally[targetId]++;
+  const uint32_t *idColumn = ids();
+  const uint32_t *againstColumn = votesAgainst();
+  for (size_t slot = 0; slot < count_; ++slot) {
+    if (againstColumn[slot] != 0)
+      tally.emplace(idColumn[slot], againstColumn[slot]);
   }
-
   return tally;
 }
 
+VoteStanding GameState::getVoteStanding() const {
+  auto lock = acquire();
+  VoteStanding standing;
+  standing.leaderId = leaderId_;
+  standing.leaderVotes = leaderVotes_;
+  standing.votesCast = votesCast_;
+  standing.playerCount = count_;
+  return standing;
+}
+
 void GameState::clearVotes() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  votes_.clear();
+  auto lock = acquire();
+  resetVotes();
+}
+
+void GameState::resetVotes() {
+  uint32_t *voteColumn = voteFor();
+  uint32_t *againstColumn = votesAgainst();
+  std::fill(voteColumn, voteColumn + count_, 0);
+  std::fill(againstColumn, againstColumn + count_, 0);
+  votesCast_ = 0;
+  leaderId_ = 0;
+  leaderVotes_ = 0;
+}
+
+// Only after a player leaves mid-vote; otherwise submitVote keeps the
+// leader as counts rise.
+void GameState::electLeader() {
+  leaderId_ = 0;
+  leaderVotes_ = 0;
+  const uint32_t *idColumn = ids();
+  const uint32_t *againstColumn = votesAgainst();
+  for (size_t slot = 0; slot < count_; ++slot) {
+    if (againstColumn[slot] > leaderVotes_) {
+      leaderId_ = idColumn[slot];
+      leaderVotes_ = againstColumn[slot];
+    }
+  }
 }
 
 void GameState::calculateAndApplyScores(bool liarCaught, uint32_t votedOutId,
                                         bool hasMajority) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
 
   if (!roundActive_ || currentLiarId_ == 0) {
     return;
   }
 
+  const uint32_t *voteColumn = voteFor();
+  const PlayerRole *roleColumn = roles();
+  int *scoreColumn = scores();
   if (liarCaught && votedOutId == currentLiarId_ && hasMajority) {
-    for (auto &pair : players_) {
-      if (pair.second.role == PlayerRole::GUESSER) {
-        if (votes_.find(pair.first) != votes_.end() &&
-            votes_[pair.first] == currentLiarId_) {
-          pair.second.score += 1;
-        }
+    for (size_t slot = 0; slot < count_; ++slot) {
+      if (roleColumn[slot] == PlayerRole::GUESSER &&
+          voteColumn[slot] == currentLiarId_) {
+        scoreColumn[slot] += 1;
       }
     }
   } else if (!liarCaught && hasMajority && votedOutId != currentLiarId_) {
-    if (players_.find(currentLiarId_) != players_.end()) {
-      players_[currentLiarId_].score += 2;
+    size_t liar = findSlot(currentLiarId_);
+    if (liar != NO_SLOT) {
+      scoreColumn[liar] += 2;
     }
   }
 }
 
 int GameState::getPlayerScore(uint32_t playerId) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = players_.find(playerId);
-  return it != players_.end() ? it->second.score : 0;
+  auto lock = acquire();
+  size_t slot = findSlot(playerId);
+  return slot != NO_SLOT ? scores()[slot] : 0;
 }
 
 std::unordered_map<uint32_t, int> GameState::getAllScores() const {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto lock = acquire();
   std::unordered_map<uint32_t, int> scores;
-  for (const auto &pair : players_) {
-    scores[pair.first] = pair.second.score;
+  const uint32_t *idColumn = ids();
+  const int *scoreColumn = this->scores();
+  for (size_t slot = 0; slot < count_; ++slot) {
+    scores[idColumn[slot]] = scoreColumn[slot];
   }
   return scores;
 }
@@ -0,0 +1,78 @@
+#include "common/latency_histogram.h"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace net {
+
+namespace {
+
+int highestBit(uint64_t bits) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, bits);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(bits);
+#endif
+}
+
+} // namespace
+
+size_t LatencyHistogram::bucketFor(uint64_t nanos) {
+  nanos = std::min(nanos, MAX_NANOS);
+  if (nanos < SUB_BUCKETS)
+    return static_cast<size_t>(nanos);
+  int exponent = highestBit(nanos);
+  size_t sub = static_cast<size_t>(nanos >> (exponent - SUB_BITS)) &
+               (SUB_BUCKETS - 1);
+  return static_cast<size_t>(exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::upperBound(size_t bucket) {
+  if (bucket < SUB_BUCKETS)
+    return bucket;
+  int exponent = static_cast<int>(bucket / SUB_BUCKETS) + SUB_BITS - 1;
+  uint64_t sub = bucket % SUB_BUCKETS;
+  uint64_t width = uint64_t(1) << (exponent - SUB_BITS);
+  return ((SUB_BUCKETS + sub) << (exponent - SUB_BITS)) + width - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+  if (total == 0)
+    return 0;
+  q = std::min(std::max(q, 0.0), 1.0);
+  uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+    seen += counts[bucket];
+    if (seen >= rank)
+      return std::min(upperBound(bucket), maxNanos);
+  }
+  return maxNanos;
+}
+
+double LatencyHistogram::meanNanos() const {
+  return total ? static_cast<double>(sumNanos) / static_cast<double>(total)
+               : 0.0;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+  ++counts[bucketFor(nanos)];
+  ++total;
+  sumNanos += nanos;
+  maxNanos = std::max(maxNanos, nanos);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  for (size_t bucket = 0; bucket < BUCKETS; ++bucket)
+    counts[bucket] += other.counts[bucket];
+  total += other.total;
+  sumNanos += other.sumNanos;
+  maxNanos = std::max(maxNanos, other.maxNanos);
+}
+
+} // namespace net
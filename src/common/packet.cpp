@@ -1,7 +1,7 @@
 #include "common/packet.h"
-#include <algorithm>
+#include "common/packet_writer.h"
+#include "common/platform.h"
 #include <cstring>
-#include <winsock2.h>
 
 namespace net {
 
@@ -12,22 +12,25 @@ Packet::Packet(uint16_t type, const std::vector<uint8_t> &data)
   updateHeader();
 }
 
-Packet::Packet(uint16_t type, const std::string &data) : header_(0, type) {
-  data_.resize(data.size());
-  std::copy(data.begin(), data.end(), data_.begin());
+Packet::Packet(uint16_t type, const std::string &data)
+    : header_(0, type), data_(data) {
+  updateHeader();
+}
+
+Packet::Packet(uint16_t type, const uint8_t *data, size_t size)
+    : header_(0, type), data_(data, size) {
   updateHeader();
 }
 
 void Packet::setType(uint16_t type) { header_.type = type; }
 
 void Packet::setData(const std::vector<uint8_t> &data) {
-  data_ = data;
+  data_.assign(data.data(), data.size());
   updateHeader();
 }
 
 void Packet::setData(const std::string &data) {
-  data_.resize(data.size());
-  std::copy(data.begin(), data.end(), data_.begin());
+  data_.assign(reinterpret_cast<const uint8_t *>(data.data()), data.size());
   updateHeader();
 }
 
@@ -37,25 +40,28 @@ void Packet::updateHeader() {
 }
 
 std::vector<uint8_t> Packet::serialize() const {
-  std::vector<uint8_t> buffer;
-  buffer.reserve(getTotalSize());
+  std::vector<uint8_t> buffer(getTotalSize());
 
   // Write header (network byte order - big endian)
   uint32_t lengthBE = htonl(header_.length);
   uint16_t typeBE = htons(header_.type);
-
-  buffer.insert(buffer.end(), reinterpret_cast<const uint8_t *>(&lengthBE),
-                reinterpret_cast<const uint8_t *>(&lengthBE) +
-                    sizeof(uint32_t));
-  buffer.insert(buffer.end(), reinterpret_cast<const uint8_t *>(&typeBE),
-                reinterpret_cast<const uint8_t *>(&typeBE) + sizeof(uint16_t));
+  std::memcpy(buffer.data(), &lengthBE, sizeof(uint32_t));
+  std::memcpy(buffer.data() + sizeof(uint32_t), &typeBE, sizeof(uint16_t));
 
   // Write data
-  buffer.insert(buffer.end(), data_.begin(), data_.end());
+  if (!data_.empty())
+    std::memcpy(buffer.data() + PacketHeader::SIZE, data_.data(),
+                data_.size());
 
   return buffer;
 }
 
+WireBuffer Packet::toWire() const {
+  PacketWriter writer(header_.type, data_.size());
+  writer.write(data_.data(), data_.size());
+  return writer.finish();
+}
+
 Packet Packet::deserialize(const std::vector<uint8_t> &buffer) {
   return deserialize(buffer.data(), buffer.size());
 }
@@ -83,8 +89,7 @@ Packet Packet::deserialize(const uint8_t *buffer, size_t size) {
 
   // Read data
   size_t dataSize = packet.header_.length - PacketHeader::SIZE;
-  packet.data_.resize(dataSize);
-  std::memcpy(packet.data_.data(), buffer + PacketHeader::SIZE, dataSize);
+  packet.data_.assign(buffer + PacketHeader::SIZE, dataSize);
 
   return packet;
 }
@@ -103,4 +108,25 @@ bool Packet::isCompletePacket(const uint8_t *buffer, size_t size) {
   return length <= size;
 }
 
+FrameResult PacketView::frame(const uint8_t *buffer, size_t size,
+                              PacketView &view) {
+  if (size < PacketHeader::SIZE)
+    return FrameResult::INCOMPLETE;
+
+  uint32_t lengthBE;
+  uint16_t typeBE;
+  std::memcpy(&lengthBE, buffer, sizeof(uint32_t));
+  std::memcpy(&typeBE, buffer + sizeof(uint32_t), sizeof(uint16_t));
+  uint32_t length = ntohl(lengthBE);
+
+  if (length < PacketHeader::SIZE || length > PacketHeader::MAX_LENGTH)
+    return FrameResult::MALFORMED;
+  if (length > size)
+    return FrameResult::INCOMPLETE;
+
+  view = PacketView(ntohs(typeBE), buffer + PacketHeader::SIZE,
+                    length - PacketHeader::SIZE);
+  return FrameResult::COMPLETE;
+}
+
 } // namespace net
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "common/packet_writer.h"
+#include "common/platform.h"
+#include <cstring>
+
+namespace net {
+
+PacketWriter::PacketWriter(uint16_t type, size_t payloadHint)
+    : buffer_(std::make_shared<Payload>()), type_(type) {
+  buffer_->reserve(PacketHeader::SIZE + payloadHint);
+  buffer_->resize(PacketHeader::SIZE);
+}
+
+void PacketWriter::write(const void *data, size_t size) {
+  if (size > 0)
+    std::memcpy(extend(size), data, size);
+}
+
+WireBuffer PacketWriter::finish() {
+  uint32_t lengthBE = htonl(static_cast<uint32_t>(buffer_->size()));
+  uint16_t typeBE = htons(type_);
+  std::memcpy(buffer_->data(), &lengthBE, sizeof(uint32_t));
+  std::memcpy(buffer_->data() + sizeof(uint32_t), &typeBE, sizeof(uint16_t));
+  return std::move(buffer_);
+}
+
+} // namespace net
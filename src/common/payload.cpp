@@ -0,0 +1,170 @@
+#include "common/payload.h"
+#include <cstring>
+#include <new>
+
+namespace net {
+
+namespace {
+
+// Blocks of 256 B .. 64 KiB in power-of-two classes; bigger payloads go
+// straight to the heap.
+constexpr size_t MIN_BLOCK_SHIFT = 8;
+constexpr size_t MAX_BLOCK_SHIFT = 16;
+constexpr size_t CLASS_COUNT = MAX_BLOCK_SHIFT - MIN_BLOCK_SHIFT + 1;
+constexpr size_t MAX_CACHED_PER_CLASS = 64;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+// Per-thread free lists. A block freed on another thread than the one that
+// allocated it simply joins that thread's cache.
+class BlockPool {
+public:
+  ~BlockPool() {
+    for (auto &list : classes_) {
+      while (list.head) {
+        FreeBlock *block = list.head;
+        list.head = block->next;
+        ::operator delete(block);
+      }
+    }
+  }
+
+  static size_t classFor(size_t size) {
+    size_t shift = MIN_BLOCK_SHIFT;
+    while ((size_t(1) << shift) < size)
+      ++shift;
+    return shift - MIN_BLOCK_SHIFT;
+  }
+
+  static size_t blockSize(size_t sizeClass) {
+    return size_t(1) << (sizeClass + MIN_BLOCK_SHIFT);
+  }
+
+  void *allocate(size_t sizeClass) {
+    FreeList &list = classes_[sizeClass];
+    if (list.head) {
+      FreeBlock *block = list.head;
+      list.head = block->next;
+      --list.count;
+      return block;
+    }
+    return ::operator new(blockSize(sizeClass));
+  }
+
+  void deallocate(void *pointer, size_t sizeClass) {
+    FreeList &list = classes_[sizeClass];
+    if (list.count >= MAX_CACHED_PER_CLASS) {
+      ::operator delete(pointer);
+      return;
+    }
+    FreeBlock *block = static_cast<FreeBlock *>(pointer);
+    block->next = list.head;
+    list.head = block;
+    ++list.count;
+  }
+
+private:
+  struct FreeList {
+    FreeBlock *head = nullptr;
+    size_t count = 0;
+  };
+
+  FreeList classes_[CLASS_COUNT];
+};
+
+BlockPool &pool() {
+  thread_local BlockPool instance;
+  return instance;
+}
+
+constexpr size_t MAX_POOLED_SIZE = size_t(1) << MAX_BLOCK_SHIFT;
+
+// Returns a block of at least `size` bytes and stores its real capacity.
+uint8_t *allocateBlock(size_t size, size_t &capacity) {
+  if (size > MAX_POOLED_SIZE) {
+    capacity = size;
+    return static_cast<uint8_t *>(::operator new(size));
+  }
+  size_t sizeClass = BlockPool::classFor(size);
+  capacity = BlockPool::blockSize(sizeClass);
+  return static_cast<uint8_t *>(pool().allocate(sizeClass));
+}
+
+void freeBlock(uint8_t *block, size_t capacity) {
+  if (capacity > MAX_POOLED_SIZE) {
+    ::operator delete(block);
+    return;
+  }
+  pool().deallocate(block, BlockPool::classFor(capacity));
+}
+
+} // namespace
+
+Payload &Payload::operator=(const Payload &other) {
+  if (this != &other)
+    assign(other.data(), other.size());
+  return *this;
+}
+
+Payload &Payload::operator=(Payload &&other) noexcept {
+  if (this != &other) {
+    release();
+    steal(other);
+  }
+  return *this;
+}
+
+void Payload::assign(const uint8_t *data, size_t size) {
+  if (size > capacity_) {
+    release();
+    size_t capacity = 0;
+    heap_ = allocateBlock(size, capacity);
+    capacity_ = capacity;
+  }
+  if (size > 0)
+    std::memcpy(this->data(), data, size);
+  size_ = size;
+}
+
+void Payload::resize(size_t size) {
+  reserve(size);
+  size_ = size;
+}
+
+void Payload::reserve(size_t capacity) {
+  if (capacity <= capacity_)
+    return;
+  size_t blockCapacity = 0;
+  uint8_t *block = allocateBlock(capacity, blockCapacity);
+  size_t size = size_;
+  if (size > 0)
+    std::memcpy(block, data(), size);
+  release();
+  heap_ = block;
+  capacity_ = blockCapacity;
+  size_ = size;
+}
+
+void Payload::release() {
+  if (!isInline()) {
+    freeBlock(heap_, capacity_);
+    capacity_ = INLINE_CAPACITY;
+  }
+  size_ = 0;
+}
+
+void Payload::steal(Payload &other) noexcept {
+  size_ = other.size_;
+  capacity_ = other.capacity_;
+  if (other.isInline()) {
+    std::memcpy(inline_, other.inline_, other.size_);
+  } else {
+    heap_ = other.heap_;
+    other.capacity_ = INLINE_CAPACITY;
+  }
+  other.size_ = 0;
+}
+
+} // namespace net
@@ -0,0 +1,14 @@
+#include "common/random.h"
+#include <random>
+
+namespace net {
+
+Random Random::fromEntropy() {
+  thread_local Random source = [] {
+    std::random_device device;
+    return Random((static_cast<uint64_t>(device()) << 32) | device());
+  }();
+  return Random(source.next());
+}
+
+} // namespace net
@@ -0,0 +1,45 @@
+#include "common/receive_buffer.h"
+#include <cstring>
+
+namespace net {
+
+uint8_t *ReceiveBuffer::prepare(size_t minSpace) {
+  if (writable() >= minSpace)
+    return storage_.get() + writePos_;
+
+  size_t unread = size();
+
+  // Reclaim consumed space before growing.
+  if (readPos_ > 0 && capacity_ - unread >= minSpace) {
+    std::memmove(storage_.get(), storage_.get() + readPos_, unread);
+  } else {
+    size_t capacity = capacity_ > 0 ? capacity_ : MIN_CAPACITY;
+    while (capacity - unread < minSpace)
+      capacity *= 2;
+
+    std::unique_ptr<uint8_t[]> storage(new uint8_t[capacity]);
+    if (unread > 0)
+      std::memcpy(storage.get(), storage_.get() + readPos_, unread);
+    storage_ = std::move(storage);
+    capacity_ = capacity;
+  }
+
+  readPos_ = 0;
+  writePos_ = unread;
+  return storage_.get() + writePos_;
+}
+
+void ReceiveBuffer::append(const uint8_t *data, size_t size) {
+  if (size == 0)
+    return;
+  std::memcpy(prepare(size), data, size);
+  commit(size);
+}
+
+void ReceiveBuffer::consume(size_t bytes) {
+  readPos_ += bytes;
+  if (readPos_ >= writePos_)
+    clear();
+}
+
+} // namespace net
@@ -1,439 +1,307 @@
 #include "common/serialization.h"
-#include <cstring>
-#include <winsock2.h>
+#include "common/wire_codec.h"
 
 namespace net {
 
-std::vector<uint8_t> serializePlayerState(const PlayerState &state) {
-  std::vector<uint8_t> data;
+namespace {
 
-  size_t usernameSize = state.username.size();
-  data.reserve(sizeof(uint32_t) * 4 + usernameSize);
+// STATE_ACK: the snapshot the client now holds; 0 asks for a full resync.
+struct StateAck {
+  uint32_t snapshotId = 0;
+};
 
-  uint32_t idBE = htonl(state.id);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&idBE),
-              reinterpret_cast<const uint8_t *>(&idBE) + sizeof(uint32_t));
+// STRING_DEFINE: the definitions as repeated field 1.
+struct StringDefinitions {
+  std::vector<StringDefinition> strings;
+};
 
-  uint32_t roleBE = htonl(static_cast<uint32_t>(state.role));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&roleBE),
-              reinterpret_cast<const uint8_t *>(&roleBE) + sizeof(uint32_t));
+} // namespace
 
-  uint32_t scoreBE = htonl(static_cast<uint32_t>(state.score));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&scoreBE),
-              reinterpret_cast<const uint8_t *>(&scoreBE) + sizeof(uint32_t));
+namespace wire {
 
-  uint32_t usernameLenBE = htonl(static_cast<uint32_t>(usernameSize));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&usernameLenBE),
-              reinterpret_cast<const uint8_t *>(&usernameLenBE) +
-                  sizeof(uint32_t));
+// Interned strings are their id; the reader's StringDictionary turns it
+// back into text.
+template <> struct Codec<InternedString> {
+  static constexpr WireType TYPE = VARINT;
 
-  if (usernameSize > 0)
-    data.insert(data.end(), state.username.begin(), state.username.end());
+  static bool isDefault(const InternedString &value) { return value.empty(); }
+  static size_t size(const InternedString &value) {
+    return varintSize(value.id());
+  }
+  static uint8_t *write(uint8_t *out, const InternedString &value) {
+    return putVarint(out, value.id());
+  }
 
+  static bool read(PacketReader &reader, InternedString &value) {
+    uint64_t id = 0;
+    if (!reader.readVarint(id))
+      return false;
+    value = reader.strings()
+                ? reader.strings()->resolve(static_cast<uint32_t>(id))
+                : InternedString();
+    return true;
+  }
+};
+
+template <> struct Schema<PlayerState> {
+  using Fields = std::tuple<Field<1, &PlayerState::id>,
+                            Field<2, &PlayerState::username>,
+                            Field<3, &PlayerState::role>,
+                            Field<4, &PlayerState::score>>;
+};
+
+template <> struct Schema<PlayerDelta> {
+  using Fields = std::tuple<Field<1, &PlayerDelta::id>,
+                            Field<2, &PlayerDelta::changed>,
+                            Field<3, &PlayerDelta::username>,
+                            Field<4, &PlayerDelta::role>,
+                            Field<5, &PlayerDelta::score>>;
+};
+
+template <> struct Schema<StateUpdate> {
+  using Fields = std::tuple<Field<1, &StateUpdate::snapshotId>,
+                            Field<2, &StateUpdate::baselineId>,
+                            Field<3, &StateUpdate::players>,
+                            Field<4, &StateUpdate::removed>>;
+};
+
+template <> struct Schema<StateAck> {
+  using Fields = std::tuple<Field<1, &StateAck::snapshotId>>;
+};
+
+template <> struct Schema<StringDefinition> {
+  using Fields = std::tuple<Field<1, &StringDefinition::id>,
+                            Field<2, &StringDefinition::text>>;
+};
+
+template <> struct Schema<StringDefinitions> {
+  using Fields = std::tuple<Field<1, &StringDefinitions::strings>>;
+};
+
+template <> struct Schema<ChatMessage> {
+  using Fields = std::tuple<Field<1, &ChatMessage::senderId>,
+                            Field<2, &ChatMessage::senderUsername>,
+                            Field<3, &ChatMessage::senderMessage>>;
+};
+
+template <> struct Schema<RoleAssignment> {
+  using Fields = std::tuple<Field<1, &RoleAssignment::playerId>,
+                            Field<2, &RoleAssignment::role>,
+                            Field<3, &RoleAssignment::topic>,
+                            Field<4, &RoleAssignment::secretWord>>;
+};
+
+template <> struct Schema<VoteCommand> {
+  using Fields = std::tuple<Field<1, &VoteCommand::voterId>,
+                            Field<2, &VoteCommand::targetId>>;
+};
+
+template <> struct Schema<VoteResult> {
+  using Fields = std::tuple<Field<1, &VoteResult::tally>,
+                            Field<2, &VoteResult::winnerId>,
+                            Field<3, &VoteResult::liarCaught>>;
+};
+
+} // namespace wire
+
+namespace {
+
+template <typename T> std::vector<uint8_t> encodeMessage(const T &message) {
+  std::vector<uint8_t> data(wire::encodedSize(message));
+  wire::encode(data.data(), message);
   return data;
 }
 
-PlayerState deserializePlayerState(const uint8_t *data, size_t size) {
-  PlayerState state;
-
-  if (size < sizeof(uint32_t) * 4)
-    return state;
-
-  size_t offset = 0;
+// Game messages are small: encode on the stack so the only copy is into
+// the packet's payload, which keeps them inline.
+constexpr size_t STACK_ENCODE_LIMIT = 256;
 
-  uint32_t idBE;
-  std::memcpy(&idBE, data + offset, sizeof(uint32_t));
-  state.id = ntohl(idBE);
-  offset += sizeof(uint32_t);
-
-  uint32_t roleBE;
-  std::memcpy(&roleBE, data + offset, sizeof(uint32_t));
-  state.role = static_cast<PlayerRole>(ntohl(roleBE));
-  offset += sizeof(uint32_t);
-
-  uint32_t scoreBE;
-  std::memcpy(&scoreBE, data + offset, sizeof(uint32_t));
-  state.score = static_cast<int>(ntohl(scoreBE));
-  offset += sizeof(uint32_t);
-
-  if (size < offset + sizeof(uint32_t))
-    return state;
-
-  uint32_t usernameLenBE;
-  std::memcpy(&usernameLenBE, data + offset, sizeof(uint32_t));
-  size_t usernameLen = ntohl(usernameLenBE);
-  offset += sizeof(uint32_t);
+template <typename T> Packet encodePacket(uint16_t type, const T &message) {
+  size_t size = wire::encodedSize(message);
+  if (size <= STACK_ENCODE_LIMIT) {
+    uint8_t buffer[STACK_ENCODE_LIMIT];
+    wire::encode(buffer, message);
+    return Packet(type, buffer, size);
+  }
+  return Packet(type, encodeMessage(message));
+}
 
-  if (size >= offset + usernameLen && usernameLen > 0)
-    state.username =
-        std::string(reinterpret_cast<const char *>(data + offset), usernameLen);
+template <typename T> WireBuffer encodeWire(uint16_t type, const T &message) {
+  size_t size = wire::encodedSize(message);
+  PacketWriter writer(type, size);
+  wire::encode(writer.extend(size), message);
+  return writer.finish();
+}
 
-  return state;
+template <typename T> T decodeMessage(const uint8_t *data, size_t size) {
+  T message;
+  wire::decode(data, size, message);
+  return message;
 }
 
-Packet createPlayerStatePacket(uint16_t type, const PlayerState &state) {
-  auto data = serializePlayerState(state);
-  return Packet(type, data);
+template <typename T>
+T decodePacket(const Packet &packet,
+               const StringDictionary *strings = nullptr) {
+  T message;
+  PacketReader reader(packet.getData());
+  reader.setStrings(strings);
+  wire::decode(reader, message);
+  return message;
 }
 
-Packet createGameStateUpdatePacket(const std::vector<PlayerState> &states) {
-  std::vector<uint8_t> data;
+} // namespace
 
-  uint32_t count = static_cast<uint32_t>(states.size());
-  uint32_t countBE = htonl(count);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&countBE),
-              reinterpret_cast<const uint8_t *>(&countBE) + sizeof(uint32_t));
+std::vector<uint8_t> serializePlayerState(const PlayerState &state) {
+  return encodeMessage(state);
+}
 
-  for (const auto &state : states) {
-    auto stateData = serializePlayerState(state);
-    data.insert(data.end(), stateData.begin(), stateData.end());
-  }
+PlayerState deserializePlayerState(const uint8_t *data, size_t size) {
+  return decodeMessage<PlayerState>(data, size);
+}
 
-  return Packet(MessageType::GAME_STATE_UPDATE, data);
+Packet createPlayerStatePacket(uint16_t type, const PlayerState &state) {
+  return encodePacket(type, state);
 }
 
 PlayerState extractPlayerState(const Packet &packet) {
-  return deserializePlayerState(packet.getData().data(),
-                                packet.getData().size());
+  return decodePacket<PlayerState>(packet);
 }
 
-std::vector<PlayerState> extractGameStateUpdate(const Packet &packet) {
-  std::vector<PlayerState> states;
-  const auto &data = packet.getData();
-
-  if (data.size() < sizeof(uint32_t))
-    return states;
+PlayerState extractPlayerState(const Packet &packet,
+                               const StringDictionary &strings) {
+  return decodePacket<PlayerState>(packet, &strings);
+}
 
-  uint32_t countBE;
-  std::memcpy(&countBE, data.data(), sizeof(uint32_t));
-  uint32_t count = ntohl(countBE);
-  size_t offset = sizeof(uint32_t);
+Packet createGameStateUpdatePacket(const StateUpdate &update) {
+  return encodePacket(MessageType::GAME_STATE_UPDATE, update);
+}
 
-  for (uint32_t i = 0; i < count; ++i) {
-    if (data.size() < offset + sizeof(uint32_t) * 4)
-      break;
+StateUpdate extractGameStateUpdate(const Packet &packet) {
+  return decodePacket<StateUpdate>(packet);
+}
 
-    uint32_t usernameLenBE;
-    if (data.size() < offset + sizeof(uint32_t) * 4)
-      break;
-    std::memcpy(&usernameLenBE, data.data() + offset + sizeof(uint32_t) * 3,
-                sizeof(uint32_t));
-    uint32_t usernameLen = ntohl(usernameLenBE);
+StateUpdate extractGameStateUpdate(const Packet &packet,
+                                   const StringDictionary &strings) {
+  return decodePacket<StateUpdate>(packet, &strings);
+}
 
-    size_t playerSize = sizeof(uint32_t) * 4 + usernameLen;
-    if (data.size() < offset + playerSize)
-      break;
+Packet createStateAckPacket(uint32_t snapshotId) {
+  return encodePacket(MessageType::STATE_ACK, StateAck{snapshotId});
+}
 
-    PlayerState state =
-        deserializePlayerState(data.data() + offset, playerSize);
-    states.push_back(state);
-    offset += playerSize;
-  }
+uint32_t deserializeStateAck(const uint8_t *data, size_t size) {
+  return decodeMessage<StateAck>(data, size).snapshotId;
+}
 
-  return states;
+uint32_t extractStateAck(const Packet &packet) {
+  return decodePacket<StateAck>(packet).snapshotId;
 }
 
 std::vector<uint8_t> serializeChatMessage(const ChatMessage &message) {
-  std::vector<uint8_t> data;
-
-  size_t usernameSize = message.senderUsername.size();
-  size_t messageSize = message.senderMessage.size();
-  data.reserve(sizeof(uint32_t) * 3 + usernameSize + messageSize);
-
-  uint32_t senderIdBE = htonl(message.senderId);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&senderIdBE),
-              reinterpret_cast<const uint8_t *>(&senderIdBE) +
-                  sizeof(uint32_t));
-
-  uint32_t usernameLenBE = htonl(static_cast<uint32_t>(usernameSize));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&usernameLenBE),
-              reinterpret_cast<const uint8_t *>(&usernameLenBE) +
-                  sizeof(uint32_t));
-
-  if (usernameSize > 0)
-    data.insert(data.end(), message.senderUsername.begin(),
-                message.senderUsername.end());
-
-  uint32_t messageLenBE = htonl(static_cast<uint32_t>(messageSize));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&messageLenBE),
-              reinterpret_cast<const uint8_t *>(&messageLenBE) +
-                  sizeof(uint32_t));
-
-  if (messageSize > 0)
-    data.insert(data.end(), message.senderMessage.begin(),
-                message.senderMessage.end());
-
-  return data;
+  return encodeMessage(message);
 }
 
 ChatMessage deserializeChatMessage(const uint8_t *data, size_t size) {
-  ChatMessage message;
-
-  if (size < sizeof(uint32_t) * 3)
-    return message;
-
-  size_t offset = 0;
-
-  uint32_t senderIdBE;
-  std::memcpy(&senderIdBE, data + offset, sizeof(uint32_t));
-  message.senderId = ntohl(senderIdBE);
-  offset += sizeof(uint32_t);
-
-  uint32_t usernameLenBE;
-  std::memcpy(&usernameLenBE, data + offset, sizeof(uint32_t));
-  size_t usernameLen = ntohl(usernameLenBE);
-  offset += sizeof(uint32_t);
-
-  if (usernameLen > 0 && offset + usernameLen <= size) {
-    message.senderUsername =
-        std::string(reinterpret_cast<const char *>(data + offset), usernameLen);
-    offset += usernameLen;
-  }
-
-  if (offset + sizeof(uint32_t) > size)
-    return message;
-  uint32_t messageLenBE;
-  std::memcpy(&messageLenBE, data + offset, sizeof(uint32_t));
-  size_t messageLen = ntohl(messageLenBE);
-  offset += sizeof(uint32_t);
-
-  if (messageLen > 0 && offset + messageLen <= size)
-    message.senderMessage.assign(reinterpret_cast<const char *>(data + offset),
-                                 messageLen);
-
-  return message;
+  return decodeMessage<ChatMessage>(data, size);
 }
 
 Packet createChatMessagePacket(const ChatMessage &message) {
-  auto data = serializeChatMessage(message);
-  return Packet(MessageType::CHAT_BROADCAST, data);
+  return encodePacket(MessageType::CHAT_BROADCAST, message);
 }
 
 ChatMessage extractChatMessage(const Packet &packet) {
-  return deserializeChatMessage(packet.getData().data(),
-                                packet.getData().size());
+  return decodePacket<ChatMessage>(packet);
 }
 
-std::vector<uint8_t> serializeRoleAssignment(const RoleAssignment &assignment) {
-  std::vector<uint8_t> data;
-
-  size_t topicSize = assignment.topic.size();
-  size_t wordSize = assignment.secretWord.size();
-  data.reserve(sizeof(uint32_t) * 5 + topicSize + wordSize);
-
-  uint32_t playerIdBE = htonl(assignment.playerId);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&playerIdBE),
-              reinterpret_cast<const uint8_t *>(&playerIdBE) +
-                  sizeof(uint32_t));
-
-  uint32_t roleBE = htonl(static_cast<uint32_t>(assignment.role));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&roleBE),
-              reinterpret_cast<const uint8_t *>(&roleBE) + sizeof(uint32_t));
-
-  uint32_t topicLenBE = htonl(static_cast<uint32_t>(topicSize));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&topicLenBE),
-              reinterpret_cast<const uint8_t *>(&topicLenBE) +
-                  sizeof(uint32_t));
-
-  if (topicSize > 0)
-    data.insert(data.end(), assignment.topic.begin(), assignment.topic.end());
-
-  uint32_t wordLenBE = htonl(static_cast<uint32_t>(wordSize));
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&wordLenBE),
-              reinterpret_cast<const uint8_t *>(&wordLenBE) + sizeof(uint32_t));
-
-  if (wordSize > 0)
-    data.insert(data.end(), assignment.secretWord.begin(),
-                assignment.secretWord.end());
+ChatMessage extractChatMessage(const Packet &packet,
+                               const StringDictionary &strings) {
+  return decodePacket<ChatMessage>(packet, &strings);
+}
 
-  return data;
+std::vector<uint8_t> serializeRoleAssignment(const RoleAssignment &assignment) {
+  return encodeMessage(assignment);
 }
 
 RoleAssignment deserializeRoleAssignment(const uint8_t *data, size_t size) {
-  RoleAssignment assignment;
-
-  if (size < sizeof(uint32_t) * 3)
-    return assignment;
-
-  size_t offset = 0;
-
-  uint32_t playerIdBE;
-  std::memcpy(&playerIdBE, data + offset, sizeof(uint32_t));
-  assignment.playerId = ntohl(playerIdBE);
-  offset += sizeof(uint32_t);
-
-  uint32_t roleBE;
-  std::memcpy(&roleBE, data + offset, sizeof(uint32_t));
-  assignment.role = static_cast<PlayerRole>(ntohl(roleBE));
-  offset += sizeof(uint32_t);
-
-  if (size < offset + sizeof(uint32_t))
-    return assignment;
-
-  uint32_t topicLenBE;
-  std::memcpy(&topicLenBE, data + offset, sizeof(uint32_t));
-  size_t topicLen = ntohl(topicLenBE);
-  offset += sizeof(uint32_t);
-
-  if (topicLen > 0 && offset + topicLen <= size) {
-    assignment.topic =
-        std::string(reinterpret_cast<const char *>(data + offset), topicLen);
-    offset += topicLen;
-  }
-
-  if (offset + sizeof(uint32_t) > size)
-    return assignment;
-
-  uint32_t wordLenBE;
-  std::memcpy(&wordLenBE, data + offset, sizeof(uint32_t));
-  size_t wordLen = ntohl(wordLenBE);
-  offset += sizeof(uint32_t);
-
-  if (wordLen > 0 && offset + wordLen <= size) {
-    assignment.secretWord =
-        std::string(reinterpret_cast<const char *>(data + offset), wordLen);
-  }
-
-  return assignment;
+  return decodeMessage<RoleAssignment>(data, size);
 }
 
 Packet createRoleAssignmentPacket(const RoleAssignment &assignment) {
-  auto data = serializeRoleAssignment(assignment);
-  return Packet(MessageType::ROLE_ASSIGNMENT, data);
+  return encodePacket(MessageType::ROLE_ASSIGNMENT, assignment);
 }
 
 RoleAssignment extractRoleAssignment(const Packet &packet) {
-  return deserializeRoleAssignment(packet.getData().data(),
-                                   packet.getData().size());
+  return decodePacket<RoleAssignment>(packet);
 }
 
-std::vector<uint8_t> serializeVoteCommand(const VoteCommand &vote) {
-  std::vector<uint8_t> data;
-  data.reserve(sizeof(uint32_t) * 2);
+RoleAssignment extractRoleAssignment(const Packet &packet,
+                                     const StringDictionary &strings) {
+  return decodePacket<RoleAssignment>(packet, &strings);
+}
 
-  uint32_t voterBE = htonl(vote.voterId);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&voterBE),
-              reinterpret_cast<const uint8_t *>(&voterBE) + sizeof(uint32_t));
+Packet createStringDefinePacket(const std::vector<StringDefinition> &strings) {
+  return encodePacket(MessageType::STRING_DEFINE, StringDefinitions{strings});
+}
 
-  uint32_t targetBE = htonl(vote.targetId);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&targetBE),
-              reinterpret_cast<const uint8_t *>(&targetBE) + sizeof(uint32_t));
+std::vector<StringDefinition> extractStringDefinitions(const Packet &packet) {
+  return decodePacket<StringDefinitions>(packet).strings;
+}
 
-  return data;
+std::vector<uint8_t> serializeVoteCommand(const VoteCommand &vote) {
+  return encodeMessage(vote);
 }
 
 VoteCommand deserializeVoteCommand(const uint8_t *data, size_t size) {
-  VoteCommand vote;
-
-  if (size < sizeof(uint32_t) * 2)
-    return vote;
-
-  uint32_t voterBE;
-  std::memcpy(&voterBE, data, sizeof(uint32_t));
-  vote.voterId = ntohl(voterBE);
-
-  uint32_t targetBE;
-  std::memcpy(&targetBE, data + sizeof(uint32_t), sizeof(uint32_t));
-  vote.targetId = ntohl(targetBE);
-
-  return vote;
+  return decodeMessage<VoteCommand>(data, size);
 }
 
 Packet createVoteCommandPacket(const VoteCommand &vote) {
-  auto data = serializeVoteCommand(vote);
-  return Packet(MessageType::VOTE_COMMAND, data);
+  return encodePacket(MessageType::VOTE_COMMAND, vote);
 }
 
 VoteCommand extractVoteCommand(const Packet &packet) {
-  return deserializeVoteCommand(packet.getData().data(),
-                                packet.getData().size());
+  return decodePacket<VoteCommand>(packet);
 }
 
 std::vector<uint8_t> serializeVoteResult(const VoteResult &result) {
-  std::vector<uint8_t> data;
-
-  uint32_t count = static_cast<uint32_t>(result.tally.size());
-  data.reserve(sizeof(uint32_t) * (3 + count * 2));
-
-  uint32_t countBE = htonl(count);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&countBE),
-              reinterpret_cast<const uint8_t *>(&countBE) + sizeof(uint32_t));
-
-  for (const auto &[targetId, voteCount] : result.tally) {
-    uint32_t targetBE = htonl(targetId);
-    data.insert(data.end(), reinterpret_cast<const uint8_t *>(&targetBE),
-                reinterpret_cast<const uint8_t *>(&targetBE) +
-                    sizeof(uint32_t));
-
-    uint32_t votesBE = htonl(voteCount);
-    data.insert(data.end(), reinterpret_cast<const uint8_t *>(&votesBE),
-                reinterpret_cast<const uint8_t *>(&votesBE) + sizeof(uint32_t));
-  }
-
-  uint32_t winnerBE = htonl(result.winnerId);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&winnerBE),
-              reinterpret_cast<const uint8_t *>(&winnerBE) + sizeof(uint32_t));
-
-  uint32_t caughtBE = htonl(result.liarCaught ? 1 : 0);
-  data.insert(data.end(), reinterpret_cast<const uint8_t *>(&caughtBE),
-              reinterpret_cast<const uint8_t *>(&caughtBE) + sizeof(uint32_t));
-
-  return data;
+  return encodeMessage(result);
 }
 
 VoteResult deserializeVoteResult(const uint8_t *data, size_t size) {
-  VoteResult result;
-
-  if (size < sizeof(uint32_t) * 3)
-    return result;
-
-  size_t offset = 0;
-
-  uint32_t countBE;
-  std::memcpy(&countBE, data + offset, sizeof(uint32_t));
-  uint32_t count = ntohl(countBE);
-  offset += sizeof(uint32_t);
-
-  for (uint32_t i = 0; i < count; ++i) {
-    if (size < offset + sizeof(uint32_t) * 2)
-      break;
-
-    uint32_t targetBE;
-    std::memcpy(&targetBE, data + offset, sizeof(uint32_t));
-    uint32_t targetId = ntohl(targetBE);
-    offset += sizeof(uint32_t);
+  return decodeMessage<VoteResult>(data, size);
+}
 
-    uint32_t votesBE;
-    std::memcpy(&votesBE, data + offset, sizeof(uint32_t));
-    uint32_t voteCount = ntohl(votesBE);
-    offset += sizeof(uint32_t);
+Packet createVoteResultPacket(const VoteResult &result) {
+  return encodePacket(MessageType::VOTE_RESULT, result);
+}
 
-    result.tally[targetId] = voteCount;
-  }
+VoteResult extractVoteResult(const Packet &packet) {
+  return decodePacket<VoteResult>(packet);
+}
 
-  if (size < offset + sizeof(uint32_t) * 2)
-    return result;
+WireBuffer encodePlayerState(uint16_t type, const PlayerState &state) {
+  return encodeWire(type, state);
+}
 
-  uint32_t winnerBE;
-  std::memcpy(&winnerBE, data + offset, sizeof(uint32_t));
-  result.winnerId = ntohl(winnerBE);
-  offset += sizeof(uint32_t);
+WireBuffer encodeGameStateUpdate(const StateUpdate &update) {
+  return encodeWire(MessageType::GAME_STATE_UPDATE, update);
+}
 
-  uint32_t caughtBE;
-  std::memcpy(&caughtBE, data + offset, sizeof(uint32_t));
-  result.liarCaught = (ntohl(caughtBE) != 0);
+WireBuffer encodeChatMessage(const ChatMessage &message) {
+  return encodeWire(MessageType::CHAT_BROADCAST, message);
+}
 
-  return result;
+WireBuffer encodeRoleAssignment(const RoleAssignment &assignment) {
+  return encodeWire(MessageType::ROLE_ASSIGNMENT, assignment);
 }
 
-Packet createVoteResultPacket(const VoteResult &result) {
-  auto data = serializeVoteResult(result);
-  return Packet(MessageType::VOTE_RESULT, data);
+WireBuffer encodeVoteResult(const VoteResult &result) {
+  return encodeWire(MessageType::VOTE_RESULT, result);
 }
 
-VoteResult extractVoteResult(const Packet &packet) {
-  return deserializeVoteResult(packet.getData().data(),
-                               packet.getData().size());
+WireBuffer
+encodeStringDefinitions(const std::vector<StringDefinition> &strings) {
+  return encodeWire(MessageType::STRING_DEFINE, StringDefinitions{strings});
 }
 
-} // namespace net
\ No newline at end of file
+} // namespace net
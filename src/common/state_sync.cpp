@@ -0,0 +1,170 @@
+#include "common/state_sync.h"
+#include <algorithm>
+
+namespace net {
+
+namespace {
+
+bool byId(const PlayerState &a, const PlayerState &b) { return a.id < b.id; }
+
+uint8_t changedFields(const PlayerState &before, const PlayerState &after) {
+  uint8_t changed = 0;
+  if (before.username != after.username)
+    changed |= PlayerDelta::USERNAME;
+  if (before.role != after.role)
+    changed |= PlayerDelta::ROLE;
+  if (before.score != after.score)
+    changed |= PlayerDelta::SCORE;
+  return changed;
+}
+
+PlayerDelta makeDelta(const PlayerState &state, uint8_t changed) {
+  PlayerDelta delta;
+  delta.id = state.id;
+  delta.changed = changed;
+  if (changed & PlayerDelta::USERNAME)
+    delta.username = state.username;
+  if (changed & PlayerDelta::ROLE)
+    delta.role = state.role;
+  if (changed & PlayerDelta::SCORE)
+    delta.score = state.score;
+  return delta;
+}
+
+void applyDelta(PlayerState &state, const PlayerDelta &delta) {
+  if (delta.changed & PlayerDelta::USERNAME)
+    state.username = delta.username;
+  if (delta.changed & PlayerDelta::ROLE)
+    state.role = delta.role;
+  if (delta.changed & PlayerDelta::SCORE)
+    state.score = delta.score;
+}
+
+bool samePlayers(const std::vector<PlayerState> &a,
+                 const std::vector<PlayerState> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].id != b[i].id || changedFields(a[i], b[i]) != 0)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+uint32_t SnapshotHistory::capture(std::vector<PlayerState> players) {
+  std::sort(players.begin(), players.end(), byId);
+  if (!snapshots_.empty() && samePlayers(snapshots_.back().players, players))
+    return snapshots_.back().id;
+
+  uint32_t id = nextId_++;
+  if (nextId_ == 0)
+    nextId_ = 1;
+  snapshots_.push_back({id, std::move(players)});
+  if (snapshots_.size() > DEPTH)
+    snapshots_.pop_front();
+  return id;
+}
+
+const SnapshotHistory::Snapshot *
+SnapshotHistory::find(uint32_t snapshotId) const {
+  for (const Snapshot &snapshot : snapshots_) {
+    if (snapshot.id == snapshotId)
+      return &snapshot;
+  }
+  return nullptr;
+}
+
+bool SnapshotHistory::contains(uint32_t snapshotId) const {
+  return snapshotId != 0 && find(snapshotId) != nullptr;
+}
+
+StateUpdate SnapshotHistory::diff(uint32_t baselineId) const {
+  StateUpdate update;
+  if (snapshots_.empty())
+    return update;
+
+  const Snapshot &latest = snapshots_.back();
+  update.snapshotId = latest.id;
+  const Snapshot *baseline = baselineId != 0 ? find(baselineId) : nullptr;
+
+  if (!baseline) {
+    update.players.reserve(latest.players.size());
+    for (const PlayerState &state : latest.players)
+      update.players.push_back(makeDelta(state, PlayerDelta::ALL));
+    return update;
+  }
+
+  // Both lists are sorted by id, so one merge pass finds the changes.
+  update.baselineId = baselineId;
+  auto before = baseline->players.begin();
+  auto beforeEnd = baseline->players.end();
+  for (const PlayerState &state : latest.players) {
+    while (before != beforeEnd && before->id < state.id)
+      update.removed.push_back((before++)->id);
+    if (before != beforeEnd && before->id == state.id) {
+      uint8_t changed = changedFields(*before, state);
+      if (changed)
+        update.players.push_back(makeDelta(state, changed));
+      ++before;
+    } else {
+      update.players.push_back(makeDelta(state, PlayerDelta::ALL));
+    }
+  }
+  for (; before != beforeEnd; ++before)
+    update.removed.push_back(before->id);
+  return update;
+}
+
+bool SnapshotTracker::apply(const StateUpdate &update) {
+  // A full snapshot replaces everything held: ids restart in every room, so
+  // after a move to another room a held id may name a different snapshot.
+  if (update.isFull()) {
+    snapshots_.clear();
+  } else {
+    // A resend of a snapshot already held (the ack was still in flight).
+    for (const Snapshot &snapshot : snapshots_) {
+      if (snapshot.id == update.snapshotId)
+        return true;
+    }
+  }
+
+  std::vector<PlayerState> players;
+  if (!update.isFull()) {
+    const Snapshot *baseline = nullptr;
+    for (const Snapshot &snapshot : snapshots_) {
+      if (snapshot.id == update.baselineId)
+        baseline = &snapshot;
+    }
+    if (!baseline)
+      return false;
+    players = baseline->players;
+  }
+
+  for (uint32_t id : update.removed) {
+    auto it = std::lower_bound(players.begin(), players.end(),
+                               PlayerState(id, ""), byId);
+    if (it != players.end() && it->id == id)
+      players.erase(it);
+  }
+  for (const PlayerDelta &delta : update.players) {
+    auto it = std::lower_bound(players.begin(), players.end(),
+                               PlayerState(delta.id, ""), byId);
+    if (it == players.end() || it->id != delta.id)
+      it = players.insert(it, PlayerState(delta.id, ""));
+    applyDelta(*it, delta);
+  }
+
+  snapshots_.push_back({update.snapshotId, std::move(players)});
+  if (snapshots_.size() > SnapshotHistory::DEPTH)
+    snapshots_.pop_front();
+  return true;
+}
+
+const std::vector<PlayerState> &SnapshotTracker::players() const {
+  static const std::vector<PlayerState> none;
+  return snapshots_.empty() ? none : snapshots_.back().players;
+}
+
+} // namespace net
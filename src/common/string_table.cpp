@@ -0,0 +1,98 @@
+#include "common/string_table.h"
+#include <ostream>
+
+namespace net {
+
+const std::string InternedString::empty_;
+
+InternedString::InternedString(std::string_view text)
+    : InternedString(StringTable::instance().intern(text)) {}
+
+InternedString &InternedString::operator=(const InternedString &other) {
+  if (entry_ != other.entry_) {
+    InternedString copy(other);
+    std::swap(entry_, copy.entry_);
+  }
+  return *this;
+}
+
+InternedString &InternedString::operator=(InternedString &&other) noexcept {
+  if (this != &other) {
+    release();
+    entry_ = other.entry_;
+    other.entry_ = nullptr;
+  }
+  return *this;
+}
+
+void InternedString::release() {
+  if (!entry_)
+    return;
+  // Read the id first: once the count drops another thread may free the
+  // entry. The table re-checks the count under its lock, since intern()
+  // can revive a string whose count just reached zero.
+  uint32_t id = entry_->id;
+  if (entry_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    StringTable::instance().reclaim(id);
+  entry_ = nullptr;
+}
+
+std::ostream &operator<<(std::ostream &out, const InternedString &text) {
+  return out << text.str();
+}
+
+StringTable &StringTable::instance() {
+  // Never destroyed, so handles in other static objects can outlive main.
+  static StringTable *table = new StringTable();
+  return *table;
+}
+
+InternedString StringTable::intern(std::string_view text) {
+  if (text.empty())
+    return InternedString();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = byText_.find(text);
+  if (it != byText_.end()) {
+    it->second->refs.fetch_add(1, std::memory_order_relaxed);
+    return InternedString(it->second);
+  }
+
+  Entry *entry = new Entry();
+  entry->id = nextId_++;
+  entry->text.assign(text.data(), text.size());
+  byText_.emplace(entry->text, entry);
+  byId_.emplace(entry->id, entry);
+  return InternedString(entry);
+}
+
+InternedString StringTable::find(uint32_t id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = byId_.find(id);
+  if (it == byId_.end())
+    return InternedString();
+  it->second->refs.fetch_add(1, std::memory_order_relaxed);
+  return InternedString(it->second);
+}
+
+size_t StringTable::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return byId_.size();
+}
+
+void StringTable::reclaim(uint32_t id) {
+  Entry *entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byId_.find(id);
+    if (it == byId_.end() ||
+        it->second->refs.load(std::memory_order_acquire) != 0)
+      return;
+    entry = it->second;
+    byText_.erase(std::string_view(entry->text));
+    byId_.erase(it);
+  }
+  delete entry;
+}
+
+} // namespace net
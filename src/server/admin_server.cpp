@@ -0,0 +1,362 @@
+#include "server/admin_server.h"
+#include "server/server.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace net {
+
+namespace {
+
+// Label values may hold anything; the format escapes \, " and newlines.
+void appendEscaped(std::string &out, std::string_view text) {
+  for (char c : text) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+}
+
+bool sendAll(SOCKET socket, const std::string &data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    int sent = send(socket, data.data() + offset,
+                    static_cast<int>(data.size() - offset), SEND_FLAGS);
+    if (sent <= 0)
+      return false;
+    offset += static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+std::string response(const char *status, const char *contentType,
+                     const std::string &body) {
+  return std::string("HTTP/1.0 ") + status +
+         "\r\nContent-Type: " + contentType +
+         "\r\nContent-Length: " + std::to_string(body.size()) +
+         "\r\nConnection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+// MetricsWriter
+
+void MetricsWriter::family(std::string_view name, std::string_view type,
+                           std::string_view help) {
+  out_ += "# HELP ";
+  out_ += name;
+  out_ += ' ';
+  out_ += help;
+  out_ += "\n# TYPE ";
+  out_ += name;
+  out_ += ' ';
+  out_ += type;
+  out_ += '\n';
+}
+
+void MetricsWriter::labels(Labels labels) {
+  if (labels.size() == 0)
+    return;
+  out_ += '{';
+  bool first = true;
+  for (const auto &[name, value] : labels) {
+    if (!first)
+      out_ += ',';
+    first = false;
+    out_ += name;
+    out_ += "=\"";
+    appendEscaped(out_, value);
+    out_ += '"';
+  }
+  out_ += '}';
+}
+
+void MetricsWriter::value(const std::string &text) {
+  out_ += ' ';
+  out_ += text;
+  out_ += '\n';
+}
+
+void MetricsWriter::sample(std::string_view name, uint64_t value,
+                           Labels labels) {
+  out_ += name;
+  this->labels(labels);
+  this->value(std::to_string(value));
+}
+
+void MetricsWriter::sample(std::string_view name, double value,
+                           Labels labels) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.9g", value);
+  out_ += name;
+  this->labels(labels);
+  this->value(text);
+}
+
+void MetricsWriter::summary(
+    std::string_view name, std::string_view help, std::string_view labelName,
+    const std::vector<std::pair<std::string, const LatencyHistogram *>>
+        &series) {
+  static constexpr std::pair<double, const char *> QUANTILES[] = {
+      {0.5, "0.5"}, {0.9, "0.9"}, {0.99, "0.99"}, {0.999, "0.999"}};
+
+  family(name, "summary", help);
+  std::string sum = std::string(name) + "_sum";
+  std::string count = std::string(name) + "_count";
+  for (const auto &[label, histogram] : series) {
+    for (const auto &[q, text] : QUANTILES) {
+      sample(name, static_cast<double>(histogram->percentile(q)) / 1e9,
+             {{labelName, label}, {"quantile", text}});
+    }
+    sample(sum, static_cast<double>(histogram->sumNanos) / 1e9,
+           {{labelName, label}});
+    sample(count, histogram->total, {{labelName, label}});
+  }
+}
+
+// AdminServer
+
+AdminServer::AdminServer(uint16_t port)
+    : port_(port), listenSocket_(INVALID_SOCKET), running_(false) {}
+
+AdminServer::~AdminServer() { stop(); }
+
+void AdminServer::addCollector(Collector collector) {
+  collectors_.push_back(std::move(collector));
+}
+
+bool AdminServer::start() {
+#ifdef _WIN32
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+    std::cerr << "Admin: WSAStartup failed" << std::endl;
+    return false;
+  }
+#endif
+
+  listenSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenSocket_ == INVALID_SOCKET) {
+    std::cerr << "Admin: socket creation failed: " << WSAGetLastError()
+              << std::endl;
+    return false;
+  }
+
+#ifndef _WIN32
+  int reuse = 1;
+  setsockopt(listenSocket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+  // Loopback only: the snapshot names clients and is served unauthenticated.
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port_);
+
+  if (bind(listenSocket_, (sockaddr *)&address, sizeof(address)) ==
+          SOCKET_ERROR ||
+      listen(listenSocket_, 16) == SOCKET_ERROR) {
+    std::cerr << "Admin: cannot listen on 127.0.0.1:" << port_ << ": "
+              << WSAGetLastError() << std::endl;
+    closesocket(listenSocket_);
+    listenSocket_ = INVALID_SOCKET;
+    return false;
+  }
+
+  running_ = true;
+  thread_ = std::thread([this]() { run(); });
+  std::cout << "Metrics on http://127.0.0.1:" << port_ << "/metrics"
+            << std::endl;
+  return true;
+}
+
+void AdminServer::stop() {
+  if (!running_.exchange(false))
+    return;
+  if (thread_.joinable())
+    thread_.join();
+  closesocket(listenSocket_);
+  listenSocket_ = INVALID_SOCKET;
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+
+std::string AdminServer::render() const {
+  std::lock_guard<std::mutex> lock(renderMutex_);
+  MetricsWriter out;
+  for (const auto &collector : collectors_)
+    collector(out);
+  return out.text();
+}
+
+void AdminServer::run() {
+  while (running_) {
+    pollfd descriptor{};
+    descriptor.fd = listenSocket_;
+    descriptor.events = POLLIN;
+    int ready = pollSockets(&descriptor, 1, POLL_INTERVAL_MS);
+    if (ready <= 0)
+      continue;
+
+    SOCKET client = accept(listenSocket_, nullptr, nullptr);
+    if (client == INVALID_SOCKET)
+      continue;
+    handle(client);
+    closesocket(client);
+  }
+}
+
+void AdminServer::handle(SOCKET client) {
+  // Read up to the end of the request head; the body, if any, is ignored.
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.find("\n\n") == std::string::npos &&
+         request.size() < MAX_REQUEST) {
+    pollfd descriptor{};
+    descriptor.fd = client;
+    descriptor.events = POLLIN;
+    if (pollSockets(&descriptor, 1, REQUEST_TIMEOUT_MS) <= 0)
+      return;
+    int received = recv(client, buffer, sizeof(buffer), 0);
+    if (received <= 0)
+      return;
+    request.append(buffer, static_cast<size_t>(received));
+  }
+
+  if (request.compare(0, 4, "GET ") != 0) {
+    sendAll(client, response("405 Method Not Allowed", "text/plain",
+                             "Only GET is supported\n"));
+    return;
+  }
+  size_t pathEnd = request.find_first_of(" \r\n", 4);
+  std::string path = request.substr(4, pathEnd - 4);
+  if (path != "/" && path != "/metrics") {
+    sendAll(client, response("404 Not Found", "text/plain",
+                             "Try /metrics\n"));
+    return;
+  }
+
+  sendAll(client, response("200 OK", "text/plain; version=0.0.4",
+                           render()));
+}
+
+// Server collector
+
+void collectServerMetrics(MetricsWriter &out, Server &server) {
+  ConnectionManager &connections = server.getConnectionManager();
+
+  // One epoch-pinned pass over the table; each connection's send lock is
+  // held only while its queue size is read.
+  uint64_t active = 0;
+  uint64_t queuedTotal = 0;
+  uint64_t queuedMax = 0;
+  std::vector<std::pair<uint32_t, uint64_t>> backlogged;
+  connections.forEachActive([&](ConnectionInfo &info) {
+    ++active;
+    uint64_t queued;
+    {
+      std::lock_guard<std::mutex> lock(info.sendMutex);
+      queued = info.queuedBytes;
+    }
+    queuedTotal += queued;
+    queuedMax = std::max(queuedMax, queued);
+    if (queued > 0)
+      backlogged.emplace_back(info.id, queued);
+  });
+
+  out.family("net_connections", "gauge",
+             "Connections in the table, by whether they are active.");
+  uint64_t all = connections.getConnectionCount();
+  out.sample("net_connections", active, {{"state", "active"}});
+  out.sample("net_connections", all > active ? all - active : 0,
+             {{"state", "other"}});
+
+  MessageQueue &queue = server.getMessageQueue();
+  out.family("net_message_queue_depth", "gauge",
+             "Packets waiting in the server's MessageQueue.");
+  out.sample("net_message_queue_depth", static_cast<uint64_t>(queue.size()));
+  out.family("net_message_queue_capacity", "gauge",
+             "Capacity of the server's MessageQueue.");
+  out.sample("net_message_queue_capacity",
+             static_cast<uint64_t>(queue.capacity()));
+
+  out.family("net_send_queue_bytes_total", "gauge",
+             "Bytes queued for sending over all active connections.");
+  out.sample("net_send_queue_bytes_total", queuedTotal);
+  out.family("net_send_queue_bytes_max", "gauge",
+             "Largest send queue of any active connection, in bytes.");
+  out.sample("net_send_queue_bytes_max", queuedMax);
+  out.family("net_send_queue_bytes", "gauge",
+             "Bytes queued for sending, per connection with a backlog.");
+  for (const auto &[id, queued] : backlogged)
+    out.sample("net_send_queue_bytes", queued,
+               {{"client", std::to_string(id)}});
+
+  std::vector<PacketTypeStats> stats = PacketMetrics::instance().snapshot();
+  std::vector<std::string> names;
+  names.reserve(stats.size());
+  for (const auto &row : stats) {
+    const char *name = messageTypeName(row.type);
+    names.push_back(name ? name
+                         : row.type ? std::to_string(row.type) : "other");
+  }
+
+  struct Counter {
+    const char *name;
+    const char *help;
+    uint64_t PacketTypeStats::*field;
+  };
+  static constexpr Counter COUNTERS[] = {
+      {"net_packets_received_total", "Packets received, by message type.",
+       &PacketTypeStats::packetsIn},
+      {"net_packet_bytes_received_total",
+       "Bytes received including headers, by message type.",
+       &PacketTypeStats::bytesIn},
+      {"net_packets_sent_total",
+       "Packets queued for sending (one per recipient), by message type.",
+       &PacketTypeStats::packetsOut},
+      {"net_packet_bytes_sent_total",
+       "Bytes queued for sending including headers, by message type.",
+       &PacketTypeStats::bytesOut},
+  };
+  for (const auto &counter : COUNTERS) {
+    out.family(counter.name, "counter", counter.help);
+    for (size_t i = 0; i < stats.size(); ++i)
+      out.sample(counter.name, stats[i].*counter.field,
+                 {{"type", names[i]}});
+  }
+
+  struct Stage {
+    const char *name;
+    const char *help;
+    LatencyHistogram PacketTypeStats::*field;
+  };
+  static constexpr Stage STAGES[] = {
+      {"net_packet_queued_seconds",
+       "Time from the read that delivered a packet until it was decoded.",
+       &PacketTypeStats::queued},
+      {"net_packet_handled_seconds",
+       "Time in the packet callback, by message type.",
+       &PacketTypeStats::handled},
+      {"net_packet_send_seconds",
+       "Time spent queueing one outgoing copy (sampled), by message type.",
+       &PacketTypeStats::sent},
+  };
+  for (const auto &stage : STAGES) {
+    std::vector<std::pair<std::string, const LatencyHistogram *>> series;
+    for (size_t i = 0; i < stats.size(); ++i) {
+      const LatencyHistogram &histogram = stats[i].*stage.field;
+      if (histogram.total > 0)
+        series.emplace_back(names[i], &histogram);
+    }
+    out.summary(stage.name, stage.help, "type", series);
+  }
+}
+
+} // namespace net
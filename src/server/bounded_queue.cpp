@@ -0,0 +1,58 @@
+#include "server/bounded_queue.h"
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace net {
+
+uint32_t WaitSignal::beginWait() {
+  waiters_.fetch_add(1, std::memory_order_seq_cst);
+  return word_.load(std::memory_order_seq_cst);
+}
+
+void WaitSignal::endWait() {
+  waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void WaitSignal::wait(uint32_t observed, std::chrono::nanoseconds timeout) {
+#ifdef __linux__
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec relative{};
+  relative.tv_sec = static_cast<time_t>(seconds.count());
+  relative.tv_nsec = static_cast<long>((timeout - seconds).count());
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word_),
+          FUTEX_WAIT_PRIVATE, observed, &relative, nullptr, 0);
+#else
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait_for(lock, timeout, [&] {
+    return word_.load(std::memory_order_seq_cst) != observed;
+  });
+#endif
+}
+
+void WaitSignal::notify(bool all) {
+  // Orders the caller's preceding publish before the waiter check; pairs
+  // with the seq_cst increment in beginWait().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters_.load(std::memory_order_relaxed) == 0)
+    return;
+
+  word_.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word_), FUTEX_WAKE_PRIVATE,
+          all ? INT_MAX : 1, nullptr, nullptr, 0);
+#else
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (all)
+    condition_.notify_all();
+  else
+    condition_.notify_one();
+#endif
+}
+
+} // namespace net
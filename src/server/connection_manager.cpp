@@ -3,131 +3,276 @@
 
 namespace net {
 
+ConnectionManager::Table::Table(size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<Entry *>[capacity]) {
+  for (size_t i = 0; i < capacity; ++i)
+    slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+ConnectionManager::ConnectionManager(size_t shardCount)
+    : shards_(std::max<size_t>(1, shardCount)) {
+  for (Shard &shard : shards_)
+    shard.table.store(new Table(MIN_CAPACITY), std::memory_order_release);
+}
+
+ConnectionManager::~ConnectionManager() {
+  for (Shard &shard : shards_) {
+    Table *table = shard.table.load(std::memory_order_acquire);
+    for (size_t i = 0; i <= table->mask; ++i) {
+      Entry *entry = table->slots[i].load(std::memory_order_relaxed);
+      if (isLive(entry))
+        delete entry;
+    }
+    delete table;
+  }
+}
+
+size_t ConnectionManager::hash(uint32_t id) {
+  // murmur3 finalizer: ids are sequential with a stride of shardCount.
+  id ^= id >> 16;
+  id *= 0x85ebca6bu;
+  id ^= id >> 13;
+  id *= 0xc2b2ae35u;
+  id ^= id >> 16;
+  return id;
+}
+
+const ConnectionManager::Entry *ConnectionManager::find(uint32_t id) const {
+  const Table *table =
+      shardFor(id).table.load(std::memory_order_acquire);
+
+  for (size_t i = hash(id) & table->mask;; i = (i + 1) & table->mask) {
+    const Entry *entry = table->slots[i].load(std::memory_order_acquire);
+    if (!entry)
+      return nullptr;
+    if (entry != tombstone() && entry->id == id)
+      return entry;
+  }
+}
+
+std::atomic<ConnectionManager::Entry *> *
+ConnectionManager::findSlot(Shard &shard, uint32_t id) {
+  Table *table = shard.table.load(std::memory_order_relaxed);
+
+  for (size_t i = hash(id) & table->mask;; i = (i + 1) & table->mask) {
+    Entry *entry = table->slots[i].load(std::memory_order_relaxed);
+    if (!entry)
+      return nullptr;
+    if (entry != tombstone() && entry->id == id)
+      return &table->slots[i];
+  }
+}
+
+void ConnectionManager::unindexUsername(uint32_t id,
+                                        const InternedString &username) {
+  if (username.empty())
+    return;
+  auto [first, last] = byUsername_.equal_range(username.view());
+  for (auto it = first; it != last; ++it) {
+    if (it->second == id) {
+      byUsername_.erase(it);
+      return;
+    }
+  }
+}
+
+void ConnectionManager::eraseSlot(Shard &shard, std::atomic<Entry *> &slot) {
+  Entry *entry = slot.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(usernameMutex_);
+    unindexUsername(entry->id, entry->info->username);
+  }
+  slot.store(tombstone(), std::memory_order_release);
+  shard.size.fetch_sub(1, std::memory_order_relaxed);
+  EpochReclaimer::instance().retire([entry] { delete entry; });
+}
+
+void ConnectionManager::rehash(Shard &shard, size_t capacity) {
+  Table *oldTable = shard.table.load(std::memory_order_relaxed);
+  Table *newTable = new Table(capacity);
+
+  for (size_t i = 0; i <= oldTable->mask; ++i) {
+    Entry *entry = oldTable->slots[i].load(std::memory_order_relaxed);
+    if (!isLive(entry))
+      continue;
+
+    size_t j = hash(entry->id) & newTable->mask;
+    while (newTable->slots[j].load(std::memory_order_relaxed))
+      j = (j + 1) & newTable->mask;
+    newTable->slots[j].store(entry, std::memory_order_relaxed);
+  }
+
+  // Entries move to the new table as-is; only the old slot array retires.
+  shard.table.store(newTable, std::memory_order_release);
+  shard.used = shard.size.load(std::memory_order_relaxed);
+  EpochReclaimer::instance().retire([oldTable] { delete oldTable; });
+}
+
 bool ConnectionManager::addConnection(uint32_t id, SOCKET socket,
                                       const sockaddr_in &address) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  Shard &shard = shardFor(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
 
-  if (connections_.find(id) != connections_.end())
+  if (findSlot(shard, id))
     return false;
 
-  auto info = std::make_shared<ConnectionInfo>(id, socket, address);
-  connections_[id] = info;
+  Table *table = shard.table.load(std::memory_order_relaxed);
+  if ((shard.used + 1) * 4 > (table->mask + 1) * 3) {
+    size_t live = shard.size.load(std::memory_order_relaxed) + 1;
+    size_t capacity = MIN_CAPACITY;
+    while (live * 2 > capacity)
+      capacity *= 2;
+    rehash(shard, capacity);
+    table = shard.table.load(std::memory_order_relaxed);
+  }
+
+  auto *entry =
+      new Entry{id, std::make_shared<ConnectionInfo>(id, socket, address)};
+
+  size_t i = hash(id) & table->mask;
+  while (true) {
+    Entry *current = table->slots[i].load(std::memory_order_relaxed);
+    if (!current) {
+      shard.used++;
+      break;
+    }
+    if (current == tombstone())
+      break;
+    i = (i + 1) & table->mask;
+  }
+
+  table->slots[i].store(entry, std::memory_order_release);
+  shard.size.fetch_add(1, std::memory_order_relaxed);
   return true;
 }
 
 bool ConnectionManager::removeConnection(uint32_t id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return connections_.erase(id) > 0;
+  Shard &shard = shardFor(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  std::atomic<Entry *> *slot = findSlot(shard, id);
+  if (!slot)
+    return false;
+
+  eraseSlot(shard, *slot);
+  return true;
 }
 
 std::shared_ptr<ConnectionInfo>
 ConnectionManager::getConnection(uint32_t id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = connections_.find(id);
-  return it != connections_.end() ? it->second : nullptr;
+  auto guard = EpochReclaimer::instance().pin();
+  const Entry *entry = find(id);
+  return entry ? entry->info : nullptr;
 }
 
 bool ConnectionManager::hasConnection(uint32_t id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return connections_.find(id) != connections_.end();
+  auto guard = EpochReclaimer::instance().pin();
+  return find(id) != nullptr;
 }
 
 bool ConnectionManager::setStatus(uint32_t id, ConnectionStatus status) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = connections_.find(id);
-  if (it != connections_.end()) {
-    it->second->status = status;
-    return true;
-  }
-  return false;
+  return withConnection(id,
+                        [status](ConnectionInfo &info) { info.status = status; });
 }
 
 bool ConnectionManager::setUsername(uint32_t id, const std::string &username) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = connections_.find(id);
-  if (it != connections_.end()) {
-    it->second->username = username;
-    return true;
-  }
-  return false;
+  InternedString name(username);
+  Shard &shard = shardFor(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  std::atomic<Entry *> *slot = findSlot(shard, id);
+  if (!slot)
+    return false;
+
+  ConnectionInfo &info = *slot->load(std::memory_order_relaxed)->info;
+  std::lock_guard<std::mutex> indexLock(usernameMutex_);
+  unindexUsername(id, info.username);
+  info.username = name;
+  if (!name.empty())
+    byUsername_.emplace(name.view(), id);
+  return true;
 }
 
 bool ConnectionManager::updateHeartbeat(uint32_t id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = connections_.find(id);
-  if (it != connections_.end()) {
-    it->second->lastHeartbeat = std::chrono::steady_clock::now();
-    return true;
-  }
-
-  return false;
+  return withConnection(id, [](ConnectionInfo &info) {
+    info.lastHeartbeat = std::chrono::steady_clock::now();
+  });
 }
 
 std::vector<uint32_t> ConnectionManager::getActiveConnections() const {
-  std::lock_guard<std::mutex> lock(mutex_);
   std::vector<uint32_t> ids;
-  ids.reserve(connections_.size());
-
-  for (const auto &[id, info] : connections_) {
-    if (info->status == ConnectionStatus::ACTIVE)
-      ids.push_back(id);
-  }
-
+  forEachActive([&ids](const ConnectionInfo &info) { ids.push_back(info.id); });
   return ids;
 }
 
 std::vector<std::shared_ptr<ConnectionInfo>>
 ConnectionManager::getAllConnections() const {
-  std::lock_guard<std::mutex> lock(mutex_);
   std::vector<std::shared_ptr<ConnectionInfo>> result;
-  result.reserve(connections_.size());
+  auto guard = EpochReclaimer::instance().pin();
 
-  for (const auto &pair : connections_)
-    result.push_back(pair.second);
+  for (const Shard &shard : shards_) {
+    const Table *table = shard.table.load(std::memory_order_acquire);
+    result.reserve(result.size() + shard.size.load(std::memory_order_relaxed));
+    for (size_t i = 0; i <= table->mask; ++i) {
+      const Entry *entry = table->slots[i].load(std::memory_order_acquire);
+      if (isLive(entry))
+        result.push_back(entry->info);
+    }
+  }
   return result;
 }
 
 size_t ConnectionManager::getConnectionCount() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return connections_.size();
+  size_t count = 0;
+  for (const Shard &shard : shards_)
+    count += shard.size.load(std::memory_order_relaxed);
+  return count;
 }
 
 size_t ConnectionManager::getActiveConnectionCount() const {
-  std::lock_guard<std::mutex> lock(mutex_);
   size_t count = 0;
-  for (const auto &pair : connections_) {
-    if (pair.second->status == ConnectionStatus::ACTIVE)
-      count++;
-  }
+  forEachActive([&count](const ConnectionInfo &) { count++; });
   return count;
 }
 
 std::shared_ptr<ConnectionInfo>
-ConnectionManager::findConnectionByUsername(const std::string &username) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  for (const auto &pair : connections_) {
-    if (pair.second->username == username)
-      return pair.second;
+ConnectionManager::findConnectionByUsername(std::string_view username) const {
+  uint32_t id = 0;
+  {
+    std::lock_guard<std::mutex> lock(usernameMutex_);
+    auto it = byUsername_.find(username);
+    if (it == byUsername_.end())
+      return nullptr;
+    id = it->second;
   }
-
-  return nullptr;
+  // May be gone by now, like any lookup racing a removal.
+  return getConnection(id);
 }
 
 void ConnectionManager::cleanupInactiveConnections() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto it = connections_.begin();
-
-  while (it != connections_.end()) {
-    if (it->second->status == ConnectionStatus::DISCONNECTING)
-      it = connections_.erase(it);
-    else
-      ++it;
+  for (Shard &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Table *table = shard.table.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i <= table->mask; ++i) {
+      Entry *entry = table->slots[i].load(std::memory_order_relaxed);
+      if (isLive(entry) &&
+          entry->info->status == ConnectionStatus::DISCONNECTING)
+        eraseSlot(shard, table->slots[i]);
+    }
   }
 }
 
 void ConnectionManager::clearAllConnections() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  connections_.clear();
+  for (Shard &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Table *table = shard.table.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i <= table->mask; ++i) {
+      if (isLive(table->slots[i].load(std::memory_order_relaxed)))
+        eraseSlot(shard, table->slots[i]);
+    }
+    rehash(shard, MIN_CAPACITY);
+  }
 }
 
-} // namespace net
\ No newline at end of file
+} // namespace net
@@ -1,14 +1,24 @@
 #define WIN32_LEAN_AND_MEAN
 #include "common/packet.h"
+#include "server/admin_server.h"
 #include "server/server.h"
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <thread>
+
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <csignal>
+#include <pthread.h>
+#endif
 
 using namespace net;
 
 Server *g_server = nullptr;
 
+#ifdef _WIN32
 BOOL WINAPI ConsoleHandler(DWORD dwType) {
   if (dwType == CTRL_C_EVENT && g_server) {
     std::cout << "Shutting down server..." << std::endl;
@@ -18,24 +28,74 @@ BOOL WINAPI ConsoleHandler(DWORD dwType) {
 
   return FALSE;
 }
+#else
+// Blocks SIGINT/SIGTERM in every thread spawned afterwards and stops the
+// server from a sigwait() thread, where calling stop() is safe.
+bool installShutdownHandler() {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  if (pthread_sigmask(SIG_BLOCK, &signals, nullptr) != 0)
+    return false;
+
+  std::thread([signals]() {
+    int signal = 0;
+    if (sigwait(&signals, &signal) == 0 && g_server) {
+      std::cout << "Shutting down server..." << std::endl;
+      g_server->stop();
+    }
+  }).detach();
+  return true;
+}
+#endif
 
-int main() {
+int main(int argc, char *argv[]) {
   const uint16_t PORT = 8000;
 
+  // --admin-port: serve Prometheus metrics on 127.0.0.1:N (default off).
+  long adminPort = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--admin-port" && i + 1 < argc) {
+      adminPort = std::strtol(argv[++i], nullptr, 10);
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--admin-port N]" << std::endl;
+      return 1;
+    }
+  }
+  if (adminPort < 0 || adminPort > 65535) {
+    std::cerr << "Usage: " << argv[0] << " [--admin-port N]" << std::endl;
+    return 1;
+  }
+
   Server server(PORT);
   g_server = &server;
 
+#ifdef _WIN32
   if (!SetConsoleCtrlHandler(ConsoleHandler, TRUE))
     std::cerr << "Failed to set console handler" << std::endl;
+#else
+  if (!installShutdownHandler())
+    std::cerr << "Failed to set signal handler" << std::endl;
+#endif
 
-  server.setPacketCallback([&server](const Packet &packet, uint32_t clientId) {
-    std::string message(packet.getData().begin(), packet.getData().end());
+  server.setPacketViewCallback([&server](const PacketView &packet,
+                                         uint32_t clientId) {
     std::cout << "Received message from client [" << clientId
-              << "]: " << message << std::endl;
+              << "]: " << packet.asString() << std::endl;
 
-    server.broadcast(packet);
+    server.broadcast(packet.toPacket());
   });
 
+  AdminServer admin(static_cast<uint16_t>(adminPort));
+  if (adminPort > 0) {
+    admin.addCollector(
+        [&server](MetricsWriter &out) { collectServerMetrics(out, server); });
+    if (!admin.start())
+      return 1;
+  }
+
   std::cout << "Starting server on port " << PORT << "..." << std::endl;
   std::cout << "Press Ctrl+C to shutdown" << std::endl;
 
@@ -44,6 +104,9 @@ int main() {
     return 1;
   }
 
+  admin.stop();
   std::cout << "Server stopped" << std::endl;
+  std::cout << "Packet statistics:" << std::endl;
+  writePacketStats(std::cout, PacketMetrics::instance().snapshot());
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "server/epoch_reclaimer.h"
+#include <algorithm>
+
+namespace net {
+
+EpochReclaimer::Guard::Guard(EpochReclaimer &reclaimer)
+    : reclaimer_(reclaimer) {
+  reclaimer_.enter();
+}
+
+EpochReclaimer::Guard::~Guard() { reclaimer_.exit(); }
+
+EpochReclaimer::~EpochReclaimer() {
+  for (auto &entry : retired_)
+    entry.second();
+}
+
+EpochReclaimer &EpochReclaimer::instance() {
+  // Leaked on purpose: thread-exit hooks may run after static destruction.
+  static EpochReclaimer *reclaimer = new EpochReclaimer();
+  return *reclaimer;
+}
+
+void EpochReclaimer::enter() {
+  Slot &slot = slots_.local();
+  if (slot.depth++ > 0)
+    return;
+
+  // The seq_cst store orders the pin before any load of shared pointers.
+  slot.epoch.store(globalEpoch_.load(std::memory_order_seq_cst),
+                   std::memory_order_seq_cst);
+}
+
+void EpochReclaimer::exit() {
+  Slot &slot = slots_.local();
+  if (--slot.depth > 0)
+    return;
+
+  slot.epoch.store(IDLE, std::memory_order_release);
+}
+
+void EpochReclaimer::retire(std::function<void()> deleter) {
+  bool shouldCollect;
+  {
+    std::lock_guard<std::mutex> lock(retiredMutex_);
+    retired_.emplace_back(globalEpoch_.fetch_add(1, std::memory_order_seq_cst),
+                          std::move(deleter));
+    shouldCollect = retired_.size() >= collectAt_;
+  }
+
+  if (shouldCollect)
+    collect();
+}
+
+uint64_t EpochReclaimer::minPinnedEpoch() const {
+  uint64_t minimum = IDLE;
+  for (Slot *slot = slots_.head(); slot; slot = slot->next)
+    minimum = std::min(minimum, slot->epoch.load(std::memory_order_seq_cst));
+  return minimum;
+}
+
+void EpochReclaimer::collect() {
+  std::vector<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lock(retiredMutex_);
+    uint64_t minimum = minPinnedEpoch();
+
+    auto keep = std::partition(
+        retired_.begin(), retired_.end(),
+        [minimum](const auto &entry) { return entry.first >= minimum; });
+    for (auto it = keep; it != retired_.end(); ++it)
+      ready.push_back(std::move(it->second));
+    retired_.erase(keep, retired_.end());
+
+    // Long read sections keep entries alive; back off so retire() stays
+    // amortized O(1) instead of rescanning the survivors every time.
+    collectAt_ = std::max(COLLECT_THRESHOLD, retired_.size() * 2);
+  }
+
+  // Deleters run outside the lock; they may release connection state.
+  for (auto &deleter : ready)
+    deleter();
+}
+
+size_t EpochReclaimer::pendingCount() const {
+  std::lock_guard<std::mutex> lock(retiredMutex_);
+  return retired_.size();
+}
+
+} // namespace net
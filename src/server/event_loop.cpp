@@ -0,0 +1,349 @@
+#include "server/event_loop.h"
+#include "server/send_queue.h"
+#include "server/server.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+
+namespace net {
+
+EventLoop::EventLoop(Server &server, size_t index)
+    : server_(server), index_(index), epollFd_(-1), wakeupFd_(-1),
+      listenSocket_(INVALID_SOCKET), timers_(Server::TIMER_TICK) {}
+
+EventLoop::~EventLoop() {
+  if (wakeupFd_ != -1)
+    ::close(wakeupFd_);
+  if (epollFd_ != -1)
+    ::close(epollFd_);
+}
+
+bool EventLoop::init() {
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd_ == -1) {
+    std::cerr << "epoll_create1 failed: " << errno << std::endl;
+    return false;
+  }
+
+  wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeupFd_ == -1) {
+    std::cerr << "eventfd failed: " << errno << std::endl;
+    return false;
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLET;
+  event.data.u64 = WAKEUP_TOKEN;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeupFd_, &event) == -1) {
+    std::cerr << "epoll_ctl(wakeup) failed: " << errno << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool EventLoop::watchListener(SOCKET listenSocket) {
+  if (!setNonBlocking(listenSocket))
+    return false;
+
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLET;
+  event.data.u64 = LISTENER_TOKEN;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenSocket, &event) == -1) {
+    std::cerr << "epoll_ctl(listener) failed: " << errno << std::endl;
+    return false;
+  }
+
+  listenSocket_ = listenSocket;
+  return true;
+}
+
+void EventLoop::run() {
+  epoll_event events[MAX_EVENTS];
+
+  while (server_.running_) {
+    // Poll rather than block while connections still have unread data.
+    int timeout = readReady_.empty()
+                      ? timers_.msUntilNext(TimerWheel::Clock::now())
+                      : 0;
+    int count = epoll_wait(epollFd_, events, MAX_EVENTS, timeout);
+    if (count == -1) {
+      if (errno == EINTR)
+        continue;
+      std::cerr << "epoll_wait failed [Loop: " << index_ << "]: " << errno
+                << std::endl;
+      break;
+    }
+
+    // Before the events, so timers they arm count from a current tick.
+    timers_.advance(TimerWheel::Clock::now());
+
+    for (int i = 0; i < count; ++i) {
+      uint64_t token = events[i].data.u64;
+      uint32_t mask = events[i].events;
+
+      if (token == WAKEUP_TOKEN) {
+        uint64_t value;
+        while (::read(wakeupFd_, &value, sizeof(value)) > 0) {
+        }
+        drainPending();
+        continue;
+      }
+
+      if (token == LISTENER_TOKEN) {
+        acceptClients();
+        continue;
+      }
+
+      uint32_t clientId = static_cast<uint32_t>(token);
+      if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        handleReadable(clientId);
+      if (mask & EPOLLOUT)
+        handleWritable(clientId);
+    }
+
+    serviceReadReady();
+  }
+
+  drainPending();
+  closeAll();
+}
+
+void EventLoop::wakeup() {
+  uint64_t one = 1;
+  ssize_t written = ::write(wakeupFd_, &one, sizeof(one));
+  (void)written;
+}
+
+void EventLoop::adopt(std::shared_ptr<ConnectionInfo> connection) {
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pending_.push_back(std::move(connection));
+  }
+  wakeup();
+}
+
+void EventLoop::drainPending() {
+  std::vector<std::shared_ptr<ConnectionInfo>> pending;
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pending.swap(pending_);
+  }
+
+  for (auto &connection : pending) {
+    if (server_.running_) {
+      registerConnection(std::move(connection));
+    } else {
+      connections_[connection->id].info = connection;
+    }
+  }
+}
+
+void EventLoop::acceptClients() {
+  auto &loops = server_.eventLoops_;
+
+  while (server_.running_) {
+    sockaddr_in clientAddr{};
+    socklen_t clientAddrSize = sizeof(clientAddr);
+    SOCKET clientSocket =
+        accept4(listenSocket_, (sockaddr *)&clientAddr, &clientAddrSize,
+                SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (clientSocket == INVALID_SOCKET) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        std::cerr << "Accept failed: " << errno << std::endl;
+      return;
+    }
+
+    int noDelay = 1;
+    setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay,
+               sizeof(noDelay));
+
+    uint32_t clientId =
+        server_.registerClient(clientSocket, clientAddr, index_);
+    if (clientId == 0)
+      continue;
+
+    auto connection = server_.connectionManager_.getConnection(clientId);
+    if (!connection)
+      continue;
+
+    IoLoop &owner = *loops[clientId % loops.size()];
+    if (&owner == this)
+      registerConnection(std::move(connection));
+    else
+      owner.adopt(std::move(connection));
+  }
+}
+
+void EventLoop::registerConnection(std::shared_ptr<ConnectionInfo> connection) {
+  uint32_t clientId = connection->id;
+  SOCKET socket = connection->socket;
+  connections_[clientId].info = std::move(connection);
+  if (server_.idleTimersEnabled())
+    armIdleTimer(clientId, server_.firstIdleCheck());
+
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.u64 = clientId;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event) == -1) {
+    std::cerr << "epoll_ctl(client) failed [ID: " << clientId
+              << "]: " << errno << std::endl;
+    closeConnection(clientId);
+  }
+}
+
+void EventLoop::handleReadable(uint32_t clientId) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+
+  // Reads land in the connection's free tail first and spill into a shared
+  // overflow chunk, so idle connections keep small buffers while a burst
+  // still drains in one readv().
+  static thread_local std::vector<uint8_t> overflow(READ_CHUNK_SIZE);
+  LoopConnection &connection = it->second;
+  ReceiveBuffer &buffer = connection.receiveBuffer;
+  SOCKET socket = connection.info->socket;
+  bool closed = false;
+  bool received = false;
+  bool drained = false;
+  connection.readReady = false;
+
+  // Edge-triggered: read until the kernel buffer is drained or the budget
+  // runs out, handing each chunk to the server as it arrives.
+  for (int reads = 0; reads < READ_BUDGET;) {
+    iovec chunks[2];
+    chunks[0].iov_base = buffer.prepare(MIN_READ_SPACE);
+    chunks[0].iov_len = buffer.writable();
+    chunks[1].iov_base = overflow.data();
+    chunks[1].iov_len = overflow.size();
+    ssize_t bytesReceived = readv(socket, chunks, 2);
+
+    if (bytesReceived > 0) {
+      size_t direct = std::min(static_cast<size_t>(bytesReceived),
+                               chunks[0].iov_len);
+      buffer.commit(direct);
+      buffer.append(overflow.data(),
+                    static_cast<size_t>(bytesReceived) - direct);
+      server_.processReceivedData(clientId, buffer);
+      received = true;
+      ++reads;
+      continue;
+    }
+
+    if (bytesReceived == 0) {
+      std::cout << "Client disconnected [ID: " << clientId << "]"
+                << std::endl;
+      closed = true;
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      if (errno == ECONNRESET)
+        std::cout << "Connection reset by client [ID: " << clientId << "]"
+                  << std::endl;
+      else
+        std::cerr << "Receive failed [ID: " << clientId << "]: " << errno
+                  << std::endl;
+      closed = true;
+    }
+    drained = true;
+    break;
+  }
+
+  if (received)
+    server_.connectionManager_.updateHeartbeat(clientId);
+
+  if (closed) {
+    closeConnection(clientId);
+  } else if (!drained) {
+    // No EAGAIN yet, so epoll will not report this socket again.
+    connection.readReady = true;
+    readReady_.push_back(clientId);
+  }
+}
+
+void EventLoop::serviceReadReady() {
+  std::vector<uint32_t> ready;
+  ready.swap(readReady_);
+
+  for (uint32_t clientId : ready) {
+    auto it = connections_.find(clientId);
+    if (it != connections_.end() && it->second.readReady)
+      handleReadable(clientId);
+  }
+}
+
+void EventLoop::handleWritable(uint32_t clientId) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+
+  ConnectionInfo &info = *it->second.info;
+  std::lock_guard<std::mutex> lock(info.sendMutex);
+  if (!flushSendQueue(info)) {
+    // Peer is gone; the matching EPOLLHUP/EPOLLERR will tear it down.
+    shutdown(info.socket, SHUT_RDWR);
+  }
+}
+
+void EventLoop::armIdleTimer(uint32_t clientId,
+                             TimerWheel::Clock::duration delay) {
+  connections_[clientId].idleTimer =
+      timers_.schedule(delay, [this, clientId]() { onIdleTimer(clientId); });
+}
+
+void EventLoop::onIdleTimer(uint32_t clientId) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+  it->second.idleTimer = 0;
+
+  TimerWheel::Clock::duration next;
+  if (server_.checkIdle(*it->second.info, TimerWheel::Clock::now(), next))
+    armIdleTimer(clientId, next);
+  else
+    closeConnection(clientId);
+}
+
+void EventLoop::closeConnection(uint32_t clientId) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+
+  timers_.cancel(it->second.idleTimer);
+
+  std::shared_ptr<ConnectionInfo> info = std::move(it->second.info);
+  connections_.erase(it);
+
+  {
+    std::lock_guard<std::mutex> lock(info->sendMutex);
+    if (info->socket != INVALID_SOCKET) {
+      epoll_ctl(epollFd_, EPOLL_CTL_DEL, info->socket, nullptr);
+      closesocket(info->socket);
+      info->socket = INVALID_SOCKET;
+    }
+    info->sendQueue.clear();
+    info->sendOffset = 0;
+    info->queuedBytes = 0;
+  }
+
+  server_.onClientDisconnected(clientId);
+}
+
+void EventLoop::closeAll() {
+  while (!connections_.empty())
+    closeConnection(connections_.begin()->first);
+}
+
+void EventLoop::scheduleFlush(ConnectionInfo &connection) {
+  std::lock_guard<std::mutex> lock(connection.sendMutex);
+  if (!flushSendQueue(connection) && connection.socket != INVALID_SOCKET)
+    shutdown(connection.socket, SHUT_RDWR);
+}
+
+} // namespace net
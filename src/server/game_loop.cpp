@@ -0,0 +1,65 @@
+#include "server/game_loop.h"
+#include <utility>
+
+namespace net {
+
+GameLoop::GameLoop(CommandHandler handler,
+                   std::chrono::milliseconds tickInterval)
+    : handler_(std::move(handler)), tickInterval_(tickInterval),
+      commands_(COMMAND_CAPACITY, OverflowPolicy::BLOCK),
+      timers_(tickInterval), running_(false), ticks_(0) {}
+
+GameLoop::~GameLoop() { stop(); }
+
+void GameLoop::setTickCallback(TickCallback callback) {
+  tickCallback_ = std::move(callback);
+}
+
+void GameLoop::start() {
+  if (running_.exchange(true))
+    return;
+  thread_ = std::thread([this]() { run(); });
+}
+
+void GameLoop::stop() {
+  if (!running_.exchange(false))
+    return;
+  commands_.notifyAll();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void GameLoop::submit(GameCommand &&command) {
+  commands_.push(std::move(command));
+}
+
+void GameLoop::run() {
+  GameCommand batch[BATCH_SIZE];
+  auto nextTick = std::chrono::steady_clock::now() + tickInterval_;
+
+  while (running_.load(std::memory_order_relaxed)) {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= nextTick) {
+      uint64_t tick = ticks_.fetch_add(1, std::memory_order_relaxed) + 1;
+      if (tickCallback_)
+        tickCallback_(tick);
+      timers_.advance(now);
+      // Skip ticks missed during a long stall instead of bursting them.
+      while (nextTick <= now)
+        nextTick += tickInterval_;
+    }
+
+    size_t count = commands_.waitPopN(batch, BATCH_SIZE, nextTick - now);
+    for (size_t i = 0; i < count; ++i)
+      handler_(batch[i]);
+  }
+
+  // Apply what was accepted before shutdown, e.g. trailing leaves.
+  size_t count;
+  while ((count = commands_.tryPopN(batch, BATCH_SIZE)) > 0) {
+    for (size_t i = 0; i < count; ++i)
+      handler_(batch[i]);
+  }
+}
+
+} // namespace net
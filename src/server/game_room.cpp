@@ -0,0 +1,460 @@
+#include "server/game_room.h"
+#include "common/serialization.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace net {
+
+namespace {
+
+void logInfo(const std::string &msg) {
+  std::cout << "[INFO] " << msg << std::endl;
+}
+void logWarn(const std::string &msg) {
+  std::cout << "[WARN] " << msg << std::endl;
+}
+void logError(const std::string &msg) {
+  std::cerr << "[ERROR] " << msg << std::endl;
+}
+
+bool isTrailingSpace(char c) { return c == ' ' || c == '\n' || c == '\r'; }
+
+std::string_view trimTrailing(std::string_view text) {
+  while (!text.empty() && isTrailingSpace(text.back()))
+    text.remove_suffix(1);
+  return text;
+}
+
+void setText(GameCommand &command, std::string_view text) {
+  command.text.assign(reinterpret_cast<const uint8_t *>(text.data()),
+                      text.size());
+}
+
+} // namespace
+
+bool GameCommand::decode(const PacketView &packet, uint32_t clientId,
+                         GameCommand &command) {
+  command.clientId = clientId;
+
+  switch (packet.getType()) {
+  case MessageType::PLAYER_JOIN:
+    command.kind = Kind::JOIN;
+    setText(command, packet.asString());
+    return true;
+
+  case MessageType::CHAT_MESSAGE: {
+    std::string_view message = trimTrailing(packet.asString());
+    if (message.size() > 6 && message.substr(0, 6) == "/vote ") {
+      std::string_view target = message.substr(6);
+      while (!target.empty() && target.front() == ' ')
+        target.remove_prefix(1);
+      command.kind = Kind::VOTE;
+      setText(command, target);
+    } else {
+      command.kind = Kind::CHAT;
+      setText(command, message);
+    }
+    return true;
+  }
+
+  case MessageType::PLAYER_LEAVE:
+    command.kind = Kind::LEAVE;
+    command.text.clear();
+    return true;
+
+  case MessageType::STATE_ACK:
+    command.kind = Kind::ACK;
+    command.text.clear();
+    command.snapshotId = deserializeStateAck(packet.data(), packet.size());
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+GameRoom::GameRoom(Server &server, GameState &state)
+    : server_(server), state_(state) {}
+
+GameRoomStats &GameRoom::stats() {
+  static GameRoomStats stats;
+  return stats;
+}
+
+void GameRoom::setRoundTimeout(TimerWheel &timers,
+                               std::chrono::milliseconds timeout) {
+  timers_ = &timers;
+  roundTimeout_ = timeout;
+}
+
+void GameRoom::execute(const GameCommand &command) {
+  switch (command.kind) {
+  case GameCommand::Kind::JOIN:
+    onJoin(command.clientId, command.textView(), !command.holdRound);
+    break;
+  case GameCommand::Kind::CHAT:
+    onChat(command.clientId, command.textView());
+    break;
+  case GameCommand::Kind::VOTE:
+    onVote(command.clientId, command.textView());
+    break;
+  case GameCommand::Kind::LEAVE:
+    onLeave(command.clientId);
+    break;
+  case GameCommand::Kind::ACK:
+    onAck(command.clientId, command.snapshotId);
+    break;
+  case GameCommand::Kind::NONE:
+    break;
+  }
+}
+
+void GameRoom::defineStrings(const std::vector<uint32_t> &recipients,
+                             const std::vector<InternedString> &strings) {
+  std::vector<StringDefinition> missing;
+  for (uint32_t clientId : recipients) {
+    ClientSync &sync = clientSync_[clientId];
+    missing.clear();
+    for (const InternedString &text : strings) {
+      if (!text.empty() && sync.knownStrings.insert(text.id()).second)
+        missing.push_back(StringDefinition{text.id(), text.str()});
+    }
+    if (!missing.empty())
+      server_.sendPacket(clientId, encodeStringDefinitions(missing));
+  }
+}
+
+void GameRoom::sendTo(const std::vector<uint32_t> &recipients,
+                      const WireBuffer &wire,
+                      const std::vector<InternedString> &strings) {
+  if (strings.empty()) {
+    server_.multicast(recipients, wire);
+    return;
+  }
+  // Held across the send so no other thread can send a message using one
+  // of these ids ahead of its definition.
+  std::lock_guard<std::mutex> lock(syncMutex_);
+  defineStrings(recipients, strings);
+  server_.multicast(recipients, wire);
+}
+
+void GameRoom::sendToRoom(const WireBuffer &wire,
+                          const std::vector<InternedString> &strings) {
+  sendTo(state_.getAllPlayerIds(), wire, strings);
+}
+
+void GameRoom::sendToRoomExcept(uint32_t excludeClientId,
+                                const WireBuffer &wire,
+                                const std::vector<InternedString> &strings) {
+  std::vector<uint32_t> ids = state_.getAllPlayerIds();
+  ids.erase(std::remove(ids.begin(), ids.end(), excludeClientId), ids.end());
+  sendTo(ids, wire, strings);
+}
+
+void GameRoom::sendStateUpdate(const std::vector<uint32_t> &recipients) {
+  std::lock_guard<std::mutex> lock(syncMutex_);
+  uint32_t latest = history_.capture(state_.getAllPlayerStates());
+
+  std::vector<std::pair<uint32_t, std::vector<uint32_t>>> byBaseline;
+  for (uint32_t clientId : recipients) {
+    ClientSync &sync = clientSync_[clientId];
+    if (sync.sent == latest)
+      continue;
+    sync.sent = latest;
+
+    uint32_t baseline = history_.contains(sync.acked) ? sync.acked : 0;
+    auto group = std::find_if(
+        byBaseline.begin(), byBaseline.end(),
+        [baseline](const auto &entry) { return entry.first == baseline; });
+    if (group == byBaseline.end())
+      group = byBaseline.insert(byBaseline.end(), {baseline, {}});
+    group->second.push_back(clientId);
+  }
+
+  std::vector<InternedString> names;
+  for (const auto &[baseline, clientIds] : byBaseline) {
+    StateUpdate update = history_.diff(baseline);
+    names.clear();
+    for (const PlayerDelta &delta : update.players) {
+      if (delta.changed & PlayerDelta::USERNAME)
+        names.push_back(delta.username);
+    }
+    defineStrings(clientIds, names);
+    server_.multicast(clientIds, encodeGameStateUpdate(update));
+  }
+}
+
+void GameRoom::startNewRoundIfPossible() {
+  if (!state_.canStartRound()) {
+    logInfo("Cannot start round yet - waiting for enough players");
+    return;
+  }
+  if (state_.isRoundActive())
+    return;
+
+  logInfo("Starting next round");
+
+  InternedString topic;
+  InternedString word;
+  uint32_t liarId = 0;
+
+  try {
+    state_.startNewRound();
+    topic = state_.getCurrentTopic();
+    word = state_.getCurrentWord();
+    liarId = state_.getCurrentLiarId();
+  } catch (const std::exception &e) {
+    logError(std::string("Exception in startNewRound(): ") + e.what());
+    return;
+  } catch (...) {
+    logError("Unknown exception in startNewRound()");
+    return;
+  }
+
+  if (liarId == 0 || topic.empty()) {
+    logError("Round started but topic/liar not set properly");
+    return;
+  }
+
+  logInfo("Round info -> Topic: " + topic.str() + ", Word: " + word.str() +
+          ", Liar: Player [" + std::to_string(liarId) + "]");
+  stats().roundsStarted.fetch_add(1, std::memory_order_relaxed);
+
+  auto allPlayerStates = state_.getAllPlayerStates();
+  for (const auto &player : allPlayerStates) {
+    if (player.role == PlayerRole::LIAR) {
+      RoleAssignment assignment(player.id, PlayerRole::LIAR, topic, "");
+      sendTo({player.id}, encodeRoleAssignment(assignment), {topic});
+    } else if (player.role == PlayerRole::GUESSER) {
+      RoleAssignment assignment(player.id, PlayerRole::GUESSER, topic, word);
+      sendTo({player.id}, encodeRoleAssignment(assignment), {topic, word});
+    }
+  }
+
+  if (timers_ && roundTimeout_.count() > 0) {
+    cancelRoundTimer();
+    roundTimer_ =
+        timers_->schedule(roundTimeout_, [this]() { onRoundTimeout(); });
+  }
+}
+
+void GameRoom::cancelRoundTimer() {
+  if (timers_)
+    timers_->cancel(roundTimer_);
+  roundTimer_ = 0;
+}
+
+void GameRoom::onRoundTimeout() {
+  roundTimer_ = 0;
+  if (!state_.isRoundActive())
+    return;
+
+  VoteStanding standing = state_.getVoteStanding();
+  logInfo("Round timed out with " + std::to_string(standing.votesCast) +
+          " of " + std::to_string(standing.playerCount) + " votes cast");
+  stats().roundsTimedOut.fetch_add(1, std::memory_order_relaxed);
+  finishRound();
+}
+
+void GameRoom::onJoin(uint32_t clientId, std::string_view name,
+                      bool startRound) {
+  logInfo("Received PLAYER_JOIN packet from client [" +
+          std::to_string(clientId) + "]");
+  std::string username = "Player " + std::to_string(clientId);
+  if (!name.empty())
+    username = std::string(name);
+  logInfo("Attempting to add player [" + std::to_string(clientId) +
+          "] with username: " + username);
+  bool added = state_.addPlayer(clientId, username);
+  if (!added) {
+    logWarn("Failed to add player [" + std::to_string(clientId) +
+            "] - player may already exist");
+    return;
+  }
+  server_.getConnectionManager().setUsername(clientId, username);
+
+  logInfo("Player [" + std::to_string(clientId) +
+          "] joined the game. Current count: " +
+          std::to_string(state_.getPlayerCount()));
+  logInfo(std::string("Can start round: ") +
+          (state_.canStartRound() ? "yes" : "no") + ", Round active: " +
+          (state_.isRoundActive() ? "true" : "false"));
+
+  sendStateUpdate({clientId});
+
+  PlayerState newPlayer = state_.getPlayerState(clientId);
+  sendToRoomExcept(clientId,
+                   encodePlayerState(MessageType::PLAYER_JOINED, newPlayer),
+                   {newPlayer.username});
+
+  if (startRound)
+    startNewRoundIfPossible();
+}
+
+void GameRoom::onChat(uint32_t clientId, std::string_view message) {
+  auto connInfo = server_.getConnectionManager().getConnection(clientId);
+  if (!connInfo) {
+    std::cerr << "Warning: CHAT_MESSAGE from unknown client [" << clientId
+              << "]" << std::endl;
+    return;
+  }
+
+  PlayerState player = state_.getPlayerState(clientId);
+  InternedString username = player.username;
+  if (player.id == 0)
+    username = connInfo->username.empty()
+                   ? InternedString("Player " + std::to_string(clientId))
+                   : connInfo->username;
+
+  ChatMessage chatMessage(clientId, username, std::string(message));
+  sendToRoom(encodeChatMessage(chatMessage), {username});
+}
+
+void GameRoom::onVote(uint32_t clientId, std::string_view targetName) {
+  if (!server_.getConnectionManager().getConnection(clientId)) {
+    std::cerr << "Warning: CHAT_MESSAGE from unknown client [" << clientId
+              << "]" << std::endl;
+    return;
+  }
+
+  uint32_t targetId = state_.findPlayerByUsername(targetName);
+  if (targetId == 0) {
+    std::cout << "Vote failed: Could not find player with username '"
+              << targetName << "'" << std::endl;
+    std::cout << "Available players: ";
+    for (const auto &p : state_.getAllPlayerStates()) {
+      std::cout << p.username << " ";
+    }
+    std::cout << std::endl;
+    return;
+  }
+
+  VoteStatus status = state_.submitVote(clientId, targetId);
+  if (status == VoteStatus::NO_ROUND) {
+    std::cout << "Vote command received but no round is active" << std::endl;
+    return;
+  }
+  if (status == VoteStatus::REJECTED) {
+    std::cout << "Vote failed: Player [" << clientId
+              << "] may have already voted" << std::endl;
+    return;
+  }
+
+  std::cout << "Player [" << clientId << "] voted for Player [" << targetId
+            << "] (" << targetName << ")" << std::endl;
+  stats().votes.fetch_add(1, std::memory_order_relaxed);
+
+  if (status == VoteStatus::ROUND_COMPLETE) {
+    std::cout << "All players voted! Processing results early..." << std::endl;
+    finishRound();
+  }
+}
+
+void GameRoom::finishRound() {
+  cancelRoundTimer();
+
+  auto tally = state_.getVoteTally();
+  VoteStanding standing = state_.getVoteStanding();
+  uint32_t liarId = state_.getCurrentLiarId();
+  uint32_t winnerId = standing.leaderId;
+
+  bool hasMajority = standing.leaderVotes > standing.playerCount / 2;
+  bool liarCaught = (hasMajority && winnerId == liarId);
+
+  VoteResult result;
+  result.tally = tally;
+  result.winnerId = winnerId;
+  result.liarCaught = liarCaught;
+
+  sendToRoom(encodeVoteResult(result));
+
+  std::cout << "Vote Results:" << std::endl;
+  for (const auto &[targetId, voteCount] : tally) {
+    std::cout << "  Player [" << targetId << "]: " << voteCount << " votes"
+              << std::endl;
+  }
+  if (hasMajority) {
+    std::cout << "Winner: Player [" << winnerId << "]" << std::endl;
+    std::cout << "Liar " << (liarCaught ? "CAUGHT" : "SURVIVED") << std::endl;
+  } else {
+    std::cout << "No majority - no winner" << std::endl;
+  }
+
+  state_.calculateAndApplyScores(liarCaught, winnerId, hasMajority);
+
+  auto scores = state_.getAllScores();
+  std::cout << "Scores:" << std::endl;
+  for (const auto &[playerId, score] : scores) {
+    auto player = state_.getPlayerState(playerId);
+    std::cout << "  " << player.username << " [" << playerId << "]: " << score
+              << " point(s)" << std::endl;
+  }
+
+  state_.clearRound();
+  stats().roundsCompleted.fetch_add(1, std::memory_order_relaxed);
+
+  sendStateUpdate(state_.getAllPlayerIds());
+
+  startNewRoundIfPossible();
+}
+
+void GameRoom::onLeave(uint32_t clientId) {
+  PlayerState leavingPlayer = state_.getPlayerState(clientId);
+  if (!state_.hasPlayer(clientId))
+    return;
+
+  bool roundWasActive = state_.isRoundActive();
+  bool removed = state_.removePlayer(clientId);
+  if (!removed)
+    return;
+
+  logInfo("Player [" + std::to_string(clientId) +
+          "] disconnected from the game");
+
+  if (roundWasActive) {
+    logWarn("Active round interrupted by player disconnect. Resetting round.");
+    cancelRoundTimer();
+    state_.clearRound();
+  }
+
+  sendToRoomExcept(clientId,
+                   encodePlayerState(MessageType::PLAYER_LEAVE, leavingPlayer),
+                   {leavingPlayer.username});
+
+  {
+    std::lock_guard<std::mutex> lock(syncMutex_);
+    clientSync_.erase(clientId);
+  }
+  sendStateUpdate(state_.getAllPlayerIds());
+
+  if (state_.getPlayerCount() < 3) {
+    logWarn("Not enough players to continue. Waiting for additional players.");
+  } else {
+    startNewRoundIfPossible();
+  }
+}
+
+void GameRoom::onAck(uint32_t clientId, uint32_t snapshotId) {
+  if (!state_.hasPlayer(clientId))
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(syncMutex_);
+    ClientSync &sync = clientSync_[clientId];
+    if (snapshotId != 0) {
+      // Acks arrive in order; an older one is a stale duplicate.
+      if (snapshotId > sync.acked)
+        sync.acked = snapshotId;
+      return;
+    }
+    // The client lost its baseline: forget what it has and resend it all.
+    logWarn("Client [" + std::to_string(clientId) +
+            "] requested a full state resync");
+    sync = ClientSync{};
+  }
+  sendStateUpdate({clientId});
+}
+
+} // namespace net
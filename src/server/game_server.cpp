@@ -1,32 +1,32 @@
 #define WIN32_LEAN_AND_MEAN
 #include "common/game_state.h"
 #include "common/packet.h"
-#include "common/serialization.h"
+#include "server/admin_server.h"
+#include "server/game_loop.h"
+#include "server/game_room.h"
+#include "server/matchmaker.h"
+#include "server/room_manager.h"
 #include "server/server.h"
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <csignal>
+#include <pthread.h>
+#endif
 
 using namespace net;
 
 Server *g_server = nullptr;
 
-namespace {
-
-void logInfo(const std::string &msg) {
-  std::cout << "[INFO] " << msg << std::endl;
-}
-void logWarn(const std::string &msg) {
-  std::cout << "[WARN] " << msg << std::endl;
-}
-void logError(const std::string &msg) {
-  std::cerr << "[ERROR] " << msg << std::endl;
-}
-
-} // namespace
-
+#ifdef _WIN32
 BOOL WINAPI ConsoleHandler(DWORD dwType) {
   if (dwType == CTRL_C_EVENT && g_server) {
     std::cout << "Shutting down server..." << std::endl;
@@ -36,293 +36,249 @@ BOOL WINAPI ConsoleHandler(DWORD dwType) {
 
   return FALSE;
 }
-
-int main() {
-  const uint16_t PORT = 8000;
-
-  Server server(PORT);
-  GameState gameState;
-  g_server = &server;
-
-  if (!SetConsoleCtrlHandler(ConsoleHandler, TRUE))
-    std::cerr << "Failed to set console handler" << std::endl;
-
-  server.setPacketCallback([&server, &gameState](const Packet &packet,
-                                                 uint32_t clientId) {
-    uint16_t packetType = packet.getType();
-
-    auto startNewRoundIfPossible = [&server, &gameState]() {
-      if (!gameState.canStartRound()) {
-        logInfo("Cannot start round yet - waiting for enough players");
-        return;
-      }
-      if (gameState.isRoundActive())
-        return;
-
-      logInfo("Starting next round");
-
-      std::string topic;
-      std::string word;
-      uint32_t liarId = 0;
-
-      try {
-        gameState.startNewRound();
-        topic = gameState.getCurrentTopic();
-        word = gameState.getCurrentWord();
-        liarId = gameState.getCurrentLiarId();
-      } catch (const std::exception &e) {
-        logError(std::string("Exception in startNewRound(): ") + e.what());
-        return;
-      } catch (...) {
-        logError("Unknown exception in startNewRound()");
-        return;
-      }
-
-      if (liarId == 0 || topic.empty()) {
-        logError("Round started but topic/liar not set properly");
-        return;
-      }
-
-      logInfo("Round info -> Topic: " + topic + ", Word: " + word +
-              ", Liar: Player [" + std::to_string(liarId) + "]");
-
-      auto allPlayerStates = gameState.getAllPlayerStates();
-      for (const auto &player : allPlayerStates) {
-        if (player.role == PlayerRole::LIAR) {
-          RoleAssignment assignment(player.id, PlayerRole::LIAR, topic, "");
-          Packet rolePacket = createRoleAssignmentPacket(assignment);
-          server.sendPacket(player.id, rolePacket);
-        } else if (player.role == PlayerRole::GUESSER) {
-          RoleAssignment assignment(player.id, PlayerRole::GUESSER, topic,
-                                    word);
-          Packet rolePacket = createRoleAssignmentPacket(assignment);
-          server.sendPacket(player.id, rolePacket);
-        }
-      }
-    };
-
-    switch (packetType) {
-    case MessageType::PLAYER_JOIN: {
-      logInfo("Received PLAYER_JOIN packet from client [" +
-              std::to_string(clientId) + "]");
-      std::string username = "Player " + std::to_string(clientId);
-      if (packet.getData().size() > 0)
-        username =
-            std::string(packet.getData().begin(), packet.getData().end());
-      logInfo("Attempting to add player [" + std::to_string(clientId) +
-              "] with username: " + username);
-      bool added = gameState.addPlayer(clientId, username);
-      if (!added) {
-        logWarn("Failed to add player [" + std::to_string(clientId) +
-                "] - player may already exist");
-        break;
-      }
-
-      logInfo("Player [" + std::to_string(clientId) +
-              "] joined the game. Current count: " +
-              std::to_string(gameState.getPlayerCount()));
-      logInfo(std::string("Can start round: ") +
-              (gameState.canStartRound() ? "yes" : "no") + ", Round active: " +
-              (gameState.isRoundActive() ? "true" : "false"));
-
-      auto allPlayers = gameState.getAllPlayerStates();
-      Packet statePacket = createGameStateUpdatePacket(allPlayers);
-      server.sendPacket(clientId, statePacket);
-
-      PlayerState newPlayer = gameState.getPlayerState(clientId);
-      Packet joinPacket =
-          createPlayerStatePacket(MessageType::PLAYER_JOINED, newPlayer);
-      server.broadcastExcept(clientId, joinPacket);
-
-      startNewRoundIfPossible();
-      break;
+#else
+// Blocks SIGINT/SIGTERM in every thread spawned afterwards and stops the
+// server from a sigwait() thread, where calling stop() is safe.
+bool installShutdownHandler() {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  if (pthread_sigmask(SIG_BLOCK, &signals, nullptr) != 0)
+    return false;
+
+  std::thread([signals]() {
+    int signal = 0;
+    if (sigwait(&signals, &signal) == 0 && g_server) {
+      std::cout << "Shutting down server..." << std::endl;
+      g_server->stop();
     }
+  }).detach();
+  return true;
+}
+#endif
 
-    case MessageType::CHAT_MESSAGE: {
-      auto connInfo = server.getConnectionManager().getConnection(clientId);
-      if (!connInfo) {
-        std::cerr << "Warning: CHAT_MESSAGE from unknown client [" << clientId
-                  << "]" << std::endl;
-        break;
-      }
-
-      std::string message(packet.getData().begin(), packet.getData().end());
-
-      while (!message.empty() &&
-             (message.back() == ' ' || message.back() == '\n' ||
-              message.back() == '\r')) {
-        message.pop_back();
-      }
-
-      if (message.size() > 6 && message.substr(0, 6) == "/vote ") {
-        if (!gameState.isRoundActive()) {
-          std::cout << "Vote command received but no round is active"
-                    << std::endl;
-          break;
-        }
-
-        std::string targetName = message.substr(6);
-        while (!targetName.empty() && (targetName.front() == ' ')) {
-          targetName = targetName.substr(1);
-        }
-        while (!targetName.empty() &&
-               (targetName.back() == ' ' || targetName.back() == '\n' ||
-                targetName.back() == '\r')) {
-          targetName.pop_back();
-        }
-
-        auto allPlayers = gameState.getAllPlayerStates();
-        uint32_t targetId = 0;
-        for (const auto &p : allPlayers) {
-          if (p.username == targetName) {
-            targetId = p.id;
-            break;
-          }
-        }
-
-        if (targetId == 0) {
-          std::cout << "Vote failed: Could not find player with username '"
-                    << targetName << "'" << std::endl;
-          std::cout << "Available players: ";
-          for (const auto &p : allPlayers) {
-            std::cout << p.username << " ";
-          }
-          std::cout << std::endl;
-          break;
-        }
-
-        if (!gameState.submitVote(clientId, targetId)) {
-          std::cout << "Vote failed: Player [" << clientId
-                    << "] may have already voted" << std::endl;
-          break;
-        }
-
-        std::cout << "Player [" << clientId << "] voted for Player ["
-                  << targetId << "] (" << targetName << ")" << std::endl;
-
-        size_t totalPlayers = gameState.getPlayerCount();
-        size_t votesCount = 0;
-        auto allPlayersForVoteCount = gameState.getAllPlayerStates();
-        for (const auto &p : allPlayersForVoteCount) {
-          if (gameState.hasPlayerVoted(p.id)) {
-            votesCount++;
-          }
-        }
-
-        if (votesCount >= totalPlayers) {
-          auto tally = gameState.getVoteTally();
-          uint32_t liarId = gameState.getCurrentLiarId();
-          uint32_t winnerId = 0;
-          uint32_t maxVotes = 0;
-          bool hasMajority = false;
-
-          for (const auto &[targetId, voteCount] : tally) {
-            if (voteCount > maxVotes) {
-              maxVotes = voteCount;
-              winnerId = targetId;
-            }
-          }
-
-          hasMajority = (maxVotes > totalPlayers / 2);
-          bool liarCaught = (hasMajority && winnerId == liarId);
-
-          VoteResult result;
-          result.tally = tally;
-          result.winnerId = winnerId;
-          result.liarCaught = liarCaught;
-
-          Packet resultPacket = createVoteResultPacket(result);
-          server.broadcast(resultPacket);
-
-          std::cout << "All players voted! Processing results early..."
-                    << std::endl;
-          std::cout << "Vote Results:" << std::endl;
-          for (const auto &[targetId, voteCount] : tally) {
-            std::cout << "  Player [" << targetId << "]: " << voteCount
-                      << " votes" << std::endl;
-          }
-          if (hasMajority) {
-            std::cout << "Winner: Player [" << winnerId << "]" << std::endl;
-            std::cout << "Liar " << (liarCaught ? "CAUGHT" : "SURVIVED")
-                      << std::endl;
-          } else {
-            std::cout << "No majority - no winner" << std::endl;
-          }
-
-          gameState.calculateAndApplyScores(liarCaught, winnerId, hasMajority);
-
-          auto scores = gameState.getAllScores();
-          std::cout << "Scores:" << std::endl;
-          for (const auto &[playerId, score] : scores) {
-            auto player = gameState.getPlayerState(playerId);
-            std::cout << "  " << player.username << " [" << playerId
-                      << "]: " << score << " point(s)" << std::endl;
-          }
-
-          gameState.clearRound();
-
-          auto allPlayersUpdate = gameState.getAllPlayerStates();
-          Packet statePacket = createGameStateUpdatePacket(allPlayersUpdate);
-          server.broadcast(statePacket);
-
-          startNewRoundIfPossible();
-        }
-        break;
-      }
+namespace {
 
-      PlayerState player = gameState.getPlayerState(clientId);
-      std::string username = (player.id != 0)
-                                 ? player.username
-                                 : (connInfo->username.empty()
-                                        ? "Player " + std::to_string(clientId)
-                                        : connInfo->username);
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--game-loop] [--rooms] [--workers N] [--room-size N]"
+               " [--tick-ms N] [--matchmaking] [--match-target N]"
+               " [--match-wait-ms N] [--seed N] [--round-timeout-ms N]"
+               " [--idle-timeout-ms N] [--admin-port N]"
+            << std::endl;
+}
 
-      ChatMessage chatMessage(clientId, username, message);
-      Packet chatPacket = createChatMessagePacket(chatMessage);
-      server.broadcast(chatPacket);
-      break;
+// Votes per second, averaged since the previous scrape that came at least
+// a second earlier. Scrapers can also take rate() of the votes counter.
+class VoteRate {
+public:
+  double update(uint64_t votes) {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - since_).count();
+    if (seconds >= 1.0) {
+      rate_ = static_cast<double>(votes - votes_) / seconds;
+      since_ = now;
+      votes_ = votes;
     }
+    return rate_;
+  }
 
-    case MessageType::PLAYER_LEAVE: {
-      PlayerState leavingPlayer = gameState.getPlayerState(clientId);
-      if (!gameState.hasPlayer(clientId))
-        break;
+private:
+  std::chrono::steady_clock::time_point since_ =
+      std::chrono::steady_clock::now();
+  uint64_t votes_ = 0;
+  double rate_ = 0.0;
+};
+
+void collectGameMetrics(MetricsWriter &out, VoteRate &voteRate,
+                        const RoomManager *rooms) {
+  GameRoomStats &stats = GameRoom::stats();
+  uint64_t votes = stats.votes.load(std::memory_order_relaxed);
+
+  out.family("game_rounds_started_total", "counter", "Rounds started.");
+  out.sample("game_rounds_started_total",
+             stats.roundsStarted.load(std::memory_order_relaxed));
+  out.family("game_rounds_completed_total", "counter",
+             "Rounds scored, including timed-out ones.");
+  out.sample("game_rounds_completed_total",
+             stats.roundsCompleted.load(std::memory_order_relaxed));
+  out.family("game_rounds_timed_out_total", "counter",
+             "Rounds ended by --round-timeout-ms.");
+  out.sample("game_rounds_timed_out_total",
+             stats.roundsTimedOut.load(std::memory_order_relaxed));
+  out.family("game_votes_total", "counter", "Votes accepted.");
+  out.sample("game_votes_total", votes);
+  out.family("game_votes_per_second", "gauge",
+             "Votes accepted per second since the previous scrape.");
+  out.sample("game_votes_per_second", voteRate.update(votes));
+
+  if (rooms) {
+    out.family("game_rooms", "gauge", "Rooms created.");
+    out.sample("game_rooms", static_cast<uint64_t>(rooms->getRoomCount()));
+    out.family("game_players_seated", "gauge", "Players seated in a room.");
+    out.sample("game_players_seated",
+               static_cast<uint64_t>(rooms->getSeatedCount()));
+  }
+}
 
-      bool roundWasActive = gameState.isRoundActive();
-      bool removed = gameState.removePlayer(clientId);
-      if (!removed)
-        break;
+} // namespace
 
-      logInfo("Player [" + std::to_string(clientId) +
-              "] disconnected from the game");
+int main(int argc, char *argv[]) {
+  const uint16_t PORT = 8000;
 
-      if (roundWasActive) {
-        logWarn(
-            "Active round interrupted by player disconnect. Resetting round.");
-        gameState.clearRound();
-      }
+  // --game-loop: I/O threads only enqueue commands; one game thread owns the
+  // GameState and applies them in order, ticking every --tick-ms.
+  // --rooms: many tables of up to --room-size players each, spread over
+  // --workers game threads (default one per core).
+  // --matchmaking: joins wait in a queue and start a fresh room together
+  // once --match-target players are queued, or after --match-wait-ms with
+  // at least three. Implies --rooms.
+  // --seed: deal liars, topics and words from a fixed seed (each room its
+  // own stream of it), so a run can be replayed.
+  // --round-timeout-ms: end a round that long after it starts even if not
+  // everyone has voted (game loop or rooms only; default off).
+  // --idle-timeout-ms: drop clients silent that long, pinging them with a
+  // HEARTBEAT after a third of it (0 disables; default 45000).
+  // --admin-port: serve Prometheus metrics on 127.0.0.1:N (default off).
+  bool useGameLoop = false;
+  bool useRooms = false;
+  bool useMatchmaking = false;
+  long tickMs = 50;
+  long workers = 0;
+  long roomSize = static_cast<long>(RoomManager::DEFAULT_ROOM_SIZE);
+  long matchTarget = 0;
+  long matchWaitMs = 2000;
+  bool seeded = false;
+  uint64_t seed = 0;
+  long roundTimeoutMs = 0;
+  ServerConfig serverConfig;
+  long idleTimeoutMs = static_cast<long>(serverConfig.idleTimeout.count());
+  long adminPort = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--game-loop") {
+      useGameLoop = true;
+    } else if (arg == "--rooms") {
+      useRooms = true;
+    } else if (arg == "--matchmaking") {
+      useRooms = true;
+      useMatchmaking = true;
+    } else if (arg == "--match-target" && i + 1 < argc) {
+      matchTarget = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--match-wait-ms" && i + 1 < argc) {
+      matchWaitMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      seeded = true;
+      seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--round-timeout-ms" && i + 1 < argc) {
+      roundTimeoutMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--idle-timeout-ms" && i + 1 < argc) {
+      idleTimeoutMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--admin-port" && i + 1 < argc) {
+      adminPort = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--tick-ms" && i + 1 < argc) {
+      tickMs = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--workers" && i + 1 < argc) {
+      workers = std::strtol(argv[++i], nullptr, 10);
+    } else if (arg == "--room-size" && i + 1 < argc) {
+      roomSize = std::strtol(argv[++i], nullptr, 10);
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (matchTarget == 0)
+    matchTarget = roomSize;
+  if (tickMs <= 0 || workers < 0 || roomSize < 3 || roomSize > 6 ||
+      matchTarget < 3 || matchTarget > roomSize || matchWaitMs < 0 ||
+      roundTimeoutMs < 0 || idleTimeoutMs < 0 || adminPort < 0 ||
+      adminPort > 65535 ||
+      (roundTimeoutMs > 0 && !useGameLoop && !useRooms)) {
+    printUsage(argv[0]);
+    return 1;
+  }
 
-      Packet leavePacket =
-          createPlayerStatePacket(MessageType::PLAYER_LEAVE, leavingPlayer);
-      server.broadcastExcept(clientId, leavePacket);
+  serverConfig.idleTimeout = std::chrono::milliseconds(idleTimeoutMs);
+  serverConfig.heartbeatInterval = serverConfig.idleTimeout / 3;
+
+  Server server(PORT, serverConfig);
+  GameState gameState(!useGameLoop,
+                      seeded ? Random(seed) : Random::fromEntropy());
+  GameRoom room(server, gameState);
+  GameLoop gameLoop([&room](const GameCommand &command) { room.execute(command); },
+                    std::chrono::milliseconds(tickMs));
+  RoomManager rooms(server, useRooms ? static_cast<size_t>(workers) : 1,
+                    std::chrono::milliseconds(tickMs),
+                    static_cast<size_t>(roomSize));
+
+  MatchmakingConfig matchConfig;
+  matchConfig.maxPlayers = static_cast<size_t>(roomSize);
+  matchConfig.targetPlayers = static_cast<size_t>(matchTarget);
+  matchConfig.maxWait = std::chrono::milliseconds(matchWaitMs);
+  Matchmaker matchmaker(matchConfig,
+                        [&rooms](const std::vector<Matchmaker::Ticket> &group) {
+                          return rooms.seatGroup(group);
+                        });
+  if (useMatchmaking)
+    rooms.setMatchmaker(&matchmaker);
+  if (seeded)
+    rooms.setSeed(seed);
+  if (roundTimeoutMs > 0) {
+    room.setRoundTimeout(gameLoop.getTimers(),
+                         std::chrono::milliseconds(roundTimeoutMs));
+    rooms.setRoundTimeout(std::chrono::milliseconds(roundTimeoutMs));
+  }
+  g_server = &server;
 
-      auto allPlayers = gameState.getAllPlayerStates();
-      Packet statePacket = createGameStateUpdatePacket(allPlayers);
-      server.broadcast(statePacket);
+#ifdef _WIN32
+  if (!SetConsoleCtrlHandler(ConsoleHandler, TRUE))
+    std::cerr << "Failed to set console handler" << std::endl;
+#else
+  if (!installShutdownHandler())
+    std::cerr << "Failed to set signal handler" << std::endl;
+#endif
+
+  server.setPacketViewCallback([&](const PacketView &packet,
+                                   uint32_t clientId) {
+    GameCommand command;
+    if (!GameCommand::decode(packet, clientId, command))
+      return;
+
+    if (useRooms)
+      rooms.submit(std::move(command));
+    else if (useGameLoop)
+      gameLoop.submit(std::move(command));
+    else
+      room.execute(command);
+  });
 
-      if (gameState.getPlayerCount() < 3) {
-        logWarn(
-            "Not enough players to continue. Waiting for additional players.");
-      } else {
-        startNewRoundIfPossible();
-      }
-      break;
-    }
+  AdminServer admin(static_cast<uint16_t>(adminPort));
+  VoteRate voteRate;
+  if (adminPort > 0) {
+    admin.addCollector(
+        [&server](MetricsWriter &out) { collectServerMetrics(out, server); });
+    admin.addCollector([&](MetricsWriter &out) {
+      collectGameMetrics(out, voteRate, useRooms ? &rooms : nullptr);
+    });
+    if (!admin.start())
+      return 1;
+  }
 
-    default:
-      break;
+  if (useRooms) {
+    std::cout << "Room mode: " << rooms.getWorkerCount()
+              << " game threads, up to " << roomSize << " players per room"
+              << std::endl;
+    rooms.start();
+    if (useMatchmaking) {
+      std::cout << "Matchmaking: rooms open at " << matchTarget
+                << " players or after " << matchWaitMs << " ms" << std::endl;
+      matchmaker.start();
     }
-  });
+  } else if (useGameLoop) {
+    std::cout << "Game loop mode, tick " << tickMs << " ms" << std::endl;
+    gameLoop.start();
+  }
 
   std::cout << "Press Ctrl+C to shutdown" << std::endl;
 
@@ -334,6 +290,13 @@ int main() {
 
   if (serverThread.joinable())
     serverThread.join();
+  admin.stop();
+  matchmaker.stop();
+  rooms.stop();
+  gameLoop.stop();
   gameState.clearAllPlayers();
+
+  std::cout << "Packet statistics:" << std::endl;
+  writePacketStats(std::cout, PacketMetrics::instance().snapshot());
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,139 @@
+#include "server/matchmaker.h"
+#include <algorithm>
+#include <utility>
+
+namespace net {
+
+Matchmaker::Matchmaker(const MatchmakingConfig &config, MatchCallback callback)
+    : config_(config), callback_(std::move(callback)), roomsFormed_(0),
+      playersMatched_(0), running_(false) {
+  config_.minPlayers = std::max<size_t>(config_.minPlayers, 1);
+  config_.maxPlayers = std::max(config_.maxPlayers, config_.minPlayers);
+  config_.targetPlayers = std::clamp(config_.targetPlayers, config_.minPlayers,
+                                     config_.maxPlayers);
+  group_.reserve(config_.maxPlayers);
+}
+
+Matchmaker::~Matchmaker() { stop(); }
+
+void Matchmaker::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_)
+    return;
+  running_ = true;
+  thread_ = std::thread([this]() { run(); });
+}
+
+void Matchmaker::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_)
+      return;
+    running_ = false;
+  }
+  wakeup_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+bool Matchmaker::enqueue(uint32_t clientId, std::string_view username,
+                         Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.count(clientId) > 0)
+    return false;
+
+  queue_.push_back(Ticket{clientId, std::string(username), now});
+  index_.emplace(clientId, std::prev(queue_.end()));
+
+  // The thread only needs waking for a new deadline, for enough players to
+  // form an overdue group, or for a full group.
+  if (queue_.size() == 1 || queue_.size() == config_.minPlayers ||
+      queue_.size() >= config_.targetPlayers)
+    wakeup_.notify_one();
+  return true;
+}
+
+bool Matchmaker::cancel(uint32_t clientId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(clientId);
+  if (it == index_.end())
+    return false;
+  queue_.erase(it->second);
+  index_.erase(it);
+  return true;
+}
+
+size_t Matchmaker::poll(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return formGroups(now);
+}
+
+bool Matchmaker::groupDue(Clock::time_point now) const {
+  if (queue_.size() >= config_.targetPlayers)
+    return true;
+  return queue_.size() >= config_.minPlayers &&
+         now - queue_.front().enqueued >= config_.maxWait;
+}
+
+size_t Matchmaker::formGroups(Clock::time_point now) {
+  size_t formed = 0;
+  while (!queue_.empty() && groupDue(now)) {
+    size_t size = std::min(queue_.size(), config_.maxPlayers);
+    group_.clear();
+    auto end = queue_.begin();
+    for (size_t i = 0; i < size; ++i, ++end)
+      group_.push_back(*end);
+
+    if (!callback_(group_))
+      break;
+
+    for (const Ticket &ticket : group_)
+      index_.erase(ticket.clientId);
+    queue_.erase(queue_.begin(), end);
+
+    roomsFormed_++;
+    playersMatched_ += size;
+    formed++;
+  }
+  return formed;
+}
+
+void Matchmaker::run() {
+  // Retry interval when the callback had no room to offer.
+  constexpr auto RETRY_INTERVAL = std::chrono::milliseconds(100);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_) {
+    auto now = Clock::now();
+    formGroups(now);
+
+    if (queue_.empty()) {
+      wakeup_.wait(lock);
+    } else if (groupDue(now)) {
+      wakeup_.wait_for(lock, RETRY_INTERVAL);
+    } else if (now - queue_.front().enqueued >= config_.maxWait) {
+      // Overdue but short of minPlayers: nothing changes until the
+      // enqueue that brings the queue to minPlayers.
+      wakeup_.wait(lock);
+    } else {
+      wakeup_.wait_until(lock, queue_.front().enqueued + config_.maxWait);
+    }
+  }
+}
+
+size_t Matchmaker::getQueuedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+uint64_t Matchmaker::getRoomsFormed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return roomsFormed_;
+}
+
+uint64_t Matchmaker::getPlayersMatched() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return playersMatched_;
+}
+
+} // namespace net
@@ -0,0 +1,238 @@
+#include "server/packet_metrics.h"
+#include "common/packet.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace net {
+
+namespace {
+
+// Only the owning thread writes a slot, so a relaxed load and store is an
+// increment without a locked instruction.
+void bump(std::atomic<uint64_t> &counter, uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+uint64_t toNanos(PacketMetrics::Clock::duration duration) {
+  auto nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  return nanos > 0 ? static_cast<uint64_t>(nanos) : 0;
+}
+
+} // namespace
+
+const char *messageTypeName(uint16_t type) {
+  switch (type) {
+  case MessageType::ECHO:
+    return "ECHO";
+  case MessageType::CHAT:
+    return "CHAT";
+  case MessageType::DISCONNECT:
+    return "DISCONNECT";
+  case MessageType::HEARTBEAT:
+    return "HEARTBEAT";
+  case MessageType::PLAYER_JOIN:
+    return "PLAYER_JOIN";
+  case MessageType::PLAYER_LEAVE:
+    return "PLAYER_LEAVE";
+  case MessageType::GAME_STATE_UPDATE:
+    return "GAME_STATE_UPDATE";
+  case MessageType::PLAYER_JOINED:
+    return "PLAYER_JOINED";
+  case MessageType::CHAT_MESSAGE:
+    return "CHAT_MESSAGE";
+  case MessageType::CHAT_BROADCAST:
+    return "CHAT_BROADCAST";
+  case MessageType::ROUND_START:
+    return "ROUND_START";
+  case MessageType::ROLE_ASSIGNMENT:
+    return "ROLE_ASSIGNMENT";
+  case MessageType::VOTE_COMMAND:
+    return "VOTE_COMMAND";
+  case MessageType::VOTE_RESULT:
+    return "VOTE_RESULT";
+  case MessageType::STATE_ACK:
+    return "STATE_ACK";
+  case MessageType::STRING_DEFINE:
+    return "STRING_DEFINE";
+  default:
+    return nullptr;
+  }
+}
+
+// PacketMetrics
+
+struct PacketMetrics::Histogram {
+  std::atomic<uint64_t> counts[LatencyHistogram::BUCKETS] = {};
+  std::atomic<uint64_t> sumNanos{0};
+  std::atomic<uint64_t> maxNanos{0};
+
+  void record(uint64_t nanos) {
+    bump(counts[LatencyHistogram::bucketFor(nanos)], 1);
+    bump(sumNanos, nanos);
+    if (nanos > maxNanos.load(std::memory_order_relaxed))
+      maxNanos.store(nanos, std::memory_order_relaxed);
+  }
+
+  void mergeInto(LatencyHistogram &histogram) const {
+    for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+      uint64_t count = counts[bucket].load(std::memory_order_relaxed);
+      histogram.counts[bucket] += count;
+      histogram.total += count;
+    }
+    histogram.sumNanos += sumNanos.load(std::memory_order_relaxed);
+    histogram.maxNanos = std::max(histogram.maxNanos,
+                                  maxNanos.load(std::memory_order_relaxed));
+  }
+};
+
+struct PacketMetrics::TypeCounters {
+  std::atomic<uint64_t> packetsIn{0};
+  std::atomic<uint64_t> bytesIn{0};
+  std::atomic<uint64_t> packetsOut{0};
+  std::atomic<uint64_t> bytesOut{0};
+  Histogram queued;
+  Histogram handled;
+  Histogram sent;
+};
+
+// Counters for a type are allocated the first time the thread records it,
+// so a slot costs a few kilobytes per type actually seen.
+struct alignas(64) PacketMetrics::Slot {
+  std::atomic<TypeCounters *> types[TYPE_SLOTS] = {};
+  std::atomic<bool> claimed{false};
+  Slot *next = nullptr;
+  // Owned by the claiming thread only.
+  uint32_t sendsUntilSample = 0;
+
+  ~Slot() {
+    for (auto &type : types)
+      delete type.load();
+  }
+
+  // Counts stay for snapshot(); the next thread adds to them.
+  void onRelease() {}
+};
+
+PacketMetrics::PacketMetrics() = default;
+PacketMetrics::~PacketMetrics() = default;
+
+PacketMetrics &PacketMetrics::instance() {
+  // Leaked, like EpochReclaimer: see ThreadSlotList.
+  static PacketMetrics *metrics = new PacketMetrics();
+  return *metrics;
+}
+
+PacketMetrics::TypeCounters &PacketMetrics::countersFor(uint16_t type) {
+  auto &entry = slots_.local().types[type < TYPE_SLOTS ? type : 0];
+  TypeCounters *counters = entry.load(std::memory_order_relaxed);
+  if (!counters) {
+    counters = new TypeCounters();
+    entry.store(counters, std::memory_order_release);
+  }
+  return *counters;
+}
+
+void PacketMetrics::recordReceived(uint16_t type, size_t bytes,
+                                   Clock::duration queued,
+                                   Clock::duration handled) {
+  TypeCounters &counters = countersFor(type);
+  bump(counters.packetsIn, 1);
+  bump(counters.bytesIn, bytes);
+  counters.queued.record(toNanos(queued));
+  counters.handled.record(toNanos(handled));
+}
+
+bool PacketMetrics::sampleSend() {
+  Slot &slot = slots_.local();
+  if (slot.sendsUntilSample > 0) {
+    --slot.sendsUntilSample;
+    return false;
+  }
+  slot.sendsUntilSample = SEND_SAMPLE_PERIOD - 1;
+  return true;
+}
+
+PacketMetrics::TypeCounters &PacketMetrics::countSent(uint16_t type,
+                                                      size_t bytes) {
+  TypeCounters &counters = countersFor(type);
+  bump(counters.packetsOut, 1);
+  bump(counters.bytesOut, bytes);
+  return counters;
+}
+
+void PacketMetrics::recordSent(uint16_t type, size_t bytes) {
+  countSent(type, bytes);
+}
+
+void PacketMetrics::recordSent(uint16_t type, size_t bytes,
+                               Clock::duration sent) {
+  countSent(type, bytes).sent.record(toNanos(sent));
+}
+
+std::vector<PacketTypeStats> PacketMetrics::snapshot() const {
+  std::vector<PacketTypeStats> merged(TYPE_SLOTS);
+  std::vector<bool> seen(TYPE_SLOTS, false);
+
+  for (Slot *slot = slots_.head(); slot; slot = slot->next) {
+    for (size_t type = 0; type < TYPE_SLOTS; ++type) {
+      const TypeCounters *counters =
+          slot->types[type].load(std::memory_order_acquire);
+      if (!counters)
+        continue;
+      PacketTypeStats &stats = merged[type];
+      seen[type] = true;
+      stats.packetsIn += counters->packetsIn.load(std::memory_order_relaxed);
+      stats.bytesIn += counters->bytesIn.load(std::memory_order_relaxed);
+      stats.packetsOut += counters->packetsOut.load(std::memory_order_relaxed);
+      stats.bytesOut += counters->bytesOut.load(std::memory_order_relaxed);
+      counters->queued.mergeInto(stats.queued);
+      counters->handled.mergeInto(stats.handled);
+      counters->sent.mergeInto(stats.sent);
+    }
+  }
+
+  std::vector<PacketTypeStats> result;
+  for (size_t type = 0; type < TYPE_SLOTS; ++type) {
+    if (!seen[type])
+      continue;
+    merged[type].type = static_cast<uint16_t>(type);
+    result.push_back(std::move(merged[type]));
+  }
+  return result;
+}
+
+void writePacketStats(std::ostream &out,
+                      const std::vector<PacketTypeStats> &stats) {
+  auto micros = [](uint64_t nanos) { return static_cast<double>(nanos) / 1e3; };
+  auto stage = [&](const LatencyHistogram &histogram) {
+    out << std::setw(10) << micros(histogram.percentile(0.5)) << std::setw(10)
+        << micros(histogram.percentile(0.99)) << std::setw(10)
+        << micros(histogram.maxNanos);
+  };
+
+  std::ios_base::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision();
+  out << std::left << std::setw(18) << "type" << std::right << std::setw(10)
+      << "in" << std::setw(12) << "in bytes" << std::setw(10) << "out"
+      << std::setw(12) << "out bytes" << std::setw(30)
+      << "handled p50/p99/max us" << std::setw(30) << "sent p50/p99/max us"
+      << '\n';
+  out << std::fixed << std::setprecision(1);
+  for (const auto &row : stats) {
+    const char *name = messageTypeName(row.type);
+    out << std::left << std::setw(18)
+        << (name ? name : row.type ? std::to_string(row.type) : "other")
+        << std::right << std::setw(10) << row.packetsIn << std::setw(12)
+        << row.bytesIn << std::setw(10) << row.packetsOut << std::setw(12)
+        << row.bytesOut;
+    stage(row.handled);
+    stage(row.sent);
+    out << '\n';
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+} // namespace net
@@ -0,0 +1,197 @@
+#include "server/room_manager.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace net {
+
+RoomManager::RoomManager(Server &server, size_t workers,
+                         std::chrono::milliseconds tickInterval,
+                         size_t roomSize, size_t maxRooms)
+    : server_(server), roomSize_(roomSize), maxRooms_(maxRooms),
+      rooms_(new std::unique_ptr<Room>[maxRooms]), roomCount_(0) {
+  if (workers == 0)
+    workers = std::max(1u, std::thread::hardware_concurrency());
+
+  workers_.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.push_back(std::make_unique<GameLoop>(
+        [this](const GameCommand &command) {
+          rooms_[command.roomId]->room.execute(command);
+        },
+        tickInterval));
+  }
+}
+
+RoomManager::~RoomManager() { stop(); }
+
+void RoomManager::start() {
+  for (auto &worker : workers_)
+    worker->start();
+}
+
+void RoomManager::stop() {
+  for (auto &worker : workers_)
+    worker->stop();
+}
+
+// Called with lobbyMutex_ held, before the room's first command is queued.
+void RoomManager::createRoom(size_t roomId) {
+  rooms_[roomId] = std::make_unique<Room>(server_, randomFor(roomId));
+  if (roundTimeout_.count() > 0)
+    rooms_[roomId]->room.setRoundTimeout(workerFor(roomId).getTimers(),
+                                         roundTimeout_);
+}
+
+bool RoomManager::takeSeat(uint32_t &roomId) {
+  std::lock_guard<std::mutex> lock(lobbyMutex_);
+
+  if (openRooms_.empty()) {
+    size_t count = roomCount_.load(std::memory_order_relaxed);
+    if (count == maxRooms_)
+      return false;
+    createRoom(count);
+    roomCount_.store(count + 1, std::memory_order_release);
+    openRooms_.insert(static_cast<uint32_t>(count));
+  }
+
+  roomId = *openRooms_.begin();
+  Room &room = *rooms_[roomId];
+  if (++room.seats == roomSize_)
+    openRooms_.erase(openRooms_.begin());
+  return true;
+}
+
+bool RoomManager::takeEmptyRoom(uint32_t &roomId, size_t seats) {
+  std::lock_guard<std::mutex> lock(lobbyMutex_);
+
+  if (!emptyRooms_.empty()) {
+    roomId = emptyRooms_.back();
+    emptyRooms_.pop_back();
+  } else {
+    size_t count = roomCount_.load(std::memory_order_relaxed);
+    if (count == maxRooms_)
+      return false;
+    createRoom(count);
+    roomCount_.store(count + 1, std::memory_order_release);
+    roomId = static_cast<uint32_t>(count);
+  }
+
+  rooms_[roomId]->seats = seats;
+  return true;
+}
+
+void RoomManager::releaseSeat(uint32_t roomId) {
+  std::lock_guard<std::mutex> lock(lobbyMutex_);
+  Room &room = *rooms_[roomId];
+  room.seats--;
+  if (!matchmaker_)
+    openRooms_.insert(roomId);
+  else if (room.seats == 0)
+    emptyRooms_.push_back(roomId);
+}
+
+bool RoomManager::seatGroup(const std::vector<Matchmaker::Ticket> &group) {
+  uint32_t roomId = 0;
+  if (!takeEmptyRoom(roomId, group.size()))
+    return false;
+
+  // The whole group joins before the round starts, so nobody sits out
+  // the first round.
+  for (size_t i = 0; i < group.size(); ++i) {
+    const Matchmaker::Ticket &ticket = group[i];
+    {
+      ClientShard &shard = shardFor(ticket.clientId);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.rooms.emplace(ticket.clientId, roomId);
+    }
+
+    GameCommand command;
+    command.kind = GameCommand::Kind::JOIN;
+    command.clientId = ticket.clientId;
+    command.roomId = roomId;
+    command.holdRound = i + 1 < group.size();
+    command.text.assign(
+        reinterpret_cast<const uint8_t *>(ticket.username.data()),
+        ticket.username.size());
+    workerFor(roomId).submit(std::move(command));
+  }
+  return true;
+}
+
+size_t RoomManager::getSeatedCount() const {
+  size_t seated = 0;
+  for (auto &shard : clients_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    seated += shard.rooms.size();
+  }
+  return seated;
+}
+
+bool RoomManager::submit(GameCommand &&command) {
+  ClientShard &shard = shardFor(command.clientId);
+
+  switch (command.kind) {
+  case GameCommand::Kind::JOIN: {
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    auto it = shard.rooms.find(command.clientId);
+    if (it != shard.rooms.end()) {
+      // Repeated join: let the room report it.
+      command.roomId = it->second;
+      break;
+    }
+    lock.unlock();
+
+    if (matchmaker_) {
+      matchmaker_->enqueue(command.clientId, command.textView());
+      return true;
+    }
+
+    uint32_t roomId = 0;
+    if (!takeSeat(roomId))
+      return false;
+
+    lock.lock();
+    shard.rooms.emplace(command.clientId, roomId);
+    command.roomId = roomId;
+    break;
+  }
+
+  case GameCommand::Kind::LEAVE: {
+    // cancel() waits out a group being seated, so a client it no longer
+    // finds queued is already in the shard map.
+    if (matchmaker_ && matchmaker_->cancel(command.clientId))
+      return true;
+
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    auto it = shard.rooms.find(command.clientId);
+    if (it == shard.rooms.end())
+      return false;
+    uint32_t roomId = it->second;
+    shard.rooms.erase(it);
+    lock.unlock();
+
+    // Queue the LEAVE before the seat can be handed to a new group, so a
+    // reused room sees its old player go before the new ones arrive.
+    command.roomId = roomId;
+    workerFor(roomId).submit(std::move(command));
+    releaseSeat(roomId);
+    return true;
+  }
+
+  default: {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.rooms.find(command.clientId);
+    if (it == shard.rooms.end())
+      return false;
+    command.roomId = it->second;
+    break;
+  }
+  }
+
+  uint32_t roomId = command.roomId;
+  workerFor(roomId).submit(std::move(command));
+  return true;
+}
+
+} // namespace net
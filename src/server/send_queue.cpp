@@ -0,0 +1,131 @@
+#include "server/send_queue.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+namespace net {
+
+namespace {
+
+constexpr size_t MAX_BATCH = 64;
+
+// Drops queued packets of `type` that have not started going out.
+void coalesce(ConnectionInfo &connection, uint16_t type) {
+  auto &queue = connection.sendQueue;
+  auto first = queue.begin();
+  if (first != queue.end() && connection.sendOffset > 0)
+    ++first;
+
+  auto kept = std::remove_if(first, queue.end(), [&](const WireBuffer &queued) {
+    if (packetType(queued) != type)
+      return false;
+    connection.queuedBytes -= queued->size();
+    return true;
+  });
+  queue.erase(kept, queue.end());
+}
+
+// Marks `sent` bytes of the queue as written.
+void consume(ConnectionInfo &connection, size_t sent) {
+  auto &queue = connection.sendQueue;
+  while (sent > 0) {
+    size_t remaining = queue.front()->size() - connection.sendOffset;
+    if (sent < remaining) {
+      connection.sendOffset += sent;
+      return;
+    }
+    sent -= remaining;
+    connection.queuedBytes -= queue.front()->size();
+    queue.pop_front();
+    connection.sendOffset = 0;
+  }
+}
+
+} // namespace
+
+uint16_t packetType(const WireBuffer &buffer) {
+  if (buffer->size() < PacketHeader::SIZE)
+    return 0;
+  return static_cast<uint16_t>(((*buffer)[4] << 8) | (*buffer)[5]);
+}
+
+EnqueueResult enqueueSend(ConnectionInfo &connection, const WireBuffer &buffer,
+                          size_t highWater, SlowConsumerPolicy policy) {
+  // An idle connection always accepts one packet, however large.
+  if (!connection.sendQueue.empty() &&
+      connection.queuedBytes + buffer->size() > highWater &&
+      packetType(buffer) != MessageType::STRING_DEFINE) {
+    switch (policy) {
+    case SlowConsumerPolicy::DROP:
+      return EnqueueResult::DROPPED;
+    case SlowConsumerPolicy::DISCONNECT:
+      return EnqueueResult::OVER_LIMIT;
+    case SlowConsumerPolicy::COALESCE:
+      coalesce(connection, packetType(buffer));
+      if (!connection.sendQueue.empty() &&
+          connection.queuedBytes + buffer->size() > highWater)
+        return EnqueueResult::DROPPED;
+      break;
+    }
+  }
+
+  connection.sendQueue.push_back(buffer);
+  connection.queuedBytes += buffer->size();
+  return EnqueueResult::QUEUED;
+}
+
+bool flushSendQueue(ConnectionInfo &connection) {
+  if (connection.socket == INVALID_SOCKET)
+    return false;
+
+  auto &queue = connection.sendQueue;
+  while (!queue.empty()) {
+    size_t count = std::min(queue.size(), MAX_BATCH);
+
+#ifdef _WIN32
+    WSABUF buffers[MAX_BATCH];
+    for (size_t i = 0; i < count; ++i) {
+      size_t offset = i == 0 ? connection.sendOffset : 0;
+      buffers[i].buf = reinterpret_cast<char *>(
+          const_cast<uint8_t *>(queue[i]->data()) + offset);
+      buffers[i].len = static_cast<ULONG>(queue[i]->size() - offset);
+    }
+
+    DWORD sent = 0;
+    if (WSASend(connection.socket, buffers, static_cast<DWORD>(count), &sent,
+                0, nullptr, nullptr) == SOCKET_ERROR) {
+      if (WSAGetLastError() == WSAEWOULDBLOCK)
+        return true;
+      return false;
+    }
+#else
+    iovec buffers[MAX_BATCH];
+    for (size_t i = 0; i < count; ++i) {
+      size_t offset = i == 0 ? connection.sendOffset : 0;
+      buffers[i].iov_base = const_cast<uint8_t *>(queue[i]->data()) + offset;
+      buffers[i].iov_len = queue[i]->size() - offset;
+    }
+
+    // sendmsg rather than writev: writev cannot pass MSG_NOSIGNAL.
+    msghdr message{};
+    message.msg_iov = buffers;
+    message.msg_iovlen = count;
+    ssize_t sent = sendmsg(connection.socket, &message, SEND_FLAGS);
+    if (sent == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return true;
+      return false;
+    }
+#endif
+
+    consume(connection, static_cast<size_t>(sent));
+  }
+
+  return true;
+}
+
+} // namespace net
@@ -1,26 +1,58 @@
 #include "server/server.h"
+#include "server/event_loop.h"
+#include "server/uring_loop.h"
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 namespace net {
 
-Server::Server(uint16_t port)
-    : port_(port), serverSocket_(INVALID_SOCKET), running_(false),
-      nextClientId_(1) {}
+Server::Server(uint16_t port) : Server(port, ServerConfig()) {}
+
+namespace {
+
+size_t resolveLoopCount(const ServerConfig &config) {
+  if (config.backend == ServerBackend::THREAD_PER_CLIENT)
+    return 1;
+  if (config.ioThreads > 0)
+    return config.ioThreads;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+Server::Server(uint16_t port, const ServerConfig &config)
+    : port_(port), config_(config), loopCount_(resolveLoopCount(config)),
+      serverSocket_(INVALID_SOCKET), running_(false), nextClientId_(1),
+      connectionManager_(loopCount_),
+      messageQueue_(config.messageQueueCapacity, config.messageQueuePolicy),
+      heartbeat_(
+          Packet(MessageType::HEARTBEAT, std::vector<uint8_t>()).toWire()),
+      metrics_(config.packetMetrics ? &PacketMetrics::instance() : nullptr) {}
 
 Server::~Server() { stop(); }
 
 bool Server::initializeWinsock() {
+#ifdef _WIN32
   WSADATA wsaData;
   int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
   if (result != 0) {
     std::cerr << "WSAStartup failed: " << result << std::endl;
     return false;
   }
+#endif
   return true;
 }
 
-void Server::cleanupWinsock() { WSACleanup(); }
+void Server::cleanupWinsock() {
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
 
 bool Server::start() {
   if (running_)
@@ -28,39 +60,99 @@ bool Server::start() {
   if (!initializeWinsock())
     return false;
 
-  serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (!openListener())
+    return false;
+
+  if (usesEventLoops() && !createEventLoops())
+    return false;
+
+  running_ = true;
+  std::cout << "Server is listening on port " << port_ << std::endl;
+
+  if (usesEventLoops())
+    return runEventLoops();
+
+  return runThreadPerClient();
+}
+
+bool Server::openListener() {
+  serverSocket_ = createListenSocket();
   if (serverSocket_ == INVALID_SOCKET) {
-    std::cerr << "Socket creation failed: " << WSAGetLastError() << std::endl;
     cleanupWinsock();
     return false;
   }
+  return true;
+}
+
+SOCKET Server::createListenSocket() {
+  SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenSocket == INVALID_SOCKET) {
+    std::cerr << "Socket creation failed: " << WSAGetLastError() << std::endl;
+    return INVALID_SOCKET;
+  }
+
+#ifndef _WIN32
+  int reuse = 1;
+  setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+#ifdef __linux__
+  if (config_.reusePortShards &&
+      setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, &reuse,
+                 sizeof(reuse)) == SOCKET_ERROR) {
+    std::cerr << "SO_REUSEPORT failed: " << WSAGetLastError() << std::endl;
+    closesocket(listenSocket);
+    return INVALID_SOCKET;
+  }
+#endif
 
   sockaddr_in serverAddr{};
   serverAddr.sin_family = AF_INET;
   serverAddr.sin_addr.s_addr = INADDR_ANY;
   serverAddr.sin_port = htons(port_);
 
-  if (bind(serverSocket_, (sockaddr *)&serverAddr, sizeof(serverAddr)) ==
+  if (bind(listenSocket, (sockaddr *)&serverAddr, sizeof(serverAddr)) ==
       SOCKET_ERROR) {
     std::cerr << "Bind failed: " << WSAGetLastError() << std::endl;
-    closesocket(serverSocket_);
-    cleanupWinsock();
-    return false;
+    closesocket(listenSocket);
+    return INVALID_SOCKET;
   }
 
-  if (listen(serverSocket_, SOMAXCONN) == SOCKET_ERROR) {
+  if (listen(listenSocket, SOMAXCONN) == SOCKET_ERROR) {
     std::cerr << "Listen failed: " << WSAGetLastError() << std::endl;
-    closesocket(serverSocket_);
-    cleanupWinsock();
-    return false;
+    closesocket(listenSocket);
+    return INVALID_SOCKET;
   }
 
-  running_ = true;
-  std::cout << "Server is listening on port " << port_ << std::endl;
+  return listenSocket;
+}
+
+bool Server::runThreadPerClient() {
+  // Client threads block in their own poll(); this loop owns the timers,
+  // waking for them between accepts.
+  TimerWheel timers(TIMER_TICK);
+  armReaper(timers);
 
   while (running_) {
+    pollfd listener{};
+    listener.fd = serverSocket_;
+    listener.events = POLLIN;
+    int ready = pollSockets(&listener, 1,
+                            timers.msUntilNext(TimerWheel::Clock::now()));
+    timers.advance(TimerWheel::Clock::now());
+    if (ready == SOCKET_ERROR) {
+#ifndef _WIN32
+      if (errno == EINTR)
+        continue;
+#endif
+      if (running_)
+        std::cerr << "Poll failed: " << WSAGetLastError() << std::endl;
+      continue;
+    }
+    if (ready == 0)
+      continue;
+
     sockaddr_in clientAddr{};
-    int clientAddrSize = sizeof(clientAddr);
+    socklen_t clientAddrSize = sizeof(clientAddr);
     SOCKET clientSocket =
         accept(serverSocket_, (sockaddr *)&clientAddr, &clientAddrSize);
 
@@ -70,15 +162,18 @@ bool Server::start() {
       continue;
     }
 
-    uint32_t clientId = nextClientId_++;
-
-    if (!connectionManager_.addConnection(clientId, clientSocket, clientAddr)) {
-      std::cerr << "Failed to add client to connection manager" << std::endl;
+    // Sends must never block the thread that triggered them; client
+    // threads wait in poll() instead of a blocking recv().
+    if (!setNonBlocking(clientSocket)) {
+      std::cerr << "Failed to make socket non-blocking: " << WSAGetLastError()
+                << std::endl;
       closesocket(clientSocket);
       continue;
     }
 
-    connectionManager_.setStatus(clientId, ConnectionStatus::ACTIVE);
+    uint32_t clientId = registerClient(clientSocket, clientAddr, 0);
+    if (clientId == 0)
+      continue;
 
     auto client =
         std::make_shared<ClientConnection>(clientId, clientSocket, clientAddr);
@@ -89,6 +184,8 @@ bool Server::start() {
     }
 
     client->thread = std::thread(&Server::handleClient, this, client);
+    if (idleTimersEnabled())
+      armIdleCheck(timers, clientId, firstIdleCheck());
 
     std::cout << "Client connected from " << inet_ntoa(clientAddr.sin_addr)
               << ":" << ntohs(clientAddr.sin_port)
@@ -99,12 +196,197 @@ bool Server::start() {
   return true;
 }
 
+std::chrono::milliseconds Server::firstIdleCheck() const {
+  auto ping = config_.heartbeatInterval;
+  if (ping > std::chrono::milliseconds::zero() && ping < config_.idleTimeout)
+    return ping;
+  return config_.idleTimeout;
+}
+
+bool Server::checkIdle(ConnectionInfo &connInfo,
+                       std::chrono::steady_clock::time_point now,
+                       std::chrono::steady_clock::duration &next) {
+  auto silent = now - connInfo.lastHeartbeat.load(std::memory_order_relaxed);
+  if (silent >= config_.idleTimeout) {
+    std::cout << "Idle timeout, disconnecting [ID: " << connInfo.id << "]"
+              << std::endl;
+    return false;
+  }
+
+  auto ping = firstIdleCheck();
+  if (silent < ping) {
+    next = ping - silent;
+    return true;
+  }
+  // Quiet since the last check: ask for a sign of life before the
+  // deadline. Any packet back, HEARTBEAT or not, resets the clock.
+  if (ping < config_.idleTimeout)
+    sendWire(connInfo, heartbeat_);
+  next = config_.idleTimeout - silent;
+  return true;
+}
+
+void Server::armIdleCheck(TimerWheel &timers, uint32_t clientId,
+                          std::chrono::steady_clock::duration delay) {
+  timers.schedule(delay, [this, &timers, clientId]() {
+    auto connInfo = connectionManager_.getConnection(clientId);
+    if (!connInfo || connInfo->status != ConnectionStatus::ACTIVE)
+      return;
+    std::chrono::steady_clock::duration next;
+    if (checkIdle(*connInfo, TimerWheel::Clock::now(), next))
+      armIdleCheck(timers, clientId, next);
+    else
+      disconnectClient(clientId);
+  });
+}
+
+void Server::armReaper(TimerWheel &timers) {
+  timers.schedule(REAP_INTERVAL, [this, &timers]() {
+    cleanupConnections();
+    armReaper(timers);
+  });
+}
+
+bool Server::createEventLoops() {
+#ifdef __linux__
+  size_t loopCount = loopCount_;
+
+  // Idle players each hold a descriptor; lift the soft limit to the hard one.
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  eventLoops_.clear();
+  for (size_t i = 0; i < loopCount; ++i) {
+    std::unique_ptr<IoLoop> loop;
+    if (config_.backend == ServerBackend::IO_URING)
+      loop = std::make_unique<UringLoop>(*this, i);
+    else
+      loop = std::make_unique<EventLoop>(*this, i);
+    if (!loop->init())
+      break;
+    eventLoops_.push_back(std::move(loop));
+  }
+
+  shardSequences_.assign(loopCount, 1);
+
+  bool listening = eventLoops_.size() == loopCount &&
+                   eventLoops_[0]->watchListener(serverSocket_);
+
+  // Sharded mode: every loop binds its own SO_REUSEPORT listener and the
+  // kernel spreads incoming connections across them.
+  for (size_t i = 1; listening && config_.reusePortShards && i < loopCount;
+       ++i) {
+    SOCKET listenSocket = createListenSocket();
+    if (listenSocket == INVALID_SOCKET) {
+      listening = false;
+      break;
+    }
+    shardListeners_.push_back(listenSocket);
+    listening = eventLoops_[i]->watchListener(listenSocket);
+  }
+
+  if (listening)
+    return true;
+
+  eventLoops_.clear();
+  closeShardListeners();
+#else
+  std::cerr << "Event loop backends are only available on Linux" << std::endl;
+#endif
+  closesocket(serverSocket_);
+  serverSocket_ = INVALID_SOCKET;
+  cleanupWinsock();
+  return false;
+}
+
+bool Server::runEventLoops() {
+#ifdef __linux__
+  std::cout << "Running " << eventLoops_.size()
+            << (config_.backend == ServerBackend::IO_URING ? " io_uring"
+                                                            : " epoll")
+            << " event loop(s)" << std::endl;
+
+  // Loop 0 (the acceptor) runs on the calling thread, like the blocking
+  // accept loop does; stop() only signals the loops and start() tears down.
+  for (size_t i = 1; i < eventLoops_.size(); ++i)
+    eventLoopThreads_.emplace_back(&IoLoop::run, eventLoops_[i].get());
+
+  eventLoops_[0]->run();
+
+  for (auto &thread : eventLoopThreads_) {
+    if (thread.joinable())
+      thread.join();
+  }
+  eventLoopThreads_.clear();
+
+  if (serverSocket_ != INVALID_SOCKET) {
+    closesocket(serverSocket_);
+    serverSocket_ = INVALID_SOCKET;
+  }
+  closeShardListeners();
+
+  // The loops stay allocated until the next start() so a concurrent stop()
+  // can still wake them safely.
+  connectionManager_.clearAllConnections();
+  cleanupWinsock();
+  std::cout << "Server shutdown complete" << std::endl;
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef __linux__
+void Server::closeShardListeners() {
+  for (SOCKET listenSocket : shardListeners_)
+    closesocket(listenSocket);
+  shardListeners_.clear();
+}
+#endif
+
+uint32_t Server::registerClient(SOCKET clientSocket,
+                                const sockaddr_in &clientAddr, size_t shard) {
+  uint32_t clientId;
+#ifdef __linux__
+  // Sharded ids satisfy id % loopCount_ == shard, so sends and table
+  // lookups route to the accepting loop without any shared counter.
+  if (config_.reusePortShards && usesEventLoops())
+    clientId = static_cast<uint32_t>(shardSequences_[shard]++ * loopCount_ +
+                                     shard);
+  else
+#endif
+    clientId = nextClientId_++;
+
+  if (!connectionManager_.addConnection(clientId, clientSocket, clientAddr)) {
+    std::cerr << "Failed to add client to connection manager" << std::endl;
+    closesocket(clientSocket);
+    return 0;
+  }
+
+  connectionManager_.setStatus(clientId, ConnectionStatus::ACTIVE);
+  return clientId;
+}
+
 void Server::stop() {
   if (!running_)
     return;
   running_ = false;
+  messageQueue_.notifyAll();
+
+  if (usesEventLoops()) {
+#ifdef __linux__
+    for (auto &loop : eventLoops_)
+      loop->wakeup();
+#endif
+    return;
+  }
 
   if (serverSocket_ != INVALID_SOCKET) {
+    shutdown(serverSocket_, SHUT_RDWR);
     closesocket(serverSocket_);
     serverSocket_ = INVALID_SOCKET;
   }
@@ -112,7 +394,9 @@ void Server::stop() {
   auto allConnections = connectionManager_.getAllConnections();
   for (const auto &conn : allConnections) {
     connectionManager_.setStatus(conn->id, ConnectionStatus::DISCONNECTING);
-    closesocket(conn->socket);
+    std::lock_guard<std::mutex> lock(conn->sendMutex);
+    if (conn->socket != INVALID_SOCKET)
+      shutdown(conn->socket, SHUT_RDWR);
   }
 
   {
@@ -130,37 +414,116 @@ void Server::stop() {
 }
 
 bool Server::sendPacket(uint32_t clientId, const Packet &packet) {
-  auto connInfo = connectionManager_.getConnection(clientId);
+  return sendPacket(clientId, packet.toWire());
+}
+
+bool Server::sendPacket(uint32_t clientId, const WireBuffer &wire) {
+  bool sent = false;
+  connectionManager_.withConnection(clientId, [&](ConnectionInfo &connInfo) {
+    if (connInfo.status == ConnectionStatus::ACTIVE)
+      sent = sendWire(connInfo, wire);
+  });
+  return sent;
+}
+
+bool Server::sendWire(ConnectionInfo &connInfo, const WireBuffer &wire) {
+  if (!metrics_)
+    return queueWire(connInfo, wire);
 
-  if (!connInfo || connInfo->status != ConnectionStatus::ACTIVE)
+  if (!metrics_->sampleSend()) {
+    bool sent = queueWire(connInfo, wire);
+    if (sent)
+      metrics_->recordSent(packetType(wire), wire->size());
+    return sent;
+  }
+
+  auto start = PacketMetrics::Clock::now();
+  bool sent = queueWire(connInfo, wire);
+  if (sent)
+    metrics_->recordSent(packetType(wire), wire->size(),
+                         PacketMetrics::Clock::now() - start);
+  return sent;
+}
+
+bool Server::queueWire(ConnectionInfo &connInfo, const WireBuffer &wire) {
+  if (connInfo.status != ConnectionStatus::ACTIVE)
     return false;
 
-  std::vector<uint8_t> data = packet.serialize();
-  int result =
-      send(connInfo->socket, reinterpret_cast<const char *>(data.data()),
-           static_cast<int>(data.size()), 0);
+  bool wasEmpty;
+  EnqueueResult result;
+  {
+    std::lock_guard<std::mutex> lock(connInfo.sendMutex);
+    if (connInfo.socket == INVALID_SOCKET)
+      return false;
+    wasEmpty = connInfo.sendQueue.empty();
+    result = enqueueSend(connInfo, wire, config_.sendQueueHighWater,
+                         config_.slowConsumerPolicy);
+  }
 
-  if (result == SOCKET_ERROR) {
-    int error = WSAGetLastError();
-    if (error == WSAECONNRESET || error == WSAENOTCONN)
-      disconnectClient(clientId);
+  if (result == EnqueueResult::OVER_LIMIT) {
+    std::cerr << "Send queue over high-water mark, disconnecting [ID: "
+              << connInfo.id << "]" << std::endl;
+    disconnectClient(connInfo.id);
+    return false;
+  }
+  if (result == EnqueueResult::DROPPED)
     return false;
+
+  // Whoever queued into an empty queue starts the drain; later packets are
+  // picked up by the same drain and coalesced into its sends.
+  if (!wasEmpty)
+    return true;
+
+#ifdef __linux__
+  if (usesEventLoops()) {
+    eventLoops_[connInfo.id % eventLoops_.size()]->scheduleFlush(connInfo);
+    return true;
   }
+#endif
 
-  return result == static_cast<int>(data.size());
+  // Thread-per-client: write what the socket takes now; the client's own
+  // thread drains the rest once poll() reports it writable.
+  bool flushed;
+  {
+    std::lock_guard<std::mutex> lock(connInfo.sendMutex);
+    flushed = flushSendQueue(connInfo);
+  }
+  if (!flushed) {
+    disconnectClient(connInfo.id);
+    return false;
+  }
+  return true;
 }
 
-void Server::broadcast(const Packet &packet) {
-  auto activeConnections = connectionManager_.getActiveConnections();
-  for (uint32_t connId : activeConnections)
-    sendPacket(connId, packet);
+void Server::broadcast(const Packet &packet) { broadcast(packet.toWire()); }
+
+void Server::broadcast(const WireBuffer &wire) {
+  connectionManager_.forEachActive(
+      [&](ConnectionInfo &connInfo) { sendWire(connInfo, wire); });
 }
 
 void Server::broadcastExcept(uint32_t excludeClientId, const Packet &packet) {
-  auto activeConnections = connectionManager_.getActiveConnections();
-  for (uint32_t connId : activeConnections) {
-    if (connId != excludeClientId)
-      sendPacket(connId, packet);
+  broadcastExcept(excludeClientId, packet.toWire());
+}
+
+void Server::broadcastExcept(uint32_t excludeClientId,
+                             const WireBuffer &wire) {
+  connectionManager_.forEachActive([&](ConnectionInfo &connInfo) {
+    if (connInfo.id != excludeClientId)
+      sendWire(connInfo, wire);
+  });
+}
+
+void Server::multicast(const std::vector<uint32_t> &clientIds,
+                       const Packet &packet) {
+  multicast(clientIds, packet.toWire());
+}
+
+void Server::multicast(const std::vector<uint32_t> &clientIds,
+                       const WireBuffer &wire) {
+  for (uint32_t clientId : clientIds) {
+    connectionManager_.withConnection(
+        clientId, [&](ConnectionInfo &connInfo) { sendWire(connInfo, wire); });
   }
 }
 
@@ -172,13 +535,23 @@ void Server::setPacketCallback(PacketCallback callback) {
   packetCallback_ = callback;
 }
 
+void Server::setPacketViewCallback(PacketViewCallback callback) {
+  packetViewCallback_ = callback;
+}
+
 bool Server::disconnectClient(uint32_t clientId) {
   auto connInfo = connectionManager_.getConnection(clientId);
   if (!connInfo)
     return false;
 
   connectionManager_.setStatus(clientId, ConnectionStatus::DISCONNECTING);
-  closesocket(connInfo->socket);
+
+  // The owning thread or loop notices the shutdown and closes the socket.
+  {
+    std::lock_guard<std::mutex> lock(connInfo->sendMutex);
+    if (connInfo->socket != INVALID_SOCKET)
+      shutdown(connInfo->socket, SHUT_RDWR);
+  }
 
   {
     std::lock_guard<std::mutex> lock(clientThreadsMutex_);
@@ -196,87 +569,189 @@ bool Server::disconnectClient(uint32_t clientId) {
 void Server::cleanupConnections() {
   connectionManager_.cleanupInactiveConnections();
 
-  std::lock_guard<std::mutex> lock(clientThreadsMutex_);
-  clientThreads_.erase(
-      std::remove_if(clientThreads_.begin(), clientThreads_.end(),
-                     [](const std::shared_ptr<ClientConnection> &c) {
-                       return !c->active;
-                     }),
-      clientThreads_.end());
+  std::vector<std::shared_ptr<ClientConnection>> finished;
+  {
+    std::lock_guard<std::mutex> lock(clientThreadsMutex_);
+    auto done = std::stable_partition(
+        clientThreads_.begin(), clientThreads_.end(),
+        [](const std::shared_ptr<ClientConnection> &c) {
+          return !c->finished;
+        });
+    finished.assign(std::make_move_iterator(done),
+                    std::make_move_iterator(clientThreads_.end()));
+    clientThreads_.erase(done, clientThreads_.end());
+  }
+
+  // Each has returned from handleClient(), so these joins do not block.
+  for (auto &client : finished) {
+    if (client->thread.joinable())
+      client->thread.join();
+  }
+}
+
+bool Server::receive(const std::shared_ptr<ClientConnection> &client,
+                     ReceiveBuffer &receiveBuffer) {
+  uint8_t *tail = receiveBuffer.prepare(BUFFER_SIZE);
+  int bytesReceived =
+      recv(client->socket, reinterpret_cast<char *>(tail),
+           static_cast<int>(receiveBuffer.writable()), 0);
+
+  if (bytesReceived > 0) {
+    receiveBuffer.commit(static_cast<size_t>(bytesReceived));
+    connectionManager_.updateHeartbeat(client->id);
+    processReceivedData(client->id, receiveBuffer);
+    return false;
+  }
+
+  if (bytesReceived == 0) {
+    std::cout << "Client disconnected [ID: " << client->id << "]" << std::endl;
+    client->active = false;
+    return true;
+  }
+
+  int error = WSAGetLastError();
+  if (error == WSAEWOULDBLOCK)
+    return true;
+  if (error == WSAECONNRESET) {
+    std::cout << "Connection reset by client [ID: " << client->id << "]"
+              << std::endl;
+  } else {
+    std::cerr << "Receive failed [ID: " << client->id << "]: " << error
+              << std::endl;
+  }
+  client->active = false;
+  return true;
 }
 
 void Server::handleClient(std::shared_ptr<ClientConnection> client) {
-  std::vector<uint8_t> receiveBuffer;
-  receiveBuffer.resize(BUFFER_SIZE);
+  // Holds partial packets between reads.
+  ReceiveBuffer receiveBuffer;
 
-  // Buffer for incomplete packets
-  std::vector<uint8_t> packetBuffer;
+  auto connInfo = connectionManager_.getConnection(client->id);
+  bool drained = true;
 
   while (running_ && client->active) {
-    int bytesReceived =
-        recv(client->socket, reinterpret_cast<char *>(receiveBuffer.data()),
-             BUFFER_SIZE, 0);
-
-    if (bytesReceived > 0) {
-      connectionManager_.updateHeartbeat(client->id);
-      packetBuffer.insert(packetBuffer.end(), receiveBuffer.data(),
-                          receiveBuffer.data() + bytesReceived);
-      // Process received data - handle partial packets
-      size_t offset = 0;
-      while (offset < packetBuffer.size()) {
-        if (!Packet::isCompletePacket(packetBuffer.data() + offset,
-                                      packetBuffer.size() - offset))
-          break;
-
-        Packet packet = Packet::deserialize(packetBuffer.data() + offset,
-                                            packetBuffer.size() - offset);
-
-        if (packet.getType() != 0) {
-          messageQueue_.push(packet);
-
-          if (packetCallback_) {
-            packetCallback_(packet, client->id);
-          } else {
-            std::cerr
-                << "Warning: Packet received but no callback set [Client: "
-                << client->id << ", Type: " << packet.getType() << "]"
-                << std::endl;
-          }
-        }
-
-        offset += packet.getTotalSize();
-      }
+    // Only sleep in poll() once recv() has emptied the socket.
+    if (!drained) {
+      drained = receive(client, receiveBuffer);
+      if (!client->active)
+        break;
+      continue;
+    }
 
-      if (offset > 0)
-        packetBuffer.erase(packetBuffer.begin(), packetBuffer.begin() + offset);
+    pollfd descriptor{};
+    descriptor.fd = client->socket;
+    descriptor.events = POLLIN;
+    if (connInfo) {
+      std::lock_guard<std::mutex> lock(connInfo->sendMutex);
+      if (!connInfo->sendQueue.empty())
+        descriptor.events |= POLLOUT;
+    }
 
-    } else if (bytesReceived == 0) {
-      std::cout << "Client disconnected [ID: " << client->id << "]"
-                << std::endl;
-      break;
-    } else {
-      int error = WSAGetLastError();
-      if (error != WSAECONNRESET && error != WSAEWOULDBLOCK) {
-        std::cerr << "Receive failed [ID: " << client->id << "]: " << error
-                  << std::endl;
-      }
-      if (error == WSAECONNRESET) {
-        std::cout << "Connection reset by client [ID: " << client->id << "]"
-                  << std::endl;
-      }
+    int ready = pollSockets(&descriptor, 1, POLL_INTERVAL_MS);
+    if (ready == SOCKET_ERROR) {
+#ifndef _WIN32
+      if (errno == EINTR)
+        continue;
+#endif
+      std::cerr << "Poll failed [ID: " << client->id
+                << "]: " << WSAGetLastError() << std::endl;
       break;
     }
+    if (ready == 0)
+      continue;
+
+    if ((descriptor.revents & POLLOUT) && connInfo) {
+      std::lock_guard<std::mutex> lock(connInfo->sendMutex);
+      if (!flushSendQueue(*connInfo))
+        shutdown(client->socket, SHUT_RDWR);
+    }
+    if (descriptor.revents & (POLLIN | POLLHUP | POLLERR))
+      drained = false;
   }
 
+  if (connInfo) {
+    std::lock_guard<std::mutex> lock(connInfo->sendMutex);
+    connInfo->socket = INVALID_SOCKET;
+    connInfo->sendQueue.clear();
+    connInfo->sendOffset = 0;
+    connInfo->queuedBytes = 0;
+  }
   closesocket(client->socket);
   client->active = false;
 
-  connectionManager_.setStatus(client->id, ConnectionStatus::DISCONNECTING);
-  connectionManager_.removeConnection(client->id);
+  onClientDisconnected(client->id);
+  client->finished = true;
+}
+
+size_t Server::dispatchPackets(uint32_t clientId, const uint8_t *data,
+                               size_t size) {
+  // Every caller has just read data, so this stands in for the recv time.
+  // Framing takes nanoseconds, so one packet's handled time doubles as
+  // the next one's decode time: one clock read per packet.
+  PacketMetrics::Clock::time_point received, decoded;
+  if (metrics_)
+    received = decoded = PacketMetrics::Clock::now();
+
+  size_t offset = 0;
+  while (offset < size) {
+    PacketView view;
+    FrameResult result = PacketView::frame(data + offset, size - offset, view);
+    if (result == FrameResult::INCOMPLETE)
+      break;
+    if (result == FrameResult::MALFORMED) {
+      std::cerr << "Malformed packet header, disconnecting [ID: " << clientId
+                << "]" << std::endl;
+      disconnectClient(clientId);
+      return size;
+    }
+
+    // A HEARTBEAT only shows the peer is alive, which the read already
+    // recorded; it never reaches the application.
+    if (view.getType() != 0 && view.getType() != MessageType::HEARTBEAT) {
+      if (packetViewCallback_) {
+        packetViewCallback_(view, clientId);
+      } else {
+        Packet packet = view.toPacket();
+
+        // The MessageQueue is the consumer of last resort: a packet the
+        // callback has handled would only sit there until evicted.
+        if (packetCallback_)
+          packetCallback_(packet, clientId);
+        else
+          messageQueue_.push(std::move(packet));
+      }
+    }
+
+    if (metrics_) {
+      auto handled = PacketMetrics::Clock::now();
+      metrics_->recordReceived(view.getType(), view.getTotalSize(),
+                               decoded - received, handled - decoded);
+      decoded = handled;
+    }
+
+    offset += view.getTotalSize();
+  }
+
+  return offset;
+}
+
+void Server::processReceivedData(uint32_t clientId,
+                                 ReceiveBuffer &receiveBuffer) {
+  receiveBuffer.consume(
+      dispatchPackets(clientId, receiveBuffer.data(), receiveBuffer.size()));
+}
+
+void Server::onClientDisconnected(uint32_t clientId) {
+  connectionManager_.setStatus(clientId, ConnectionStatus::DISCONNECTING);
+  connectionManager_.removeConnection(clientId);
 
-  if (packetCallback_) {
+  if (packetViewCallback_) {
+    packetViewCallback_(PacketView(MessageType::PLAYER_LEAVE, nullptr, 0),
+                        clientId);
+  } else if (packetCallback_) {
     Packet leavePacket(MessageType::PLAYER_LEAVE, std::vector<uint8_t>());
-    packetCallback_(leavePacket, client->id);
+    packetCallback_(leavePacket, clientId);
   }
 }
 
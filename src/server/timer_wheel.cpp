@@ -0,0 +1,195 @@
+#include "server/timer_wheel.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace net {
+
+namespace {
+
+int lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(bits);
+#endif
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point start)
+    : tick_(std::max(tick, std::chrono::milliseconds(1))), start_(start) {
+  for (auto &level : heads_)
+    std::fill(std::begin(level), std::end(level), NIL);
+}
+
+uint64_t TimerWheel::tickAt(Clock::time_point time) const {
+  if (time <= start_)
+    return 0;
+  return static_cast<uint64_t>((time - start_) / tick_);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::duration delay,
+                                         Callback callback) {
+  uint32_t index;
+  if (!free_.empty()) {
+    index = free_.back();
+    free_.pop_back();
+  } else {
+    index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+  }
+
+  // Counted from the start of the current tick, which may already be
+  // partly gone; one extra tick keeps the timer from firing early.
+  auto ticks = (std::max(delay, Clock::duration::zero()) + tick_ -
+                Clock::duration(1)) /
+               tick_;
+  Node &node = nodes_[index];
+  node.expires = current_ + 1 + static_cast<uint64_t>(ticks);
+  node.armed = true;
+  node.callback = std::move(callback);
+  link(index);
+  ++size_;
+  return (static_cast<uint64_t>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+  uint32_t index = static_cast<uint32_t>(id);
+  if (id == 0 || index >= nodes_.size())
+    return false;
+  Node &node = nodes_[index];
+  if (!node.armed || node.generation != static_cast<uint32_t>(id >> 32))
+    return false;
+  unlink(index);
+  release(index);
+  return true;
+}
+
+void TimerWheel::link(uint32_t index) {
+  Node &node = nodes_[index];
+  uint64_t expires = std::max(node.expires, current_);
+  uint64_t delta = expires - current_;
+
+  size_t level = 0;
+  while (level + 1 < LEVELS && delta >= (uint64_t(1) << (BITS * (level + 1))))
+    ++level;
+  // Beyond the top wheel: park in its furthest slot and re-place on the
+  // way down (advance() sees expires is still ahead).
+  uint64_t span = uint64_t(1) << (BITS * LEVELS);
+  if (delta >= span)
+    expires = current_ + span - 1;
+
+  size_t slot = (expires >> (BITS * level)) & (SLOTS - 1);
+  node.level = static_cast<uint8_t>(level);
+  node.slot = static_cast<uint8_t>(slot);
+  node.prev = NIL;
+  node.next = heads_[level][slot];
+  if (node.next != NIL)
+    nodes_[node.next].prev = index;
+  heads_[level][slot] = index;
+  occupied_[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+  Node &node = nodes_[index];
+  if (node.prev != NIL)
+    nodes_[node.prev].next = node.next;
+  else
+    heads_[node.level][node.slot] = node.next;
+  if (node.next != NIL)
+    nodes_[node.next].prev = node.prev;
+  if (heads_[node.level][node.slot] == NIL)
+    occupied_[node.level] &= ~(uint64_t(1) << node.slot);
+  node.prev = node.next = NIL;
+}
+
+void TimerWheel::release(uint32_t index) {
+  Node &node = nodes_[index];
+  node.armed = false;
+  node.callback = nullptr;
+  // Generation 0 is skipped so that id 0 stays invalid for index 0.
+  if (++node.generation == 0)
+    node.generation = 1;
+  free_.push_back(index);
+  --size_;
+}
+
+void TimerWheel::cascade(size_t level) {
+  size_t slot = (current_ >> (BITS * level)) & (SLOTS - 1);
+  while (heads_[level][slot] != NIL) {
+    uint32_t index = heads_[level][slot];
+    unlink(index);
+    link(index);
+  }
+}
+
+size_t TimerWheel::advance(Clock::time_point now) {
+  uint64_t target = tickAt(now);
+  if (size_ == 0) {
+    current_ = std::max(current_, target);
+    return 0;
+  }
+
+  size_t fired = 0;
+  while (current_ < target) {
+    ++current_;
+    // Each wrap of a wheel pulls the next slot of the one above down.
+    for (size_t level = 1; level < LEVELS; ++level) {
+      if ((current_ & ((uint64_t(1) << (BITS * level)) - 1)) != 0)
+        break;
+      cascade(level);
+    }
+
+    // Pop one at a time: a callback may cancel any other timer, and new
+    // timers are at least a tick out so never land in this slot.
+    size_t slot = current_ & (SLOTS - 1);
+    while (heads_[0][slot] != NIL) {
+      uint32_t index = heads_[0][slot];
+      unlink(index);
+      if (nodes_[index].expires > current_) {
+        link(index);
+        continue;
+      }
+      Callback callback = std::move(nodes_[index].callback);
+      release(index);
+      ++fired;
+      callback();
+    }
+
+    if (size_ == 0) {
+      current_ = target;
+      break;
+    }
+  }
+  return fired;
+}
+
+int TimerWheel::msUntilNext(Clock::time_point now) const {
+  if (size_ == 0)
+    return -1;
+
+  // The nearest occupied slot of the lowest wheel, else its next wrap,
+  // where higher slots cascade down.
+  uint64_t deadline;
+  uint64_t bits = occupied_[0];
+  unsigned shift = static_cast<unsigned>((current_ + 1) & (SLOTS - 1));
+  uint64_t rotated = shift ? (bits >> shift) | (bits << (64 - shift)) : bits;
+  if (rotated != 0)
+    deadline = current_ + 1 + static_cast<uint64_t>(lowestBit(rotated));
+  else
+    deadline = (current_ | (SLOTS - 1)) + 1;
+
+  auto at = start_ + tick_ * deadline;
+  if (at <= now)
+    return 0;
+  auto wait = std::chrono::ceil<std::chrono::milliseconds>(at - now);
+  return static_cast<int>(wait.count());
+}
+
+} // namespace net
@@ -0,0 +1,670 @@
+#include "server/uring_loop.h"
+#include "server/server.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace net {
+
+namespace {
+
+// The uring loop running on the current thread, if any. Lets send() skip
+// the eventfd write when the owner is the caller, and lets cross-loop
+// wakeups ride on the caller's next submission as IORING_OP_MSG_RING.
+thread_local UringLoop *currentLoop = nullptr;
+
+int uringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int ringFd, unsigned toSubmit, unsigned minComplete,
+               unsigned flags, const void *arg = nullptr, size_t argSize = 0) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit,
+                                  minComplete, flags, arg, argSize));
+}
+
+int uringRegister(int ringFd, unsigned opcode, void *arg, unsigned args) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, ringFd, opcode, arg, args));
+}
+
+unsigned loadAcquire(const unsigned *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(unsigned *p, unsigned value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+} // namespace
+
+UringLoop::UringLoop(Server &server, size_t index)
+    : server_(server), index_(index), ringFd_(-1), sqRing_(nullptr),
+      sqRingSize_(0), cqRing_(nullptr), cqRingSize_(0), sqes_(nullptr),
+      sqesSize_(0), sqHead_(nullptr), sqTail_(nullptr), sqMask_(0),
+      sqEntries_(0), cqHead_(nullptr), cqTail_(nullptr), cqMask_(0),
+      cqes_(nullptr), sqLocalTail_(0), inflightOps_(0), bufferRing_(nullptr),
+      bufferRingSize_(0), bufferTail_(0), wakeupFd_(-1), wakeupValue_(0),
+      notified_(false), listenSocket_(INVALID_SOCKET),
+      timers_(Server::TIMER_TICK) {}
+
+UringLoop::~UringLoop() {
+  // Closing the ring cancels anything still armed before buffers go away.
+  if (ringFd_ != -1)
+    ::close(ringFd_);
+  if (sqes_)
+    munmap(sqes_, sqesSize_);
+  if (cqRing_ && cqRing_ != sqRing_)
+    munmap(cqRing_, cqRingSize_);
+  if (sqRing_)
+    munmap(sqRing_, sqRingSize_);
+  if (bufferRing_)
+    munmap(bufferRing_, bufferRingSize_);
+  if (wakeupFd_ != -1)
+    ::close(wakeupFd_);
+}
+
+bool UringLoop::init() {
+  if (!setupRing() || !setupBufferRing())
+    return false;
+
+  wakeupFd_ = eventfd(0, EFD_CLOEXEC);
+  if (wakeupFd_ == -1) {
+    std::cerr << "eventfd failed: " << errno << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool UringLoop::setupRing() {
+  io_uring_params params{};
+  params.flags = IORING_SETUP_COOP_TASKRUN;
+  ringFd_ = uringSetup(RING_ENTRIES, &params);
+  if (ringFd_ < 0) {
+    // Older kernels reject the flag; fall back to the default task work.
+    params = io_uring_params{};
+    ringFd_ = uringSetup(RING_ENTRIES, &params);
+  }
+  if (ringFd_ < 0) {
+    std::cerr << "io_uring_setup failed: " << errno << std::endl;
+    return false;
+  }
+
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (singleMmap) {
+    sqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    cqRingSize_ = sqRingSize_;
+  }
+
+  sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+  if (sqRing_ == MAP_FAILED) {
+    sqRing_ = nullptr;
+    std::cerr << "io_uring SQ mmap failed: " << errno << std::endl;
+    return false;
+  }
+
+  if (singleMmap) {
+    cqRing_ = sqRing_;
+  } else {
+    cqRing_ = mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+    if (cqRing_ == MAP_FAILED) {
+      cqRing_ = nullptr;
+      std::cerr << "io_uring CQ mmap failed: " << errno << std::endl;
+      return false;
+    }
+  }
+
+  sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    std::cerr << "io_uring SQE mmap failed: " << errno << std::endl;
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<uint8_t *>(sqRing_);
+  auto *cq = static_cast<uint8_t *>(cqRing_);
+  sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sqMask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sqEntries_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+  cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cqMask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+  // Identity-map the indirection array once; SQEs are used in ring order.
+  auto *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  for (unsigned i = 0; i < sqEntries_; ++i)
+    array[i] = i;
+
+  sqLocalTail_ = *sqTail_;
+  return true;
+}
+
+bool UringLoop::setupBufferRing() {
+  bufferRingSize_ = BUFFER_COUNT * sizeof(io_uring_buf);
+  void *ring = mmap(nullptr, bufferRingSize_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ring == MAP_FAILED) {
+    std::cerr << "Buffer ring mmap failed: " << errno << std::endl;
+    return false;
+  }
+  bufferRing_ = static_cast<io_uring_buf *>(ring);
+
+  io_uring_buf_reg reg{};
+  reg.ring_addr = reinterpret_cast<uint64_t>(bufferRing_);
+  reg.ring_entries = BUFFER_COUNT;
+  reg.bgid = BUFFER_GROUP;
+  if (uringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    std::cerr << "IORING_REGISTER_PBUF_RING failed: " << errno << std::endl;
+    return false;
+  }
+
+  bufferPool_.resize(static_cast<size_t>(BUFFER_COUNT) * BUFFER_SIZE);
+  for (unsigned i = 0; i < BUFFER_COUNT; ++i)
+    recycleBuffer(static_cast<uint16_t>(i));
+  return true;
+}
+
+uint64_t UringLoop::encode(Op op, uint32_t clientId) {
+  return (static_cast<uint64_t>(op) << 56) | clientId;
+}
+
+io_uring_sqe *UringLoop::nextSqe() {
+  if (sqLocalTail_ - loadAcquire(sqHead_) >= sqEntries_) {
+    // Ring full: hand what we have to the kernel without waiting.
+    submitAndWait(0);
+  }
+
+  io_uring_sqe *sqe = &sqes_[sqLocalTail_ & sqMask_];
+  std::memset(sqe, 0, sizeof(*sqe));
+  ++sqLocalTail_;
+  storeRelease(sqTail_, sqLocalTail_);
+  return sqe;
+}
+
+int UringLoop::submitAndWait(unsigned minComplete, int timeoutMs) {
+  unsigned toSubmit = sqLocalTail_ - loadAcquire(sqHead_);
+  unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+  // IORING_ENTER_EXT_ARG (5.11+) bounds the wait without arming a
+  // TIMEOUT request; the call then fails with ETIME.
+  __kernel_timespec timeout{};
+  io_uring_getevents_arg arg{};
+  if (timeoutMs >= 0 && minComplete > 0) {
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+    arg.ts = reinterpret_cast<uint64_t>(&timeout);
+    flags |= IORING_ENTER_EXT_ARG;
+  }
+
+  int result;
+  do {
+    result = (flags & IORING_ENTER_EXT_ARG)
+                 ? uringEnter(ringFd_, toSubmit, minComplete, flags, &arg,
+                              sizeof(arg))
+                 : uringEnter(ringFd_, toSubmit, minComplete, flags);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+void UringLoop::reapCompletions() {
+  unsigned head = *cqHead_;
+  unsigned tail = loadAcquire(cqTail_);
+
+  while (head != tail) {
+    io_uring_cqe cqe = cqes_[head & cqMask_];
+    ++head;
+    // Release the slot before handling so nested submissions see room.
+    storeRelease(cqHead_, head);
+    handleCompletion(cqe);
+    tail = loadAcquire(cqTail_);
+  }
+}
+
+void UringLoop::handleCompletion(const io_uring_cqe &cqe) {
+  Op op = static_cast<Op>(cqe.user_data >> 56);
+  uint32_t clientId = static_cast<uint32_t>(cqe.user_data);
+
+  if (!(cqe.flags & IORING_CQE_F_MORE) && op != Op::MESSAGE)
+    --inflightOps_;
+
+  switch (op) {
+  case Op::ACCEPT:
+    onAccept(cqe.res);
+    // -EINVAL means the kernel lacks multishot accept; don't spin on it.
+    if (!(cqe.flags & IORING_CQE_F_MORE) && cqe.res != -EINVAL &&
+        server_.running_)
+      armAccept();
+    break;
+  case Op::WAKEUP:
+    if (server_.running_)
+      armWakeup();
+    break;
+  case Op::MESSAGE:
+  case Op::CANCEL:
+    break;
+  case Op::RECV:
+    onRecv(clientId, cqe.res, cqe.flags);
+    break;
+  case Op::SEND:
+    onSend(clientId, cqe.res);
+    break;
+  }
+}
+
+bool UringLoop::watchListener(SOCKET listenSocket) {
+  listenSocket_ = listenSocket;
+  return true;
+}
+
+void UringLoop::armAccept() {
+  io_uring_sqe *sqe = nextSqe();
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = listenSocket_;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = SOCK_CLOEXEC;
+  sqe->user_data = encode(Op::ACCEPT, 0);
+  ++inflightOps_;
+}
+
+void UringLoop::armWakeup() {
+  io_uring_sqe *sqe = nextSqe();
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = wakeupFd_;
+  sqe->addr = reinterpret_cast<uint64_t>(&wakeupValue_);
+  sqe->len = sizeof(wakeupValue_);
+  sqe->user_data = encode(Op::WAKEUP, 0);
+  ++inflightOps_;
+}
+
+void UringLoop::armRecv(uint32_t clientId, SOCKET socket) {
+  io_uring_sqe *sqe = nextSqe();
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = socket;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = BUFFER_GROUP;
+  sqe->user_data = encode(Op::RECV, clientId);
+  ++inflightOps_;
+}
+
+void UringLoop::recycleBuffer(uint16_t bufferId) {
+  io_uring_buf &buf = bufferRing_[bufferTail_ & (BUFFER_COUNT - 1)];
+  buf.addr = reinterpret_cast<uint64_t>(bufferPool_.data() +
+                                        static_cast<size_t>(bufferId) *
+                                            BUFFER_SIZE);
+  buf.len = BUFFER_SIZE;
+  buf.bid = bufferId;
+  ++bufferTail_;
+  // The ring tail overlays the resv field of the first entry
+  // (io_uring_buf_ring); its flexible-array member is not usable from C++.
+  __atomic_store_n(&bufferRing_[0].resv, bufferTail_, __ATOMIC_RELEASE);
+}
+
+void UringLoop::run() {
+  currentLoop = this;
+
+  armWakeup();
+  if (listenSocket_ != INVALID_SOCKET)
+    armAccept();
+
+  while (server_.running_) {
+    drainPending();
+    drainFlushQueue();
+
+    int timeoutMs = timers_.msUntilNext(TimerWheel::Clock::now());
+    if (submitAndWait(1, timeoutMs) < 0 && errno != EBUSY && errno != EAGAIN &&
+        errno != ETIME) {
+      std::cerr << "io_uring_enter failed [Loop: " << index_ << "]: " << errno
+                << std::endl;
+      break;
+    }
+
+    timers_.advance(TimerWheel::Clock::now());
+    reapCompletions();
+  }
+
+  drainPending();
+  shutdownAll();
+
+  // Cancel the armed accept/recv/read and wait for every request to retire
+  // so the kernel no longer references connection or ring buffers. Without
+  // CANCEL_ALL only the first match is cancelled, which could leave the
+  // multishot accept armed and the wait below blocked forever.
+  io_uring_sqe *sqe = nextSqe();
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+  sqe->user_data = encode(Op::CANCEL, 0);
+  ++inflightOps_;
+
+  while (inflightOps_ > 0 || !connections_.empty()) {
+    if (submitAndWait(1) < 0 && errno != EBUSY && errno != EAGAIN)
+      break;
+    reapCompletions();
+  }
+
+  currentLoop = nullptr;
+}
+
+void UringLoop::wakeup() {
+  uint64_t one = 1;
+  ssize_t written = ::write(wakeupFd_, &one, sizeof(one));
+  (void)written;
+}
+
+void UringLoop::notify() {
+  if (currentLoop == this || notified_.exchange(true))
+    return;
+
+  if (currentLoop) {
+    // Post a CQE straight into our ring from the caller's ring; it goes out
+    // with the caller's next io_uring_enter() instead of its own syscall.
+    io_uring_sqe *sqe = currentLoop->nextSqe();
+    sqe->opcode = IORING_OP_MSG_RING;
+    sqe->fd = ringFd_;
+    sqe->addr = IORING_MSG_DATA;
+    sqe->off = encode(Op::MESSAGE, 0);
+    sqe->user_data = encode(Op::MESSAGE, 0);
+    return;
+  }
+
+  wakeup();
+}
+
+void UringLoop::adopt(std::shared_ptr<ConnectionInfo> connection) {
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pending_.push_back(std::move(connection));
+  }
+  notify();
+}
+
+void UringLoop::drainPending() {
+  notified_ = false;
+
+  std::vector<std::shared_ptr<ConnectionInfo>> pending;
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pending.swap(pending_);
+  }
+
+  for (auto &connection : pending)
+    registerConnection(std::move(connection));
+}
+
+void UringLoop::drainFlushQueue() {
+  std::vector<uint32_t> ids;
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    ids.swap(flushQueue_);
+  }
+
+  for (uint32_t clientId : ids) {
+    auto it = connections_.find(clientId);
+    if (it != connections_.end() && !it->second.sending)
+      submitSend(clientId, it->second);
+  }
+}
+
+void UringLoop::registerConnection(
+    std::shared_ptr<ConnectionInfo> connection) {
+  uint32_t clientId = connection->id;
+  SOCKET socket = connection->socket;
+  LoopConnection &entry = connections_[clientId];
+  entry.info = std::move(connection);
+
+  if (!server_.running_) {
+    closeConnection(clientId);
+    return;
+  }
+
+  if (server_.idleTimersEnabled())
+    armIdleTimer(clientId, server_.firstIdleCheck());
+  entry.receiving = true;
+  armRecv(clientId, socket);
+  submitSend(clientId, entry);
+}
+
+void UringLoop::onAccept(int result) {
+  if (result < 0) {
+    if (result != -ECANCELED)
+      std::cerr << "Accept failed: " << -result << std::endl;
+    return;
+  }
+
+  SOCKET clientSocket = result;
+  if (!server_.running_) {
+    closesocket(clientSocket);
+    return;
+  }
+
+  sockaddr_in clientAddr{};
+  socklen_t clientAddrSize = sizeof(clientAddr);
+  getpeername(clientSocket, (sockaddr *)&clientAddr, &clientAddrSize);
+
+  int noDelay = 1;
+  setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay,
+             sizeof(noDelay));
+
+  uint32_t clientId =
+      server_.registerClient(clientSocket, clientAddr, index_);
+  if (clientId == 0)
+    return;
+
+  auto connection = server_.connectionManager_.getConnection(clientId);
+  if (!connection)
+    return;
+
+  auto &loops = server_.eventLoops_;
+  IoLoop &owner = *loops[clientId % loops.size()];
+  if (&owner == this)
+    registerConnection(std::move(connection));
+  else
+    owner.adopt(std::move(connection));
+}
+
+void UringLoop::onRecv(uint32_t clientId, int result, uint32_t flags) {
+  auto it = connections_.find(clientId);
+
+  if (flags & IORING_CQE_F_BUFFER) {
+    uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    if (result > 0 && it != connections_.end()) {
+      const uint8_t *data =
+          bufferPool_.data() + static_cast<size_t>(bufferId) * BUFFER_SIZE;
+      server_.connectionManager_.updateHeartbeat(clientId);
+
+      // With nothing pending, packets are dispatched straight out of the
+      // provided buffer; only a trailing partial packet is copied.
+      if (it->second.receiveBuffer.empty()) {
+        size_t used = server_.dispatchPackets(clientId, data, result);
+        it = connections_.find(clientId);
+        if (it != connections_.end())
+          it->second.receiveBuffer.append(data + used, result - used);
+      } else {
+        it->second.receiveBuffer.append(data, result);
+        server_.processReceivedData(clientId, it->second.receiveBuffer);
+        it = connections_.find(clientId);
+      }
+    }
+    recycleBuffer(bufferId);
+  }
+
+  if (it == connections_.end())
+    return;
+
+  if (flags & IORING_CQE_F_MORE)
+    return;
+
+  // Multishot ended: re-arm if it only ran out of buffers or hit its limit.
+  if ((result > 0 || result == -ENOBUFS) && server_.running_) {
+    armRecv(clientId, it->second.info->socket);
+    return;
+  }
+
+  if (result == 0)
+    std::cout << "Client disconnected [ID: " << clientId << "]" << std::endl;
+  else if (result == -ECONNRESET)
+    std::cout << "Connection reset by client [ID: " << clientId << "]"
+              << std::endl;
+  else if (result != -ECANCELED)
+    std::cerr << "Receive failed [ID: " << clientId << "]: " << -result
+              << std::endl;
+
+  it->second.receiving = false;
+  closeConnection(clientId);
+}
+
+void UringLoop::scheduleFlush(ConnectionInfo &connection) {
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    flushQueue_.push_back(connection.id);
+  }
+  notify();
+}
+
+void UringLoop::submitSend(uint32_t clientId, LoopConnection &connection) {
+  // Drop the packets the previous SENDMSG completed.
+  auto done = connection.inflight.begin();
+  while (done != connection.inflight.end() &&
+         connection.inflightOffset >= (*done)->size()) {
+    connection.inflightOffset -= (*done)->size();
+    ++done;
+  }
+  connection.inflight.erase(connection.inflight.begin(), done);
+
+  if (connection.inflight.empty()) {
+    connection.inflightOffset = 0;
+
+    std::lock_guard<std::mutex> lock(connection.info->sendMutex);
+    auto &queue = connection.info->sendQueue;
+    size_t count = std::min<size_t>(queue.size(), MAX_SEND_IOVECS);
+    for (size_t i = 0; i < count; ++i) {
+      connection.info->queuedBytes -= queue.front()->size();
+      connection.inflight.push_back(std::move(queue.front()));
+      queue.pop_front();
+    }
+  }
+
+  if (connection.inflight.empty()) {
+    connection.sending = false;
+    return;
+  }
+
+  // Every queued packet goes out in one SENDMSG, straight from the shared
+  // buffers.
+  connection.iovecs.clear();
+  size_t offset = connection.inflightOffset;
+  for (const WireBuffer &buffer : connection.inflight) {
+    connection.iovecs.push_back(
+        iovec{const_cast<uint8_t *>(buffer->data()) + offset,
+              buffer->size() - offset});
+    offset = 0;
+  }
+  connection.message = msghdr{};
+  connection.message.msg_iov = connection.iovecs.data();
+  connection.message.msg_iovlen = connection.iovecs.size();
+
+  io_uring_sqe *sqe = nextSqe();
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = connection.info->socket;
+  sqe->addr = reinterpret_cast<uint64_t>(&connection.message);
+  sqe->len = 1;
+  sqe->msg_flags = SEND_FLAGS;
+  sqe->user_data = encode(Op::SEND, clientId);
+  ++inflightOps_;
+  connection.sending = true;
+}
+
+void UringLoop::onSend(uint32_t clientId, int result) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+
+  LoopConnection &connection = it->second;
+  connection.sending = false;
+
+  if (result < 0) {
+    // Peer is gone; the recv side observes the hangup and tears down.
+    connection.inflight.clear();
+    connection.inflightOffset = 0;
+    shutdown(connection.info->socket, SHUT_RDWR);
+  } else {
+    connection.inflightOffset += static_cast<size_t>(result);
+    if (connection.receiving)
+      submitSend(clientId, connection);
+  }
+
+  if (!connection.receiving && !connection.sending)
+    closeConnection(clientId);
+}
+
+void UringLoop::armIdleTimer(uint32_t clientId,
+                             TimerWheel::Clock::duration delay) {
+  connections_[clientId].idleTimer =
+      timers_.schedule(delay, [this, clientId]() { onIdleTimer(clientId); });
+}
+
+void UringLoop::onIdleTimer(uint32_t clientId) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+  it->second.idleTimer = 0;
+
+  TimerWheel::Clock::duration next;
+  if (server_.checkIdle(*it->second.info, TimerWheel::Clock::now(), next))
+    armIdleTimer(clientId, next);
+  else
+    closeConnection(clientId);
+}
+
+void UringLoop::closeConnection(uint32_t clientId) {
+  auto it = connections_.find(clientId);
+  if (it == connections_.end())
+    return;
+
+  // Wait for outstanding kernel requests before the buffers go away.
+  if (it->second.receiving || it->second.sending) {
+    shutdown(it->second.info->socket, SHUT_RDWR);
+    return;
+  }
+
+  timers_.cancel(it->second.idleTimer);
+  std::shared_ptr<ConnectionInfo> info = std::move(it->second.info);
+  connections_.erase(it);
+
+  {
+    std::lock_guard<std::mutex> lock(info->sendMutex);
+    if (info->socket != INVALID_SOCKET) {
+      closesocket(info->socket);
+      info->socket = INVALID_SOCKET;
+    }
+    info->sendQueue.clear();
+    info->queuedBytes = 0;
+  }
+
+  server_.onClientDisconnected(clientId);
+}
+
+void UringLoop::shutdownAll() {
+  std::vector<uint32_t> ids;
+  ids.reserve(connections_.size());
+  for (const auto &[clientId, connection] : connections_)
+    ids.push_back(clientId);
+
+  for (uint32_t clientId : ids)
+    closeConnection(clientId);
+}
+
+} // namespace net